@@ -87,13 +87,15 @@ struct ClientAdvertisement {
   std::vector<uint8_t> schema;
 };
 
+/// Message published by a client. This is a non-owning view over the received websocket frame and
+/// the client's advertisement, both of which are only guaranteed to outlive the handler call.
 struct ClientMessage {
   uint64_t logTime;
   uint64_t publishTime;
   uint32_t sequence;
-  ClientAdvertisement advertisement;
+  const ClientAdvertisement& advertisement;
   size_t dataLength;
-  std::vector<uint8_t> data;
+  const uint8_t* data;
 
   ClientMessage(uint64_t logTime, uint64_t publishTime, uint32_t sequence,
                 const ClientAdvertisement& advertisement, size_t dataLength, const uint8_t* rawData)
@@ -102,17 +104,15 @@ struct ClientMessage {
       , sequence(sequence)
       , advertisement(advertisement)
       , dataLength(dataLength)
-      , data(dataLength) {
-    std::memcpy(data.data(), rawData, dataLength);
-  }
+      , data(rawData) {}
 
   static const size_t MSG_PAYLOAD_OFFSET = 5;
 
   const uint8_t* getData() const {
-    return data.data() + MSG_PAYLOAD_OFFSET;
+    return data + MSG_PAYLOAD_OFFSET;
   }
   std::size_t getLength() const {
-    return data.size() - MSG_PAYLOAD_OFFSET;
+    return dataLength - MSG_PAYLOAD_OFFSET;
   }
 };
 
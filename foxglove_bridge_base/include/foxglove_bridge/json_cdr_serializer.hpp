@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace foxglove_ws {
+
+/// Serializes JSON encoded messages to (little endian) ROS 2 CDR.
+///
+/// The `.msg` schema is compiled once into a flat program of field instructions (kind, alignment,
+/// array layout and nested message). Messages are then parsed in place from the JSON text and
+/// written straight to the output buffer, without building a JSON document.
+///
+/// Fields missing from the JSON object are set to their default value if the schema defines one,
+/// otherwise they are zero-initialized. Unknown fields are ignored. `uint8[]` and `byte[]` fields
+/// may also be given as base64 string. `null` is accepted for floating point fields and serialized
+/// as NaN.
+class JsonCdrSerializer {
+public:
+  /// Destination of serialized messages, so that they can be written straight into a buffer that
+  /// is not a `std::vector`, e.g. the one of the message that is eventually published.
+  class OutputBuffer {
+  public:
+    virtual ~OutputBuffer() = default;
+    /// Start of the buffer, which may be written up to its capacity.
+    virtual uint8_t* data() = 0;
+    virtual size_t capacity() const = 0;
+    /// Grow the buffer to at least `capacity` bytes, keeping its contents.
+    virtual void reserve(size_t capacity) = 0;
+    /// Called once the message has been written, with its size.
+    virtual void finish(size_t size) = 0;
+  };
+
+  /// @param schemaName Name of the root message type, e.g. `geometry_msgs/msg/Twist`.
+  /// @param schema Full `.msg` definition text, with dependencies concatenated using the
+  /// `MSG: <type>` delimiter format of the message definition cache.
+  /// @throws std::runtime_error if the schema is invalid or uses unsupported types.
+  JsonCdrSerializer(const std::string& schemaName, const std::string& schema);
+
+  /// Serialize the given JSON message. `out` is overwritten but keeps its capacity, so that it can
+  /// be reused across calls.
+  /// @throws std::runtime_error if the JSON is malformed or does not match the schema.
+  void serialize(std::string_view json, std::vector<uint8_t>& out) const;
+
+  /// Serialize the given JSON message into `out`. Only calls into `out` when the buffer needs to
+  /// grow and once the message has been written.
+  /// @throws std::runtime_error if the JSON is malformed or does not match the schema.
+  void serialize(std::string_view json, OutputBuffer& out) const;
+
+  const std::string& schemaName() const {
+    return _schemaName;
+  }
+
+private:
+  enum class FieldKind : uint8_t {
+    Bool,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float32,
+    Float64,
+    String,
+    Message,
+  };
+
+  enum class ArrayKind : uint8_t {
+    None,
+    Fixed,     // T[N]
+    Sequence,  // T[] or T[<=N]
+  };
+
+  struct Field {
+    std::string name;
+    FieldKind kind;
+    ArrayKind arrayKind = ArrayKind::None;
+    uint8_t size = 0;          // Size (and alignment) of primitive fields
+    uint32_t arrayLength = 0;  // Length of fixed arrays, bound of sequences (0 = unbounded)
+    uint32_t stringBound = 0;  // Bound of strings (0 = unbounded)
+    size_t messageIndex = 0;   // Index into _messages for nested messages
+    std::string defaultJson;   // Default value from the schema as JSON, empty if there is none
+  };
+
+  struct Message {
+    std::string name;
+    std::vector<Field> fields;
+  };
+
+  class Writer;
+  class Reader;
+
+  size_t compileMessage(const std::string& name, const std::vector<std::string>& definitions,
+                        const std::vector<std::string>& definitionNames,
+                        std::vector<std::string>& resolving);
+
+  void writeMessage(Reader& reader, size_t messageIndex, Writer& writer) const;
+  void writeField(Reader& reader, const Field& field, Writer& writer) const;
+  void writeValue(Reader& reader, const Field& field, Writer& writer) const;
+  void writeDefaultMessage(size_t messageIndex, Writer& writer) const;
+  void writeDefaultField(const Field& field, Writer& writer) const;
+  void writeDefaultValue(const Field& field, Writer& writer) const;
+
+  std::string _schemaName;
+  std::vector<Message> _messages;
+  size_t _rootMessageIndex = 0;
+};
+
+}  // namespace foxglove_ws
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "base64.hpp"
+#include "common.hpp"
+#include "mcap_reader.hpp"
+#include "server_interface.hpp"
+#include "websocket_logging.hpp"
+
+namespace foxglove_ws {
+
+/// Plays back the messages of an MCAP file through a server, without any ROS graph involved.
+///
+/// The channels of the file are advertised as they are, and the messages are broadcast to the
+/// subscribed clients in log time order, paced by the playback rate. The log time of the played
+/// back messages is broadcast as server time, so clients must be given the time capability.
+template <typename ConnectionHandle>
+class McapPlayer {
+public:
+  McapPlayer(ServerInterface<ConnectionHandle>& server, const McapReader& reader,
+             LogCallback logger)
+      : _server(server)
+      , _reader(reader)
+      , _logger(std::move(logger)) {
+    std::vector<uint16_t> mcapChannelIds;
+    std::vector<ChannelWithoutId> channels;
+    for (const auto& [mcapChannelId, mcapChannel] : _reader.channels()) {
+      ChannelWithoutId channel;
+      channel.topic = mcapChannel.topic;
+      channel.encoding = mcapChannel.messageEncoding;
+      const auto schemaIt = _reader.schemas().find(mcapChannel.schemaId);
+      if (schemaIt != _reader.schemas().end()) {
+        const auto& schema = schemaIt->second;
+        channel.schemaName = schema.name;
+        channel.schemaEncoding = schema.encoding;
+        // Binary schemas have to be base64 encoded for the WebSocket protocol.
+        channel.schema = schema.encoding == "protobuf" || schema.encoding == "flatbuffer"
+                           ? base64Encode(schema.data)
+                           : schema.data;
+      }
+      mcapChannelIds.push_back(mcapChannelId);
+      channels.push_back(std::move(channel));
+    }
+
+    const auto channelIds = _server.addChannels(channels);
+    for (size_t i = 0; i < channelIds.size(); ++i) {
+      _channelIds.emplace(mcapChannelIds[i], channelIds[i]);
+    }
+  }
+
+  ~McapPlayer() {
+    stop();
+    std::vector<ChannelId> channelIds;
+    for (const auto& [mcapChannelId, channelId] : _channelIds) {
+      channelIds.push_back(channelId);
+    }
+    _server.removeChannels(channelIds);
+  }
+
+  McapPlayer(const McapPlayer&) = delete;
+  McapPlayer& operator=(const McapPlayer&) = delete;
+
+  /// Start playing back in a background thread.
+  /// @param rate Playback speed relative to real time, must be positive.
+  /// @param loop Restart from the beginning once the end of the file is reached.
+  /// @param startTime Log time to start playing back at, the start of the file if earlier.
+  void start(double rate, bool loop, uint64_t startTime = 0) {
+    stop();
+    _rate = rate;
+    _loop = loop;
+    _stopRequested = false;
+    _seekTarget = std::nullopt;
+    _thread = std::thread(&McapPlayer::run, this, startTime);
+  }
+
+  /// Continue playing back at the given log time.
+  void seek(uint64_t logTime) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _seekTarget = logTime;
+    _cv.notify_all();
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopRequested = true;
+      _cv.notify_all();
+    }
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+  }
+
+private:
+  /// Minimum log time difference between two time broadcasts (10 ms).
+  static constexpr uint64_t TIME_BROADCAST_INTERVAL_NS = 10'000'000;
+
+  void run(uint64_t startTime) {
+    // Corrupt chunks are only detected once playback reaches them, which must not terminate the
+    // process from the playback thread.
+    try {
+      play(startTime);
+    } catch (const std::exception& ex) {
+      _logger(WebSocketLogLevel::Error, ("Playback failed: " + std::string(ex.what())).c_str());
+    }
+  }
+
+  void play(uint64_t startTime) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stopRequested) {
+      const uint64_t logStart = std::max(startTime, _reader.startTime());
+      const auto wallStart = std::chrono::steady_clock::now();
+      auto messages = _reader.messages(startTime);
+      bool seeked = false;
+
+      _server.broadcastTime(logStart);
+      uint64_t lastTimeBroadcast = logStart;
+      while (true) {
+        McapMessageView message;
+        lock.unlock();
+        const bool hasMessage = messages.next(message);
+        lock.lock();
+        if (!hasMessage) {
+          break;
+        }
+
+        const auto sendTime =
+          wallStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double, std::nano>(
+                          static_cast<double>(message.logTime - logStart) / _rate));
+        _cv.wait_until(lock, sendTime, [this] {
+          return _stopRequested || _seekTarget.has_value();
+        });
+        if (_stopRequested) {
+          return;
+        } else if (_seekTarget) {
+          startTime = *_seekTarget;
+          _seekTarget = std::nullopt;
+          seeked = true;
+          break;
+        }
+
+        const auto channelIt = _channelIds.find(message.channelId);
+        if (channelIt == _channelIds.end()) {
+          continue;
+        }
+        // Sending may block, the lock is released so that seeking and stopping stay responsive.
+        lock.unlock();
+        if (message.logTime - lastTimeBroadcast >= TIME_BROADCAST_INTERVAL_NS) {
+          _server.broadcastTime(message.logTime);
+          lastTimeBroadcast = message.logTime;
+        }
+        _server.broadcastMessage(channelIt->second, message.logTime, message.data, message.size);
+        lock.lock();
+      }
+
+      if (!seeked && _seekTarget) {
+        startTime = *_seekTarget;
+        _seekTarget = std::nullopt;
+      } else if (!seeked) {
+        if (!_loop) {
+          _logger(WebSocketLogLevel::Info, "Reached the end of the MCAP file");
+          return;
+        }
+        startTime = _reader.startTime();
+      }
+    }
+  }
+
+  ServerInterface<ConnectionHandle>& _server;
+  const McapReader& _reader;
+  LogCallback _logger;
+  std::unordered_map<uint16_t, ChannelId> _channelIds;
+  double _rate = 1.0;
+  bool _loop = false;
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stopRequested = false;
+  std::optional<uint64_t> _seekTarget;
+  std::thread _thread;
+};
+
+}  // namespace foxglove_ws
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace foxglove_ws {
+
+struct McapSchema {
+  uint16_t id;
+  std::string name;
+  std::string encoding;
+  std::string data;
+};
+
+struct McapChannel {
+  uint16_t id;
+  uint16_t schemaId;
+  std::string topic;
+  std::string messageEncoding;
+};
+
+/// Message of an MCAP file. `data` points either into the memory mapped file or into a decompressed
+/// chunk, and is only valid until the iterator that returned it is advanced.
+struct McapMessageView {
+  uint16_t channelId;
+  uint32_t sequence;
+  uint64_t logTime;
+  uint64_t publishTime;
+  const uint8_t* data;
+  size_t size;
+};
+
+/// Reader of MCAP files (https://mcap.dev/spec) for playback.
+///
+/// The file is memory mapped and only its summary section is parsed when opening it, so that large
+/// recordings are available immediately. Chunks are read (and decompressed, if needed) lazily while
+/// iterating over the messages. Files without chunk index, such as those written by McapWriter,
+/// are scanned once when opening them.
+class McapReader {
+public:
+  struct ChunkRef {
+    uint64_t startTime;
+    uint64_t endTime;
+    /// Offset of the chunk record, or of the first record for a range of unchunked messages.
+    uint64_t offset;
+    /// Length of the range of unchunked messages. 0 for chunk records.
+    uint64_t length;
+  };
+
+  /// Iterates over the messages of a file in log time order.
+  class MessageIterator {
+  public:
+    /// @return false once all messages have been returned.
+    bool next(McapMessageView& message);
+
+  private:
+    friend class McapReader;
+
+    struct LoadedChunk {
+      std::vector<uint8_t> decompressed;
+      std::vector<McapMessageView> messages;
+      size_t position = 0;
+    };
+
+    MessageIterator(const McapReader& reader, uint64_t startTime);
+
+    void loadChunk(const ChunkRef& chunk);
+
+    const McapReader& _reader;
+    const uint64_t _startTime;
+    size_t _nextChunk = 0;
+    std::vector<std::unique_ptr<LoadedChunk>> _loadedChunks;
+  };
+
+  McapReader() = default;
+  ~McapReader();
+
+  McapReader(const McapReader&) = delete;
+  McapReader& operator=(const McapReader&) = delete;
+
+  /// Map the file into memory and read its schemas, channels and chunk index.
+  /// @throws std::runtime_error if the file can not be read, is not a valid MCAP file or uses a
+  /// chunk compression this build does not support.
+  void open(const std::string& path);
+
+  void close();
+
+  const std::map<uint16_t, McapSchema>& schemas() const {
+    return _schemas;
+  }
+
+  const std::map<uint16_t, McapChannel>& channels() const {
+    return _channels;
+  }
+
+  /// Log time of the first message, 0 if the file contains no messages.
+  uint64_t startTime() const;
+
+  /// Log time of the last message, 0 if the file contains no messages.
+  uint64_t endTime() const;
+
+  /// @return Iterator over the messages with a log time of at least `startTime`. The reader must
+  /// outlive the iterator.
+  MessageIterator messages(uint64_t startTime = 0) const;
+
+private:
+  void readSummary(uint64_t summaryStart, uint64_t summaryEnd);
+  void scanDataSection(uint64_t dataEnd);
+  void checkCompression(const std::string& compression) const;
+  void readSchema(const uint8_t* data, uint64_t length);
+  void readChannel(const uint8_t* data, uint64_t length);
+
+  std::string _path;
+  const uint8_t* _data = nullptr;
+  size_t _size = 0;
+  std::map<uint16_t, McapSchema> _schemas;
+  std::map<uint16_t, McapChannel> _channels;
+  /// Sorted by start time.
+  std::vector<ChunkRef> _chunks;
+};
+
+}  // namespace foxglove_ws
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace foxglove_ws {
+
+/// Writer of unchunked and unindexed MCAP files (https://mcap.dev/spec).
+///
+/// Records are serialized into a large in-memory buffer which is written to disk once full, so
+/// that the file is produced with few, large sequential writes. The resulting files don't have a
+/// summary section, readers fall back to scanning the data section.
+class McapWriter {
+public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+  explicit McapWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+  ~McapWriter();
+
+  McapWriter(const McapWriter&) = delete;
+  McapWriter& operator=(const McapWriter&) = delete;
+
+  /// Create the file and write the magic and header record.
+  /// @throws std::runtime_error if the file can not be created or already exists.
+  void open(const std::string& path, const std::string& profile);
+
+  /// @return Id of the schema, which is never 0 (0 means "no schema" for channels).
+  uint16_t addSchema(const std::string& name, const std::string& encoding,
+                     const std::string& data);
+
+  uint16_t addChannel(uint16_t schemaId, const std::string& topic,
+                      const std::string& messageEncoding);
+
+  void writeMessage(uint16_t channelId, uint32_t sequence, uint64_t logTime, uint64_t publishTime,
+                    const uint8_t* data, size_t size);
+
+  /// Write the data end and footer records, and close the file. Called by the destructor if the
+  /// file is still open, in which case errors are ignored.
+  /// @throws std::runtime_error if writing to the file failed.
+  void close();
+
+private:
+  enum class Opcode : uint8_t {
+    Header = 0x01,
+    Footer = 0x02,
+    Schema = 0x03,
+    Channel = 0x04,
+    Message = 0x05,
+    DataEnd = 0x0F,
+  };
+
+  void writeRecordHeader(Opcode opcode, uint64_t length);
+  void writeUint16(uint16_t value);
+  void writeUint32(uint32_t value);
+  void writeUint64(uint64_t value);
+  void writeString(const std::string& str);
+  void writeBytes(const uint8_t* data, size_t size);
+  void flush();
+
+  std::FILE* _file = nullptr;
+  std::string _path;
+  std::vector<uint8_t> _buffer;
+  size_t _bufferSize;
+  uint16_t _nextSchemaId = 1;
+  uint16_t _nextChannelId = 0;
+};
+
+}  // namespace foxglove_ws
@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <regex>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace foxglove_ws {
@@ -13,4 +15,14 @@ inline bool isWhitelisted(const std::string& name, const std::vector<std::regex>
          }) != regexPatterns.end();
 }
 
+/// Split a "<pattern>:<value>" specification at its last colon, so that the pattern itself may
+/// contain colons (e.g. IPv6 addresses).
+inline std::pair<std::string, std::string> splitPatternSpec(const std::string& spec) {
+  const auto pos = spec.rfind(':');
+  if (pos == std::string::npos || pos == 0 || pos + 1 == spec.size()) {
+    throw std::invalid_argument("Expected '<pattern>:<value>', got '" + spec + "'");
+  }
+  return {spec.substr(0, pos), spec.substr(pos + 1)};
+}
+
 }  // namespace foxglove_ws
@@ -14,6 +14,7 @@
 namespace foxglove_ws {
 
 constexpr size_t DEFAULT_SEND_BUFFER_LIMIT_BYTES = 10000000UL;  // 10 MB
+constexpr int DEFAULT_CHANNEL_PRIORITY = 0;
 
 using MapOfSets = std::unordered_map<std::string, std::unordered_set<std::string>>;
 
@@ -42,6 +43,28 @@ class ServiceError : public ExeptionWithId<ServiceId> {
   using ExeptionWithId::ExeptionWithId;
 };
 
+struct ClientBandwidthQuota {
+  std::regex clientGroupPattern;
+  size_t bytesPerSecond = 0;
+};
+
+struct ChannelPriority {
+  std::regex topicPattern;
+  int priority = 0;
+};
+
+struct ClientPublishLimit {
+  std::regex topicPattern;
+  std::optional<double> messagesPerSecond;  // Not set if not limited by this entry, 0 = unlimited
+  std::optional<size_t> bytesPerSecond;     // Not set if not limited by this entry, 0 = unlimited
+};
+
+struct ChannelHistoryLimit {
+  std::regex topicPattern;
+  double durationSeconds = 0.0;
+  size_t maxBytes = 0;  // 0 means unlimited
+};
+
 struct ServerOptions {
   std::vector<std::string> capabilities;
   std::vector<std::string> supportedEncodings;
@@ -53,6 +76,17 @@ struct ServerOptions {
   std::string sessionId;
   bool useCompression = false;
   std::vector<std::regex> clientTopicWhitelistPatterns;
+  size_t clientBandwidthLimitBytesPerSec = 0;  // 0 means unlimited
+  size_t clientBandwidthBurstBytes = 0;        // 0 means one second worth of the client's limit
+  std::vector<ClientBandwidthQuota> clientBandwidthQuotas;
+  size_t globalSendBufferLimitBytes = 0;  // 0 means unlimited
+  double egressCpuBudget = 0.0;           // Fraction of a CPU core, 0 means unlimited
+  std::vector<ChannelPriority> channelPriorities;
+  std::vector<ClientPublishLimit> clientPublishLimits;  // First matching limit of each kind wins
+  std::vector<std::regex> lastMessageCacheTopicPatterns;
+  std::vector<ChannelHistoryLimit> channelHistoryLimits;  // First match wins
+  size_t lastMessageCacheBudgetBytes = 0;  // Includes channel histories, 0 means unlimited
+  size_t parameterUpdateIntervalMs = 0;    // Min interval between parameter updates, 0 disables
 };
 
 template <typename ConnectionHandle>
@@ -74,6 +108,8 @@ struct ServerHandlers {
   std::function<void(const ServiceRequest&, ConnectionHandle)> serviceRequestHandler;
   std::function<void(bool)> subscribeConnectionGraphHandler;
   std::function<void(const std::string&, uint32_t, ConnectionHandle)> fetchAssetHandler;
+  /// Called after the handlers above have released the state of a disconnected client.
+  std::function<void(ConnectionHandle)> clientDisconnectHandler;
 };
 
 template <typename ConnectionHandle>
@@ -96,9 +132,15 @@ public:
 
   virtual void sendMessage(ConnectionHandle clientHandle, ChannelId chanId, uint64_t timestamp,
                            const uint8_t* payload, size_t payloadSize) = 0;
+  virtual void broadcastMessage(ChannelId chanId, uint64_t timestamp, const uint8_t* payload,
+                                size_t payloadSize) = 0;
   virtual void broadcastTime(uint64_t timestamp) = 0;
   virtual void sendServiceResponse(ConnectionHandle clientHandle,
                                    const ServiceResponse& response) = 0;
+  /// Same as above, with the payload being copied straight from `data` into the outgoing frame.
+  virtual void sendServiceResponse(ConnectionHandle clientHandle, ServiceId serviceId,
+                                   uint32_t callId, const std::string& encoding,
+                                   const uint8_t* data, size_t dataSize) = 0;
   virtual void sendServiceFailure(ConnectionHandle clientHandle, ServiceId serviceId,
                                   uint32_t callId, const std::string& message) = 0;
   virtual void updateConnectionGraph(const MapOfSets& publishedTopics,
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common.hpp"
+
+namespace foxglove_ws {
+
+/// Cache of responses of idempotent services, keyed by service and request payload.
+///
+/// Besides caching responses for a while, identical requests that arrive while a call is in flight
+/// are coalesced: they are told the key of the in-flight call instead of making a call of their
+/// own, and share its response. Not thread-safe, the caller has to synchronize access.
+class ServiceResponseCache {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Response = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct Statistics {
+    size_t hits = 0;       // Answered from the cache
+    size_t coalesced = 0;  // Joined an identical call in flight
+    size_t misses = 0;     // Had to call the service
+  };
+
+  struct Lookup {
+    /// Cached response, if there is one that has not expired yet.
+    Response response;
+    /// Key of the identical call in flight, if any.
+    std::optional<uint64_t> inFlightCall;
+  };
+
+  /// Look up a response for the given request. If there is neither a cached response nor an
+  /// identical call in flight, `callKey` is registered as in-flight call of this request and
+  /// must be finished with complete() or abandon().
+  Lookup lookup(ServiceId serviceId, const std::vector<uint8_t>& request, uint64_t callKey,
+                Clock::time_point now = Clock::now()) {
+    Key key{serviceId, request};
+    auto entryIt = _entries.find(key);
+    if (entryIt != _entries.end()) {
+      auto& entry = entryIt->second;
+      if (entry.response && entry.expiry > now) {
+        ++_statistics.hits;
+        return {entry.response, std::nullopt};
+      } else if (entry.inFlightCall) {
+        ++_statistics.coalesced;
+        return {nullptr, entry.inFlightCall};
+      }
+      entry.response = nullptr;
+    } else {
+      entryIt = _entries.emplace(std::move(key), Entry{}).first;
+    }
+
+    ++_statistics.misses;
+    entryIt->second.inFlightCall = callKey;
+    _inFlightCalls.emplace(callKey, entryIt->first);
+    return {};
+  }
+
+  /// Store the response of an in-flight call. It is served until `expiry`.
+  void complete(uint64_t callKey, Response response, Clock::time_point expiry) {
+    const auto entryIt = finishCall(callKey);
+    if (entryIt != _entries.end()) {
+      entryIt->second.response = std::move(response);
+      entryIt->second.expiry = expiry;
+    }
+  }
+
+  /// Forget an in-flight call that failed, so that the next identical request calls again.
+  void abandon(uint64_t callKey) {
+    const auto entryIt = finishCall(callKey);
+    if (entryIt != _entries.end() && !entryIt->second.response) {
+      _entries.erase(entryIt);
+    }
+  }
+
+  /// Drop the cached responses of a service, e.g. once it is no longer available. Calls in flight
+  /// are kept until they are completed or abandoned.
+  void removeService(ServiceId serviceId) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+      if (it->first.serviceId == serviceId && !it->second.inFlightCall) {
+        it = _entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void removeExpired(Clock::time_point now = Clock::now()) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+      if (!it->second.inFlightCall && it->second.expiry <= now) {
+        it = _entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  /// Number of cached responses and calls in flight.
+  size_t size() const {
+    return _entries.size();
+  }
+
+  const Statistics& statistics() const {
+    return _statistics;
+  }
+
+private:
+  struct Key {
+    ServiceId serviceId;
+    std::vector<uint8_t> request;
+
+    bool operator==(const Key& other) const {
+      return serviceId == other.serviceId && request == other.request;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      const std::string_view bytes(reinterpret_cast<const char*>(key.request.data()),
+                                   key.request.size());
+      return std::hash<std::string_view>()(bytes) ^ (std::hash<ServiceId>()(key.serviceId) << 1);
+    }
+  };
+
+  struct Entry {
+    Response response;
+    Clock::time_point expiry;
+    std::optional<uint64_t> inFlightCall;
+  };
+
+  using Entries = std::unordered_map<Key, Entry, KeyHash>;
+
+  Entries::iterator finishCall(uint64_t callKey) {
+    const auto callIt = _inFlightCalls.find(callKey);
+    if (callIt == _inFlightCalls.end()) {
+      return _entries.end();
+    }
+    const auto entryIt = _entries.find(callIt->second);
+    _inFlightCalls.erase(callIt);
+    if (entryIt != _entries.end()) {
+      entryIt->second.inFlightCall = std::nullopt;
+    }
+    return entryIt;
+  }
+
+  Entries _entries;
+  /// Keys of the in-flight calls, so that calls can be finished without their request payload.
+  std::unordered_map<uint64_t, Key> _inFlightCalls;
+  Statistics _statistics;
+};
+
+}  // namespace foxglove_ws
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace foxglove_ws {
+
+/// Thread-safe token bucket used to enforce byte rate limits.
+/// The bucket starts full and refills continuously at `ratePerSecond` tokens per second, up to
+/// `capacity` tokens.
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket(double ratePerSecond, double capacity, Clock::time_point now = Clock::now())
+      : _ratePerSecond(ratePerSecond)
+      , _capacity(capacity)
+      , _tokens(capacity)
+      , _lastRefill(now) {}
+
+  TokenBucket(const TokenBucket&) = delete;
+  TokenBucket& operator=(const TokenBucket&) = delete;
+
+  /// Try to take `amount` tokens out of the bucket. Returns false if there are not enough tokens.
+  /// A full bucket always grants the request, so that requests larger than the capacity are not
+  /// starved forever. The resulting debt is paid off by the following refills.
+  bool tryConsume(double amount, Clock::time_point now = Clock::now()) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill(now);
+    if (_tokens < amount && _tokens < _capacity) {
+      return false;
+    }
+    _tokens -= amount;
+    return true;
+  }
+
+  /// Return `amount` previously consumed tokens to the bucket, e.g. when the operation they were
+  /// taken for did not happen after all. The bucket never holds more than `capacity` tokens.
+  void refund(double amount) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tokens = std::min(_capacity, _tokens + amount);
+  }
+
+  double ratePerSecond() const {
+    return _ratePerSecond;
+  }
+
+  double capacity() const {
+    return _capacity;
+  }
+
+private:
+  void refill(Clock::time_point now) {
+    if (now <= _lastRefill) {
+      return;
+    }
+    const std::chrono::duration<double> elapsed = now - _lastRefill;
+    _tokens = std::min(_capacity, _tokens + elapsed.count() * _ratePerSecond);
+    _lastRefill = now;
+  }
+
+  const double _ratePerSecond;
+  const double _capacity;
+  double _tokens;
+  Clock::time_point _lastRefill;
+  std::mutex _mutex;
+};
+
+}  // namespace foxglove_ws
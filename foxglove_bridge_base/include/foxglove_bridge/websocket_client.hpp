@@ -39,6 +39,8 @@ public:
 
   virtual void subscribe(
     const std::vector<std::pair<SubscriptionId, ChannelId>>& subscriptions) = 0;
+  virtual void subscribe(const std::vector<std::pair<SubscriptionId, ChannelId>>& subscriptions,
+                         bool replayHistory) = 0;
   virtual void unsubscribe(const std::vector<SubscriptionId>& subscriptionIds) = 0;
   virtual void advertise(const std::vector<ClientAdvertisement>& channels) = 0;
   virtual void unadvertise(const std::vector<ClientChannelId>& channelIds) = 0;
@@ -150,9 +152,18 @@ public:
   }
 
   void subscribe(const std::vector<std::pair<SubscriptionId, ChannelId>>& subscriptions) override {
+    subscribe(subscriptions, false);
+  }
+
+  void subscribe(const std::vector<std::pair<SubscriptionId, ChannelId>>& subscriptions,
+                 bool replayHistory) override {
     nlohmann::json subscriptionsJson;
     for (const auto& [subId, channelId] : subscriptions) {
-      subscriptionsJson.push_back({{"id", subId}, {"channelId", channelId}});
+      nlohmann::json subscriptionJson = {{"id", subId}, {"channelId", channelId}};
+      if (replayHistory) {
+        subscriptionJson["replayHistory"] = true;
+      }
+      subscriptionsJson.push_back(std::move(subscriptionJson));
     }
 
     const std::string payload =
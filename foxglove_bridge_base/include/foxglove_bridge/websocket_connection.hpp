@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace foxglove_ws {
+
+constexpr uint32_t INVALID_CONNECTION_SLOT = std::numeric_limits<uint32_t>::max();
+
+/// Base class of all websocketpp connections (`connection_base` of the server configurations).
+/// Holds state that is accessed from the I/O thread without taking any of the server's locks.
+struct ConnectionState {
+  /// Index of the connection's state in the server's slot table, so that the state can be found
+  /// from a connection without a map lookup.
+  std::atomic<uint32_t> connectionSlot = INVALID_CONNECTION_SLOT;
+  /// Number of channel (un)advertisements and client messages of this connection that are waiting
+  /// in the handler queue. While non-zero, client messages must not take the fast path as they
+  /// could otherwise overtake the advertisement of their channel or earlier messages.
+  std::atomic<uint32_t> pendingChannelUpdates = 0;
+};
+
+}  // namespace foxglove_ws
@@ -4,6 +4,7 @@
 #include <websocketpp/extensions/permessage_deflate/enabled.hpp>
 #include <websocketpp/server.hpp>
 
+#include "./websocket_connection.hpp"
 #include "./websocket_logging.hpp"
 
 namespace foxglove_ws {
@@ -26,6 +27,8 @@ struct WebSocketNoTls : public websocketpp::config::core {
 
   typedef base::rng_type rng_type;
 
+  typedef ConnectionState connection_base;
+
   struct transport_config : public base::transport_config {
     typedef type::concurrency_type concurrency_type;
     typedef CallbackLogger alog_type;
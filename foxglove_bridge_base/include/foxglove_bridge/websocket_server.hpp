@@ -1,12 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <ctime>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <shared_mutex>
 #include <string_view>
 #include <thread>
@@ -24,6 +30,8 @@
 #include "regex_utils.hpp"
 #include "serialization.hpp"
 #include "server_interface.hpp"
+#include "token_bucket.hpp"
+#include "websocket_connection.hpp"
 #include "websocket_logging.hpp"
 
 // Debounce a function call (tied to the line number)
@@ -40,6 +48,13 @@
 
 namespace {
 
+/// CPU time consumed by the calling thread in nanoseconds.
+inline int64_t threadCpuTimeNs() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<int64_t>(ts.tv_nsec);
+}
+
 constexpr uint32_t StringHash(const std::string_view str) {
   uint32_t result = 0x811C9DC5;  // FNV-1a 32-bit algorithm
   for (char c : str) {
@@ -59,6 +74,34 @@ constexpr auto UNSUBSCRIBE_PARAMETER_UPDATES = StringHash("unsubscribeParameterU
 constexpr auto SUBSCRIBE_CONNECTION_GRAPH = StringHash("subscribeConnectionGraph");
 constexpr auto UNSUBSCRIBE_CONNECTION_GRAPH = StringHash("unsubscribeConnectionGraph");
 constexpr auto FETCH_ASSET = StringHash("fetchAsset");
+
+/// Returns the value of the given query parameter of a resource URI (e.g. "/?group=foo").
+inline std::optional<std::string> GetQueryParameter(const std::string& resource,
+                                                    const std::string& key) {
+  const auto queryStart = resource.find('?');
+  if (queryStart == std::string::npos) {
+    return std::nullopt;
+  }
+  const auto query = resource.substr(queryStart + 1, resource.find('#') - queryStart - 1);
+
+  size_t pos = 0;
+  while (pos <= query.size()) {
+    const auto end = std::min(query.find('&', pos), query.size());
+    const auto param = query.substr(pos, end - pos);
+    if (param.size() > key.size() && param.compare(0, key.size(), key) == 0 &&
+        param[key.size()] == '=') {
+      return param.substr(key.size() + 1);
+    }
+    pos = end + 1;
+  }
+  return std::nullopt;
+}
+
+/// Returns the host of a remote endpoint, e.g. "192.168.1.10" of "192.168.1.10:53210".
+inline std::string GetEndpointHost(const std::string& endpoint) {
+  const auto portStart = endpoint.rfind(':');
+  return portStart == std::string::npos ? endpoint : endpoint.substr(0, portStart);
+}
 }  // namespace
 
 namespace foxglove_ws {
@@ -72,6 +115,23 @@ static const websocketpp::log::level APP = websocketpp::log::alevel::app;
 static const websocketpp::log::level WARNING = websocketpp::log::elevel::warn;
 static const websocketpp::log::level RECOVERABLE = websocketpp::log::elevel::rerror;
 
+/// Query parameter of the connection URI used to assign a client to a group (e.g. for bandwidth
+/// quotas). Clients without this parameter are grouped by their remote endpoint.
+constexpr char CLIENT_GROUP_QUERY_PARAMETER[] = "group";
+
+/// Minimum interval between two warnings of the same kind sent to a client.
+constexpr int64_t CLIENT_WARNING_INTERVAL_NS = 2'500'000'000;
+
+/// Interval at which the global load is evaluated to adjust the overload shedding level.
+constexpr long LOAD_CHECK_INTERVAL_MS = 100;
+/// Load (relative to the configured budgets) below which shed priority classes are restored.
+constexpr double LOAD_RECOVERY_THRESHOLD = 0.8;
+
+/// Size of the header of message data frames (opcode, subscription id and timestamp).
+constexpr size_t MESSAGE_DATA_HEADER_SIZE = 1 + 4 + 8;
+/// Delay before cached messages are sent to a client whose send buffer was full.
+constexpr long CACHE_REPLAY_RETRY_INTERVAL_MS = 10;
+
 /// Map of required capability by client operation (text).
 const std::unordered_map<std::string, std::string> CAPABILITY_BY_CLIENT_OPERATION = {
   // {"subscribe", },   // No required capability.
@@ -117,6 +177,7 @@ class Server final : public ServerInterface<ConnHandle> {
 public:
   using ServerType = websocketpp::server<ServerConfiguration>;
   using ConnectionType = websocketpp::connection<ServerConfiguration>;
+  using ConnectionPtr = std::shared_ptr<ConnectionType>;
   using MessagePtr = typename ServerType::message_ptr;
   using Tcp = websocketpp::lib::asio::ip::tcp;
 
@@ -143,8 +204,16 @@ public:
 
   void sendMessage(ConnHandle clientHandle, ChannelId chanId, uint64_t timestamp,
                    const uint8_t* payload, size_t payloadSize) override;
+  /// Send a message to all clients subscribed to the given channel. Channels whose topic matches
+  /// one of the last message cache or channel history patterns remember the message, so that
+  /// clients subscribing later on receive it (or the channel's history) right away.
+  void broadcastMessage(ChannelId chanId, uint64_t timestamp, const uint8_t* payload,
+                        size_t payloadSize) override;
   void broadcastTime(uint64_t timestamp) override;
   void sendServiceResponse(ConnHandle clientHandle, const ServiceResponse& response) override;
+  void sendServiceResponse(ConnHandle clientHandle, ServiceId serviceId, uint32_t callId,
+                           const std::string& encoding, const uint8_t* data,
+                           size_t dataSize) override;
   void sendServiceFailure(ConnHandle clientHandle, ServiceId serviceId, uint32_t callId,
                           const std::string& message) override;
   void updateConnectionGraph(const MapOfSets& publishedTopics, const MapOfSets& subscribedTopics,
@@ -155,22 +224,83 @@ public:
   std::string remoteEndpointString(ConnHandle clientHandle) override;
 
 private:
+  /// Channel advertised by a client, along with its ingress rate limits.
+  struct ClientPublication {
+    ClientAdvertisement advertisement;
+    std::unique_ptr<TokenBucket> messageRateLimit;
+    std::unique_ptr<TokenBucket> byteRateLimit;
+  };
+
+  /// Kinds of warnings about dropped messages, each debounced separately per client.
+  enum class ClientWarning : size_t {
+    SendBufferLimit,
+    Overload,
+    BandwidthQuota,
+    PublishLimit,
+    Count,
+  };
+
+  using SharedPayload = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct CachedMessage {
+    uint64_t timestamp;
+    uint64_t sequence;  // Order in which messages were cached, across all channels
+    SharedPayload payload;
+  };
+
+  /// Messages still to be sent to a client on one channel: the cached messages, followed by the
+  /// newer messages that were queued behind them. The oldest messages are dropped once the queue
+  /// exceeds `maxBytes`, see queueBehindPendingReplay().
+  struct PendingReplay {
+    std::deque<CachedMessage> messages;
+    size_t bytes = 0;
+    size_t maxBytes = 0;
+  };
+
+  /// State of a client connection. Owned by the slot table `_clients` and found through the slot
+  /// index stored in the websocketpp connection (see ConnectionState).
   struct ClientInfo {
     std::string name;
     ConnHandle handle;
     std::unordered_map<ChannelId, SubscriptionId> subscriptionsByChannel;
-    std::unordered_set<ClientChannelId> advertisedChannels;
+    // Priority class of each subscribed channel, so that load shedding needs no channel lookup.
+    std::unordered_map<ChannelId, int> channelPriorities;
+    std::unordered_map<ClientChannelId, std::shared_ptr<ClientPublication>> advertisedChannels;
+    std::unordered_set<std::string> subscribedParameters;
     bool subscribedToConnectionGraph = false;
+    std::shared_ptr<TokenBucket> bandwidthQuota;  // Shared by the clients of a quota group
+    // Steady clock time of the last warning of each kind, updated under the shared clients lock.
+    std::array<std::atomic<int64_t>, static_cast<size_t>(ClientWarning::Count)> lastWarningNs;
+    // Cached messages still to be sent to the client, by channel. While a channel has pending
+    // messages, its newer messages are queued behind them, see replayCachedMessages().
+    std::mutex replayMutex;
+    std::unordered_map<ChannelId, PendingReplay> pendingReplays;
+    bool replayScheduled = false;
 
     explicit ClientInfo(const std::string& name, ConnHandle handle)
         : name(name)
-        , handle(handle) {}
+        , handle(handle) {
+      for (auto& lastWarning : lastWarningNs) {
+        lastWarning = -CLIENT_WARNING_INTERVAL_NS;
+      }
+    }
 
     ClientInfo(const ClientInfo&) = delete;
     ClientInfo& operator=(const ClientInfo&) = delete;
+  };
 
-    ClientInfo(ClientInfo&&) = default;
-    ClientInfo& operator=(ClientInfo&&) = default;
+  /// Last message, or the messages of the last `historyDurationNs`, of a channel. The mutex orders
+  /// cache updates with queueing cached messages for new subscribers, so that they never receive a
+  /// cached message after a newer one.
+  struct ChannelCache {
+    std::mutex mutex;
+    ChannelId channelId = 0;
+    bool removed = false;
+    bool cacheLastMessage = false;
+    uint64_t historyDurationNs = 0;  // 0 means no history, only the last message is kept
+    size_t historyMaxBytes = 0;
+    std::deque<CachedMessage> messages;
+    size_t bytes = 0;
   };
 
   std::string _name;
@@ -178,23 +308,33 @@ private:
   ServerOptions _options;
   ServerType _server;
   std::unique_ptr<std::thread> _serverThread;
+  // Declared after the client message queue so that it is destroyed first, as its callbacks may
+  // add to the client message queue.
+  std::unique_ptr<CallbackQueue> _clientMessageCallbackQueue;
   std::unique_ptr<CallbackQueue> _handlerCallbackQueue;
 
   uint32_t _nextChannelId = 0;
-  std::map<ConnHandle, ClientInfo, std::owner_less<>> _clients;
+  std::vector<std::unique_ptr<ClientInfo>> _clients;  // Indexed by connection slot
+  std::vector<uint32_t> _freeClientSlots;
+  // Token buckets of the client groups with a quota, while a client of the group is connected.
+  std::unordered_map<std::string, std::weak_ptr<TokenBucket>> _groupBandwidthQuotas;
+  std::mutex _groupBandwidthQuotasMutex;
   std::unordered_map<ChannelId, Channel> _channels;
-  std::map<ConnHandle, std::unordered_map<ClientChannelId, ClientAdvertisement>, std::owner_less<>>
-    _clientChannels;
-  std::map<ConnHandle, std::unordered_set<std::string>, std::owner_less<>>
-    _clientParamSubscriptions;
+  std::unordered_map<ChannelId, int> _channelPriorities;
   ServiceId _nextServiceId = 0;
   std::unordered_map<ServiceId, ServiceWithoutId> _services;
   ServerHandlers<ConnHandle> _handlers;
   std::shared_mutex _clientsMutex;
   std::shared_mutex _channelsMutex;
-  std::shared_mutex _clientChannelsMutex;
   std::shared_mutex _servicesMutex;
-  std::mutex _clientParamSubscriptionsMutex;
+  std::unordered_map<ChannelId, std::shared_ptr<ChannelCache>> _channelCaches;
+  std::atomic<size_t> _channelCachesBytes = 0;
+  std::shared_mutex _channelCachesMutex;
+  std::mutex _cacheBudgetMutex;
+  // Sequence of the oldest message of each non-empty cache, only kept if the cache budget is set.
+  std::set<std::pair<uint64_t, ChannelId>> _oldestCachedMessages;
+  std::atomic<uint64_t> _nextCachedMessageSequence = 0;
+  std::atomic<size_t> _pendingReplayCount = 0;  // Channels with pending replays of all clients
 
   struct {
     int subscriptionCount = 0;
@@ -204,25 +344,79 @@ private:
   } _connectionGraph;
   std::shared_mutex _connectionGraphMutex;
 
+  // Global overload shedding. Channels with a priority below _priorityLevels[_shedLevel] are
+  // dropped for all clients.
+  std::vector<int> _priorityLevels;
+  std::atomic<size_t> _shedLevel = 0;
+  std::atomic<int64_t> _sendPathNs = 0;
+  std::atomic<int64_t> _lastLoadCheckNs = 0;
+  typename ServerType::timer_ptr _loadCheckTimer;  // Only used on the server thread
+
+  // Clients by subscribed parameter name, guarded by _clientsMutex. Entries are removed once the
+  // last client unsubscribes.
+  std::unordered_map<std::string, std::unordered_set<ClientInfo*>> _paramSubscribers;
+  // Parameter updates held back to send at most one update per parameterUpdateIntervalMs.
+  std::mutex _paramUpdatesMutex;
+  std::unordered_map<std::string, Parameter> _pendingParamUpdates;
+  std::chrono::steady_clock::time_point _lastParamUpdateTime;
+  bool _paramUpdateFlushScheduled = false;
+
   void setupTlsHandler();
   void socketInit(ConnHandle hdl);
   bool validateConnection(ConnHandle hdl);
   void handleConnectionOpened(ConnHandle hdl);
-  void handleConnectionClosed(ConnHandle hdl);
-  void handleMessage(ConnHandle hdl, MessagePtr msg);
+  void handleConnectionClosed(ConnHandle hdl, uint32_t slot);
+  void dispatchMessage(ConnHandle hdl, MessagePtr msg);
+  void handleMessage(ConnHandle hdl, const ConnectionPtr& con, MessagePtr msg);
   void handleTextMessage(ConnHandle hdl, MessagePtr msg);
-  void handleBinaryMessage(ConnHandle hdl, MessagePtr msg);
+  void handleBinaryMessage(ConnHandle hdl, const ConnectionPtr& con, MessagePtr msg);
 
   void sendJson(ConnHandle hdl, json&& payload);
   void sendJsonRaw(ConnHandle hdl, const std::string& payload);
   void sendBinary(ConnHandle hdl, const uint8_t* payload, size_t payloadSize);
+  void prepareBinaryFrame(const MessagePtr& message) const;
   void sendStatusAndLogMsg(ConnHandle clientHandle, const StatusLevel level,
                            const std::string& message);
+  void sendClientWarning(const ConnectionPtr& con, ConnHandle clientHandle, ClientWarning warning,
+                         const std::string& message);
   void unsubscribeParamsWithoutSubscriptions(ConnHandle hdl,
                                              const std::unordered_set<std::string>& paramNames);
   bool isParameterSubscribed(const std::string& paramName) const;
+  void removeParamSubscriber(const std::string& paramName, ClientInfo* client);
+  void sendParameterUpdates(const std::vector<Parameter>& parameters);
+  void flushParameterUpdates();
+  ClientInfo* findClient(const ConnectionPtr& con);
+  ClientInfo* findClient(ConnHandle hdl);
+  ClientInfo& getClient(ConnHandle hdl);
   bool hasCapability(const std::string& capability) const;
   bool hasHandler(uint32_t op) const;
+  std::shared_ptr<TokenBucket> createBandwidthQuota(const std::string& clientGroup);
+  void setClientPublishLimits(ClientPublication& publication) const;
+  bool isClientPublishLimitExceeded(ClientPublication& publication, size_t payloadSize) const;
+  bool dropClientMessageOverLimit(ConnHandle hdl, const ConnectionPtr& con,
+                                  const std::string& payload);
+  bool isOverloadSheddingEnabled() const;
+  int channelPriority(const std::string& topic) const;
+  std::shared_ptr<ChannelCache> createChannelCache(const std::string& topic) const;
+  std::shared_ptr<ChannelCache> findChannelCache(ChannelId chanId);
+  void cacheMessage(ChannelCache& cache, uint64_t timestamp, const uint8_t* payload,
+                    size_t payloadSize);
+  void evictCachedMessage(ChannelCache& cache);
+  static std::optional<uint64_t> oldestCachedSequence(const ChannelCache& cache);
+  void updateOldestCachedMessage(const ChannelCache& cache,
+                                 std::optional<uint64_t> previousOldestSequence);
+  void enforceCacheBudget();
+  void sendChannelMessage(ConnHandle clientHandle, ChannelId chanId, uint64_t timestamp,
+                          const uint8_t* payload, size_t payloadSize,
+                          const SharedPayload& sharedPayload);
+  void sendMessageFrame(const ConnectionPtr& con, SubscriptionId subId, uint64_t timestamp,
+                        const uint8_t* payload, size_t payloadSize);
+  bool queueBehindPendingReplay(PendingReplay& replay, uint64_t timestamp, const uint8_t* payload,
+                                size_t payloadSize, const SharedPayload& sharedPayload);
+  void replayCachedMessages(ConnHandle hdl);
+  void scheduleLoadCheck();
+  void updateLoadShedding();
+  bool isPriorityShed(int priority) const;
   void handleSubscribe(const nlohmann::json& payload, ConnHandle hdl);
   void handleUnsubscribe(const nlohmann::json& payload, ConnHandle hdl);
   void handleAdvertise(const nlohmann::json& payload, ConnHandle hdl);
@@ -259,20 +453,34 @@ inline Server<ServerConfiguration>::Server(std::string name, LogCallback logger,
   _server.set_validate_handler(std::bind(&Server::validateConnection, this, std::placeholders::_1));
   _server.set_open_handler(std::bind(&Server::handleConnectionOpened, this, std::placeholders::_1));
   _server.set_close_handler([this](ConnHandle hdl) {
-    _handlerCallbackQueue->addCallback([this, hdl]() {
-      this->handleConnectionClosed(hdl);
+    // The connection may already be gone when the callback is executed, hence the slot is
+    // retrieved here.
+    websocketpp::lib::error_code ec;
+    const auto con = _server.get_con_from_hdl(hdl, ec);
+    const uint32_t slot = con ? con->connectionSlot.load() : INVALID_CONNECTION_SLOT;
+    _handlerCallbackQueue->addCallback([this, hdl, slot]() {
+      this->handleConnectionClosed(hdl, slot);
     });
   });
   _server.set_message_handler([this](ConnHandle hdl, MessagePtr msg) {
-    _handlerCallbackQueue->addCallback([this, hdl, msg]() {
-      this->handleMessage(hdl, msg);
-    });
+    this->dispatchMessage(hdl, msg);
   });
   _server.set_reuse_addr(true);
   _server.set_listen_backlog(128);
 
+  _priorityLevels.push_back(DEFAULT_CHANNEL_PRIORITY);
+  for (const auto& channelPriority : _options.channelPriorities) {
+    _priorityLevels.push_back(channelPriority.priority);
+  }
+  std::sort(_priorityLevels.begin(), _priorityLevels.end());
+  _priorityLevels.erase(std::unique(_priorityLevels.begin(), _priorityLevels.end()),
+                        _priorityLevels.end());
+
   // Callback queue for handling client requests and disconnections.
   _handlerCallbackQueue = std::make_unique<CallbackQueue>(_logger, /*numThreads=*/1ul);
+  // Callback queue for publishing client messages, so that high-rate client publishing neither
+  // waits for nor delays client requests. A single thread keeps messages in order.
+  _clientMessageCallbackQueue = std::make_unique<CallbackQueue>(_logger, /*numThreads=*/1ul);
 }
 
 template <typename ServerConfiguration>
@@ -309,9 +517,31 @@ inline void Server<ServerConfiguration>::handleConnectionOpened(ConnHandle hdl)
   const auto endpoint = remoteEndpointString(hdl);
   _server.get_alog().write(APP, "Client " + endpoint + " connected via " + con->get_resource());
 
+  // Without a group, connections from the same host form a group, so that a client can not get
+  // around its quota by opening more connections.
+  const auto clientGroup = GetQueryParameter(con->get_resource(), CLIENT_GROUP_QUERY_PARAMETER)
+                             .value_or(GetEndpointHost(endpoint));
+  auto clientInfo = std::make_unique<ClientInfo>(endpoint, hdl);
+  clientInfo->bandwidthQuota = createBandwidthQuota(clientGroup);
+  if (clientInfo->bandwidthQuota) {
+    _server.get_alog().write(
+      APP, "Client " + endpoint + " (group '" + clientGroup + "') is limited to " +
+             std::to_string(static_cast<size_t>(clientInfo->bandwidthQuota->ratePerSecond())) +
+             " bytes/s");
+  }
+
   {
     std::unique_lock<std::shared_mutex> lock(_clientsMutex);
-    _clients.emplace(hdl, ClientInfo(endpoint, hdl));
+    uint32_t slot;
+    if (_freeClientSlots.empty()) {
+      slot = static_cast<uint32_t>(_clients.size());
+      _clients.push_back(std::move(clientInfo));
+    } else {
+      slot = _freeClientSlots.back();
+      _freeClientSlots.pop_back();
+      _clients[slot] = std::move(clientInfo);
+    }
+    con->connectionSlot = slot;
   }
 
   con->send(json({
@@ -351,32 +581,30 @@ inline void Server<ServerConfiguration>::handleConnectionOpened(ConnHandle hdl)
 }
 
 template <typename ServerConfiguration>
-inline void Server<ServerConfiguration>::handleConnectionClosed(ConnHandle hdl) {
-  std::unordered_map<ChannelId, SubscriptionId> oldSubscriptionsByChannel;
-  std::unordered_set<ClientChannelId> oldAdvertisedChannels;
-  std::string clientName;
-  bool wasSubscribedToConnectionGraph;
+inline void Server<ServerConfiguration>::handleConnectionClosed(ConnHandle hdl, uint32_t slot) {
+  std::unique_ptr<ClientInfo> client;
   {
     std::unique_lock<std::shared_mutex> lock(_clientsMutex);
-    const auto clientIt = _clients.find(hdl);
-    if (clientIt == _clients.end()) {
+    if (slot >= _clients.size() || !_clients[slot]) {
       _server.get_elog().write(RECOVERABLE, "Client " + remoteEndpointString(hdl) +
                                               " disconnected but not found in _clients");
       return;
     }
 
-    const auto& client = clientIt->second;
-    clientName = client.name;
-    _server.get_alog().write(APP, "Client " + clientName + " disconnected");
-
-    oldSubscriptionsByChannel = std::move(client.subscriptionsByChannel);
-    oldAdvertisedChannels = std::move(client.advertisedChannels);
-    wasSubscribedToConnectionGraph = client.subscribedToConnectionGraph;
-    _clients.erase(clientIt);
+    client = std::move(_clients[slot]);
+    _freeClientSlots.push_back(slot);
+    _pendingReplayCount -= client->pendingReplays.size();
+    for (const auto& paramName : client->subscribedParameters) {
+      removeParamSubscriber(paramName, client.get());
+    }
   }
 
+  const std::string& clientName = client->name;
+  _server.get_alog().write(APP, "Client " + clientName + " disconnected");
+
   // Unadvertise all channels this client advertised
-  for (const auto clientChannelId : oldAdvertisedChannels) {
+  for (const auto& [clientChannelId, advertisement] : client->advertisedChannels) {
+    (void)advertisement;
     _server.get_alog().write(APP, "Client " + clientName + " unadvertising channel " +
                                     std::to_string(clientChannelId) + " due to disconnect");
     if (_handlers.clientUnadvertiseHandler) {
@@ -391,14 +619,9 @@ inline void Server<ServerConfiguration>::handleConnectionClosed(ConnHandle hdl)
     }
   }
 
-  {
-    std::unique_lock<std::shared_mutex> lock(_clientChannelsMutex);
-    _clientChannels.erase(hdl);
-  }
-
   // Unsubscribe all channels this client subscribed to
   if (_handlers.unsubscribeHandler) {
-    for (const auto& [chanId, subs] : oldSubscriptionsByChannel) {
+    for (const auto& [chanId, subs] : client->subscriptionsByChannel) {
       (void)subs;
       try {
         _handlers.unsubscribeHandler(chanId, hdl);
@@ -412,15 +635,9 @@ inline void Server<ServerConfiguration>::handleConnectionClosed(ConnHandle hdl)
   }
 
   // Unsubscribe from parameters this client subscribed to
-  std::unordered_set<std::string> clientSubscribedParameters;
-  {
-    std::lock_guard<std::mutex> lock(_clientParamSubscriptionsMutex);
-    clientSubscribedParameters = _clientParamSubscriptions[hdl];
-    _clientParamSubscriptions.erase(hdl);
-  }
-  unsubscribeParamsWithoutSubscriptions(hdl, clientSubscribedParameters);
+  unsubscribeParamsWithoutSubscriptions(hdl, client->subscribedParameters);
 
-  if (wasSubscribedToConnectionGraph) {
+  if (client->subscribedToConnectionGraph) {
     std::unique_lock<std::shared_mutex> lock(_connectionGraphMutex);
     _connectionGraph.subscriptionCount--;
     if (_connectionGraph.subscriptionCount == 0 && _handlers.subscribeConnectionGraphHandler) {
@@ -436,6 +653,16 @@ inline void Server<ServerConfiguration>::handleConnectionClosed(ConnHandle hdl)
     }
   }
 
+  if (_handlers.clientDisconnectHandler) {
+    try {
+      _handlers.clientDisconnectHandler(hdl);
+    } catch (const std::exception& ex) {
+      _server.get_elog().write(
+        RECOVERABLE, "Exception caught when closing connection: " + std::string(ex.what()));
+    } catch (...) {
+      _server.get_elog().write(RECOVERABLE, "Exception caught when closing connection");
+    }
+  }
 }  // namespace foxglove_ws
 
 template <typename ServerConfiguration>
@@ -454,6 +681,14 @@ inline void Server<ServerConfiguration>::stop() {
 
   _server.stop_perpetual();
 
+  // The periodic load check would keep the run loop alive. Its timer is cancelled on the server
+  // thread, as timers must not be used from several threads.
+  _server.get_io_service().post([this]() {
+    if (_loadCheckTimer) {
+      _loadCheckTimer->cancel();
+    }
+  });
+
   if (_server.is_listening()) {
     _server.stop_listening(ec);
     if (ec) {
@@ -465,9 +700,11 @@ inline void Server<ServerConfiguration>::stop() {
   {
     std::shared_lock<std::shared_mutex> lock(_clientsMutex);
     connections.reserve(_clients.size());
-    for (const auto& [hdl, client] : _clients) {
-      (void)client;
-      if (auto connection = _server.get_con_from_hdl(hdl, ec)) {
+    for (const auto& client : _clients) {
+      if (!client) {
+        continue;
+      }
+      if (auto connection = _server.get_con_from_hdl(client->handle, ec)) {
         connections.push_back(connection);
       }
     }
@@ -517,8 +754,13 @@ inline void Server<ServerConfiguration>::stop() {
     _server.get_alog().write(APP, "WebSocket server run loop terminated");
   }
 
+  // The handler queue is stopped first, as its callbacks may still add to the client message queue.
+  _handlerCallbackQueue->stop();
+  _clientMessageCallbackQueue->stop();
+
   std::unique_lock<std::shared_mutex> lock(_clientsMutex);
   _clients.clear();
+  _freeClientSlots.clear();
 }
 
 template <typename ServerConfiguration>
@@ -540,6 +782,19 @@ inline void Server<ServerConfiguration>::start(const std::string& host, uint16_t
     throw std::runtime_error("Failed to start accepting connections: " + ec.message());
   }
 
+  if (isOverloadSheddingEnabled()) {
+    if (_priorityLevels.size() > 1) {
+      _lastLoadCheckNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count();
+      scheduleLoadCheck();
+    } else {
+      _server.get_elog().write(WARNING,
+                               "Global send buffer limit and egress CPU budget have no effect "
+                               "without topic priorities, as the only priority class is never "
+                               "shed");
+    }
+  }
   _serverThread = std::make_unique<std::thread>([this]() {
     _server.get_alog().write(APP, "WebSocket server run loop started");
     _server.run();
@@ -581,6 +836,19 @@ inline void Server<ServerConfiguration>::sendJsonRaw(ConnHandle hdl, const std::
   }
 }
 
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::prepareBinaryFrame(const MessagePtr& message) const {
+  // websocketpp frames unprepared messages by copying their payload into a newly allocated
+  // message. Server frames are never masked, so for uncompressed messages the frame header can be
+  // written up front instead: websocketpp then hands the header and the payload to the socket as
+  // separate buffers of a single write, without another copy.
+  const auto payloadSize = message->get_payload().size();
+  message->set_header(websocketpp::frame::prepare_header(
+    websocketpp::frame::basic_header(OpCode::BINARY, payloadSize, true, false),
+    websocketpp::frame::extended_header(payloadSize)));
+  message->set_prepared(true);
+}
+
 template <typename ServerConfiguration>
 inline void Server<ServerConfiguration>::sendBinary(ConnHandle hdl, const uint8_t* payload,
                                                     size_t payloadSize) {
@@ -609,13 +877,97 @@ inline void Server<ServerConfiguration>::sendStatusAndLogMsg(ConnHandle clientHa
 }
 
 template <typename ServerConfiguration>
-inline void Server<ServerConfiguration>::handleMessage(ConnHandle hdl, MessagePtr msg) {
+inline void Server<ServerConfiguration>::sendClientWarning(const ConnectionPtr& con,
+                                                           ConnHandle clientHandle,
+                                                           ClientWarning warning,
+                                                           const std::string& message) {
+  // Debounced per client and kind, so that every affected client is told without being flooded.
+  const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  {
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    auto* client = findClient(con);
+    if (!client) {
+      return;
+    }
+    auto& lastWarningNs = client->lastWarningNs[static_cast<size_t>(warning)];
+    int64_t lastNs = lastWarningNs.load();
+    if (nowNs - lastNs < CLIENT_WARNING_INTERVAL_NS ||
+        !lastWarningNs.compare_exchange_strong(lastNs, nowNs)) {
+      return;
+    }
+  }
+  sendStatusAndLogMsg(clientHandle, StatusLevel::Warning, message);
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::dispatchMessage(ConnHandle hdl, MessagePtr msg) {
+  const auto& payload = msg->get_payload();
+  const bool isClientMessage =
+    msg->get_opcode() == OpCode::BINARY && !payload.empty() &&
+    static_cast<ClientBinaryOpcode>(payload[0]) == ClientBinaryOpcode::MESSAGE_DATA;
+  // Conservative check, a false positive only routes client messages through the handler queue.
+  const bool isChannelUpdate = isClientMessage || (msg->get_opcode() == OpCode::TEXT &&
+                                                   payload.find("advertise") != std::string::npos);
+  // Unadvertisements are handled on the client message queue as well, so that they cannot overtake
+  // (and drop) client messages of the channel that are still queued. False positives are harmless.
+  const bool isClientQueueMessage =
+    isClientMessage ||
+    (msg->get_opcode() == OpCode::TEXT && payload.find("unadvertise") != std::string::npos);
+
+  websocketpp::lib::error_code ec;
+  const auto con = _server.get_con_from_hdl(hdl, ec);
+  // The connection is resolved once here and passed on, rather than looked up again from the
+  // handle while handling the message.
+  if (!con || !isChannelUpdate) {
+    _handlerCallbackQueue->addCallback([this, hdl, con, msg]() {
+      this->handleMessage(hdl, con, msg);
+    });
+    return;
+  }
+
+  // Client messages over their channel's publish limit are dropped before they are queued, so
+  // that they can not pile up in the client message queue.
+  if (isClientQueueMessage && con->pendingChannelUpdates == 0) {
+    if (!isClientMessage || !dropClientMessageOverLimit(hdl, con, payload)) {
+      _clientMessageCallbackQueue->addCallback([this, hdl, con, msg]() {
+        this->handleMessage(hdl, con, msg);
+      });
+    }
+    return;
+  }
+
+  // Preserve the order of (un)advertisements and client messages by passing client messages
+  // through the handler queue until all pending channel updates of this connection are handled.
+  // A message forwarded to the client message queue is only handled once it ran there, so that a
+  // following advertisement can not overtake it.
+  ++con->pendingChannelUpdates;
+  _handlerCallbackQueue->addCallback([this, hdl, msg, con, isClientMessage,
+                                      isClientQueueMessage]() {
+    if (isClientMessage && dropClientMessageOverLimit(hdl, con, msg->get_payload())) {
+      --con->pendingChannelUpdates;
+    } else if (isClientQueueMessage) {
+      _clientMessageCallbackQueue->addCallback([this, hdl, msg, con]() {
+        this->handleMessage(hdl, con, msg);
+        --con->pendingChannelUpdates;
+      });
+    } else {
+      this->handleMessage(hdl, con, msg);
+      --con->pendingChannelUpdates;
+    }
+  });
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::handleMessage(ConnHandle hdl, const ConnectionPtr& con,
+                                                       MessagePtr msg) {
   const OpCode op = msg->get_opcode();
   try {
     if (op == OpCode::TEXT) {
       handleTextMessage(hdl, msg);
     } else if (op == OpCode::BINARY) {
-      handleBinaryMessage(hdl, msg);
+      handleBinaryMessage(hdl, con, msg);
     }
   } catch (const std::exception& e) {
     sendStatusAndLogMsg(hdl, StatusLevel::Error, e.what());
@@ -698,7 +1050,9 @@ inline void Server<ServerConfiguration>::handleTextMessage(ConnHandle hdl, Messa
 }  // namespace foxglove_ws
 
 template <typename ServerConfiguration>
-inline void Server<ServerConfiguration>::handleBinaryMessage(ConnHandle hdl, MessagePtr msg) {
+inline void Server<ServerConfiguration>::handleBinaryMessage(ConnHandle hdl,
+                                                             const ConnectionPtr& con,
+                                                             MessagePtr msg) {
   const auto& payload = msg->get_payload();
   const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
   const size_t length = payload.size();
@@ -735,29 +1089,33 @@ inline void Server<ServerConfiguration>::handleBinaryMessage(ConnHandle hdl, Mes
                                std::chrono::high_resolution_clock::now().time_since_epoch())
                                .count();
       const ClientChannelId channelId = *reinterpret_cast<const ClientChannelId*>(data + 1);
-      std::shared_lock<std::shared_mutex> lock(_clientChannelsMutex);
-
-      auto clientPublicationsIt = _clientChannels.find(hdl);
-      if (clientPublicationsIt == _clientChannels.end()) {
-        sendStatusAndLogMsg(hdl, StatusLevel::Error, "Client has no advertised channels");
-        return;
-      }
+      std::shared_ptr<ClientPublication> publication;
+      {
+        std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+        const auto* client = con ? findClient(con) : nullptr;
+        if (!client) {
+          return;  // Client disconnected in the meantime.
+        } else if (client->advertisedChannels.empty()) {
+          sendStatusAndLogMsg(hdl, StatusLevel::Error, "Client has no advertised channels");
+          return;
+        }
 
-      auto& clientPublications = clientPublicationsIt->second;
-      const auto& channelIt = clientPublications.find(channelId);
-      if (channelIt == clientPublications.end()) {
-        sendStatusAndLogMsg(hdl, StatusLevel::Error,
-                            "Channel " + std::to_string(channelId) + " is not advertised");
-        return;
+        const auto& clientPublications = client->advertisedChannels;
+        const auto& channelIt = clientPublications.find(channelId);
+        if (channelIt == clientPublications.end()) {
+          sendStatusAndLogMsg(hdl, StatusLevel::Error,
+                              "Channel " + std::to_string(channelId) + " is not advertised");
+          return;
+        }
+        publication = channelIt->second;
       }
 
       try {
-        const auto& advertisement = channelIt->second;
         const uint32_t sequence = 0;
         const ClientMessage clientMessage{static_cast<uint64_t>(timestamp),
                                           static_cast<uint64_t>(timestamp),
                                           sequence,
-                                          advertisement,
+                                          publication->advertisement,
                                           length,
                                           data};
         _handlers.clientMessageHandler(clientMessage, hdl);
@@ -826,15 +1184,22 @@ inline std::vector<ChannelId> Server<ServerConfiguration>::addChannels(
       channelIds.push_back(newId);
       Channel newChannel{newId, channelWithoutId};
       channelsJson.push_back(newChannel);
+      _channelPriorities.emplace(newId, channelPriority(newChannel.topic));
+      if (auto cache = createChannelCache(newChannel.topic)) {
+        cache->channelId = newId;
+        std::unique_lock<std::shared_mutex> channelCachesLock(_channelCachesMutex);
+        _channelCaches.emplace(newId, std::move(cache));
+      }
       _channels.emplace(newId, std::move(newChannel));
     }
   }
 
   const auto msg = json{{"op", "advertise"}, {"channels", channelsJson}}.dump();
   std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-  for (const auto& [hdl, clientInfo] : _clients) {
-    (void)clientInfo;
-    sendJsonRaw(hdl, msg);
+  for (const auto& client : _clients) {
+    if (client) {
+      sendJsonRaw(client->handle, msg);
+    }
   }
 
   return channelIds;
@@ -850,20 +1215,39 @@ inline void Server<ServerConfiguration>::removeChannels(const std::vector<Channe
     std::unique_lock<std::shared_mutex> channelsLock(_channelsMutex);
     for (auto channelId : channelIds) {
       _channels.erase(channelId);
+      _channelPriorities.erase(channelId);
+    }
+  }
+
+  {
+    std::unique_lock<std::shared_mutex> channelCachesLock(_channelCachesMutex);
+    for (auto channelId : channelIds) {
+      const auto it = _channelCaches.find(channelId);
+      if (it != _channelCaches.end()) {
+        std::lock_guard<std::mutex> cacheLock(it->second->mutex);
+        const auto previousOldestSequence = oldestCachedSequence(*it->second);
+        _channelCachesBytes -= it->second->bytes;
+        it->second->removed = true;
+        it->second->messages.clear();
+        it->second->bytes = 0;
+        updateOldestCachedMessage(*it->second, previousOldestSequence);
+        _channelCaches.erase(it);
+      }
     }
   }
 
   const auto msg = json{{"op", "unadvertise"}, {"channelIds", channelIds}}.dump();
 
   std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-  for (auto& [hdl, clientInfo] : _clients) {
+  for (auto& client : _clients) {
+    if (!client) {
+      continue;
+    }
     for (auto channelId : channelIds) {
-      if (const auto it = clientInfo.subscriptionsByChannel.find(channelId);
-          it != clientInfo.subscriptionsByChannel.end()) {
-        clientInfo.subscriptionsByChannel.erase(it);
-      }
+      client->subscriptionsByChannel.erase(channelId);
+      client->channelPriorities.erase(channelId);
     }
-    sendJsonRaw(hdl, msg);
+    sendJsonRaw(client->handle, msg);
   }
 }
 
@@ -888,19 +1272,108 @@ inline void Server<ServerConfiguration>::publishParameterValues(
 template <typename ServerConfiguration>
 inline void Server<ServerConfiguration>::updateParameterValues(
   const std::vector<Parameter>& parameters) {
-  std::lock_guard<std::mutex> lock(_clientParamSubscriptionsMutex);
-  for (const auto& clientParamSubscriptions : _clientParamSubscriptions) {
-    std::vector<Parameter> paramsToSendToClient;
-
-    // Only consider parameters that are subscribed by the client
-    std::copy_if(parameters.begin(), parameters.end(), std::back_inserter(paramsToSendToClient),
-                 [clientParamSubscriptions](const Parameter& param) {
-                   return clientParamSubscriptions.second.find(param.getName()) !=
-                          clientParamSubscriptions.second.end();
-                 });
+  if (_options.parameterUpdateIntervalMs == 0) {
+    sendParameterUpdates(parameters);
+    return;
+  }
+
+  const auto interval = std::chrono::milliseconds(_options.parameterUpdateIntervalMs);
+  std::unique_lock<std::mutex> lock(_paramUpdatesMutex);
+  const auto now = std::chrono::steady_clock::now();
+  if (!_paramUpdateFlushScheduled && now - _lastParamUpdateTime >= interval) {
+    // The first update after a quiet period is sent right away.
+    _lastParamUpdateTime = now;
+    lock.unlock();
+    sendParameterUpdates(parameters);
+    return;
+  }
+
+  // Later updates within the interval are coalesced, only the latest value of each parameter is
+  // sent once the interval has passed.
+  for (const auto& param : parameters) {
+    _pendingParamUpdates.insert_or_assign(param.getName(), param);
+  }
+  if (!_paramUpdateFlushScheduled) {
+    _paramUpdateFlushScheduled = true;
+    const auto delay =
+      std::chrono::duration_cast<std::chrono::milliseconds>(_lastParamUpdateTime + interval - now);
+    _server.set_timer(static_cast<long>(std::max<int64_t>(delay.count(), 0)),
+                      [this](const websocketpp::lib::error_code& ec) {
+                        if (ec) {
+                          return;  // The server is shutting down
+                        }
+                        flushParameterUpdates();
+                      });
+  }
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::removeParamSubscriber(const std::string& paramName,
+                                                               ClientInfo* client) {
+  const auto subscribersIt = _paramSubscribers.find(paramName);
+  if (subscribersIt != _paramSubscribers.end()) {
+    subscribersIt->second.erase(client);
+    if (subscribersIt->second.empty()) {
+      _paramSubscribers.erase(subscribersIt);
+    }
+  }
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::flushParameterUpdates() {
+  std::vector<Parameter> parameters;
+  {
+    std::lock_guard<std::mutex> lock(_paramUpdatesMutex);
+    parameters.reserve(_pendingParamUpdates.size());
+    for (auto& [name, param] : _pendingParamUpdates) {
+      parameters.push_back(std::move(param));
+    }
+    _pendingParamUpdates.clear();
+    _paramUpdateFlushScheduled = false;
+    _lastParamUpdateTime = std::chrono::steady_clock::now();
+  }
+  sendParameterUpdates(parameters);
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::sendParameterUpdates(
+  const std::vector<Parameter>& parameters) {
+  // Clients are grouped by the parameters they are sent, so that each distinct payload is only
+  // serialized once no matter how many clients receive it.
+  std::map<std::vector<size_t>, std::vector<ConnHandle>> clientsByParams;
+  {
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    if (_paramSubscribers.empty()) {
+      return;
+    }
+    std::unordered_map<ClientInfo*, std::vector<size_t>> paramsByClient;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      if (parameters[i].getType() == ParameterType::PARAMETER_NOT_SET) {
+        continue;
+      }
+      const auto subscribersIt = _paramSubscribers.find(parameters[i].getName());
+      if (subscribersIt == _paramSubscribers.end()) {
+        continue;
+      }
+      for (auto* client : subscribersIt->second) {
+        paramsByClient[client].push_back(i);
+      }
+    }
+    for (auto& [client, paramIndices] : paramsByClient) {
+      clientsByParams[std::move(paramIndices)].push_back(client->handle);
+    }
+  }
 
-    if (!paramsToSendToClient.empty()) {
-      publishParameterValues(clientParamSubscriptions.first, paramsToSendToClient);
+  for (const auto& [paramIndices, handles] : clientsByParams) {
+    std::vector<Parameter> params;
+    params.reserve(paramIndices.size());
+    for (const auto i : paramIndices) {
+      params.push_back(parameters[i]);
+    }
+    const std::string payload =
+      nlohmann::json{{"op", "parameterValues"}, {"parameters", std::move(params)}}.dump();
+    for (const auto& hdl : handles) {
+      sendJsonRaw(hdl, payload);
     }
   }
 }
@@ -924,9 +1397,10 @@ inline std::vector<ServiceId> Server<ServerConfiguration>::addServices(
 
   const auto msg = json{{"op", "advertiseServices"}, {"services", std::move(newServices)}}.dump();
   std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-  for (const auto& [hdl, clientInfo] : _clients) {
-    (void)clientInfo;
-    sendJsonRaw(hdl, msg);
+  for (const auto& client : _clients) {
+    if (client) {
+      sendJsonRaw(client->handle, msg);
+    }
   }
 
   return serviceIds;
@@ -947,9 +1421,10 @@ inline void Server<ServerConfiguration>::removeServices(const std::vector<Servic
     const auto msg =
       json{{"op", "unadvertiseServices"}, {"serviceIds", std::move(removedServices)}}.dump();
     std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    for (const auto& [hdl, clientInfo] : _clients) {
-      (void)clientInfo;
-      sendJsonRaw(hdl, msg);
+    for (const auto& client : _clients) {
+      if (client) {
+        sendJsonRaw(client->handle, msg);
+      }
     }
   }
 }
@@ -958,72 +1433,430 @@ template <typename ServerConfiguration>
 inline void Server<ServerConfiguration>::sendMessage(ConnHandle clientHandle, ChannelId chanId,
                                                      uint64_t timestamp, const uint8_t* payload,
                                                      size_t payloadSize) {
+  sendChannelMessage(clientHandle, chanId, timestamp, payload, payloadSize, nullptr);
+}
+
+/// `sharedPayload` optionally holds a copy of the payload, which is queued behind a pending replay
+/// instead of copying the payload again.
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::sendChannelMessage(ConnHandle clientHandle,
+                                                            ChannelId chanId, uint64_t timestamp,
+                                                            const uint8_t* payload,
+                                                            size_t payloadSize,
+                                                            const SharedPayload& sharedPayload) {
   websocketpp::lib::error_code ec;
   const auto con = _server.get_con_from_hdl(clientHandle, ec);
   if (ec || !con) {
     return;
   }
 
-  const auto bufferSizeinBytes = con->get_buffered_amount();
-  if (bufferSizeinBytes + payloadSize >= _options.sendBufferLimitBytes) {
-    const auto logFn = [this, clientHandle]() {
-      sendStatusAndLogMsg(clientHandle, StatusLevel::Warning, "Send buffer limit reached");
-    };
-    FOXGLOVE_DEBOUNCE(logFn, 2500);
-    return;
-  }
+  // Thread CPU time rather than wall time, so that the thread being preempted is not counted.
+  const int64_t sendStartCpuNs = _options.egressCpuBudget > 0.0 ? threadCpuTimeNs() : 0;
 
+  const size_t messageSize = MESSAGE_DATA_HEADER_SIZE + payloadSize;
   SubscriptionId subId = std::numeric_limits<SubscriptionId>::max();
+  bool shed = false;
+  bool sendBufferFull = false;
+  bool quotaExceeded = false;
+  bool queued = false;
+  bool replayOverflow = false;
 
   {
     std::shared_lock<std::shared_mutex> lock(_clientsMutex);
-    const auto clientHandleAndInfoIt = _clients.find(clientHandle);
-    if (clientHandleAndInfoIt == _clients.end()) {
+    auto* client = findClient(con);
+    if (!client) {
       return;  // Client got removed in the meantime.
     }
 
-    const auto& client = clientHandleAndInfoIt->second;
-    const auto& subs = client.subscriptionsByChannel.find(chanId);
-    if (subs == client.subscriptionsByChannel.end()) {
+    const auto& subs = client->subscriptionsByChannel.find(chanId);
+    if (subs == client->subscriptionsByChannel.end()) {
       return;  // Client not subscribed to this channel.
     }
     subId = subs->second;
+
+    if (_shedLevel.load() > 0) {
+      const auto priorityIt = client->channelPriorities.find(chanId);
+      shed = priorityIt != client->channelPriorities.end() && isPriorityShed(priorityIt->second);
+    }
+
+    // While cached messages are replayed to the client, newer messages of the channel are queued
+    // behind them. The queue takes the place of the send buffer and is bounded like it.
+    std::unique_lock<std::mutex> replayLock;
+    PendingReplay* pendingReplay = nullptr;
+    if (_pendingReplayCount.load() > 0) {
+      replayLock = std::unique_lock<std::mutex>(client->replayMutex);
+      const auto replayIt = client->pendingReplays.find(chanId);
+      if (replayIt != client->pendingReplays.end()) {
+        pendingReplay = &replayIt->second;
+      }
+    }
+
+    sendBufferFull = !shed && !pendingReplay &&
+                     con->get_buffered_amount() + payloadSize >= _options.sendBufferLimitBytes;
+    quotaExceeded = !shed && !sendBufferFull && client->bandwidthQuota &&
+                    !client->bandwidthQuota->tryConsume(static_cast<double>(messageSize));
+    if (pendingReplay && !shed && !quotaExceeded) {
+      replayOverflow =
+        queueBehindPendingReplay(*pendingReplay, timestamp, payload, payloadSize, sharedPayload);
+      queued = true;
+    }
+  }
+
+  if (shed) {
+    sendClientWarning(con, clientHandle, ClientWarning::Overload,
+                      "Server overloaded, dropping messages of low priority channels");
+    return;
+  } else if (sendBufferFull || replayOverflow) {
+    sendClientWarning(con, clientHandle, ClientWarning::SendBufferLimit,
+                      "Send buffer limit reached");
+    return;
   }
 
-  std::array<uint8_t, 1 + 4 + 8> msgHeader;
+  if (quotaExceeded) {
+    // Drop the message. The next message on this channel supersedes it once the client's quota
+    // has been refilled, so slow clients effectively receive the latest value of each channel.
+    sendClientWarning(con, clientHandle, ClientWarning::BandwidthQuota,
+                      "Bandwidth quota exceeded, dropping messages");
+    return;
+  } else if (queued) {
+    return;
+  }
+
+  sendMessageFrame(con, subId, timestamp, payload, payloadSize);
+
+  if (_options.egressCpuBudget > 0.0) {
+    _sendPathNs += threadCpuTimeNs() - sendStartCpuNs;
+  }
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::sendMessageFrame(const ConnectionPtr& con,
+                                                          SubscriptionId subId, uint64_t timestamp,
+                                                          const uint8_t* payload,
+                                                          size_t payloadSize) {
+  std::array<uint8_t, MESSAGE_DATA_HEADER_SIZE> msgHeader;
   msgHeader[0] = uint8_t(BinaryOpcode::MESSAGE_DATA);
   foxglove_ws::WriteUint32LE(msgHeader.data() + 1, subId);
   foxglove_ws::WriteUint64LE(msgHeader.data() + 5, timestamp);
 
-  const size_t messageSize = msgHeader.size() + payloadSize;
-  auto message = con->get_message(OpCode::BINARY, messageSize);
-  message->set_compressed(_options.useCompression);
-
+  auto message = con->get_message(OpCode::BINARY, msgHeader.size() + payloadSize);
   message->set_payload(msgHeader.data(), msgHeader.size());
   message->append_payload(payload, payloadSize);
+  if (_options.useCompression) {
+    message->set_compressed(true);
+  } else {
+    prepareBinaryFrame(message);
+  }
   con->send(message);
 }
 
+/// Returns true if older messages had to be dropped to stay within the replay's size limit.
+template <typename ServerConfiguration>
+inline bool Server<ServerConfiguration>::queueBehindPendingReplay(
+  PendingReplay& replay, uint64_t timestamp, const uint8_t* payload, size_t payloadSize,
+  const SharedPayload& sharedPayload) {
+  replay.messages.push_back(
+    {timestamp, 0,
+     sharedPayload ? sharedPayload
+                   : std::make_shared<const std::vector<uint8_t>>(payload, payload + payloadSize)});
+  replay.bytes += payloadSize;
+
+  bool dropped = false;
+  while (replay.messages.size() > 1 && replay.bytes > replay.maxBytes) {
+    replay.bytes -= replay.messages.front().payload->size();
+    replay.messages.pop_front();
+    dropped = true;
+  }
+  return dropped;
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::replayCachedMessages(ConnHandle hdl) {
+  websocketpp::lib::error_code ec;
+  const auto con = _server.get_con_from_hdl(hdl, ec);
+  if (ec || !con) {
+    return;
+  }
+
+  bool replayPending = false;
+  {
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    auto* client = findClient(con);
+    if (!client) {
+      return;  // Client got removed in the meantime, along with its pending replays.
+    }
+    std::lock_guard<std::mutex> replayLock(client->replayMutex);
+    auto& pendingReplays = client->pendingReplays;
+    for (auto replayIt = pendingReplays.begin(); replayIt != pendingReplays.end();) {
+      const auto subIt = client->subscriptionsByChannel.find(replayIt->first);
+      const bool subscribed = subIt != client->subscriptionsByChannel.end();
+      auto& replay = replayIt->second;
+      auto& messages = replay.messages;
+      // Cached messages are exempt from the send buffer limit and load shedding, which would cut
+      // off the replay. Instead, they are only sent while the send buffer has room for them.
+      while (subscribed && !messages.empty() &&
+             con->get_buffered_amount() < _options.sendBufferLimitBytes) {
+        const auto& message = messages.front();
+        sendMessageFrame(con, subIt->second, message.timestamp, message.payload->data(),
+                         message.payload->size());
+        replay.bytes -= message.payload->size();
+        messages.pop_front();
+      }
+      if (!subscribed || messages.empty()) {
+        replayIt = pendingReplays.erase(replayIt);
+        --_pendingReplayCount;
+      } else {
+        ++replayIt;
+      }
+    }
+    client->replayScheduled = !pendingReplays.empty();
+    replayPending = client->replayScheduled;
+  }
+
+  if (replayPending) {
+    _server.set_timer(CACHE_REPLAY_RETRY_INTERVAL_MS,
+                      [this, hdl](const websocketpp::lib::error_code& timerEc) {
+                        if (!timerEc) {
+                          replayCachedMessages(hdl);
+                        }
+                      });
+  }
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::broadcastMessage(ChannelId chanId, uint64_t timestamp,
+                                                          const uint8_t* payload,
+                                                          size_t payloadSize) {
+  const auto cache = findChannelCache(chanId);
+  std::unique_lock<std::mutex> cacheLock;
+  SharedPayload sharedPayload;
+  if (cache) {
+    cacheLock = std::unique_lock<std::mutex>(cache->mutex);
+    if (!cache->removed) {
+      cacheMessage(*cache, timestamp, payload, payloadSize);
+      sharedPayload = cache->messages.back().payload;
+    }
+  }
+
+  std::vector<ConnHandle> subscribedClients;
+  {
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    for (const auto& client : _clients) {
+      if (client && client->subscriptionsByChannel.count(chanId) > 0) {
+        subscribedClients.push_back(client->handle);
+      }
+    }
+  }
+  for (const auto& clientHandle : subscribedClients) {
+    sendChannelMessage(clientHandle, chanId, timestamp, payload, payloadSize, sharedPayload);
+  }
+
+  if (cacheLock.owns_lock()) {
+    cacheLock.unlock();
+  }
+  const size_t budget = _options.lastMessageCacheBudgetBytes;
+  if (budget > 0 && _channelCachesBytes.load() > budget) {
+    enforceCacheBudget();
+    const auto logFn = [this]() {
+      _server.get_elog().write(WARNING,
+                               "Last message cache budget exceeded, evicting cached messages");
+    };
+    FOXGLOVE_DEBOUNCE(logFn, 2500);
+  }
+}
+
+template <typename ServerConfiguration>
+inline std::shared_ptr<typename Server<ServerConfiguration>::ChannelCache>
+Server<ServerConfiguration>::createChannelCache(const std::string& topic) const {
+  auto cache = std::make_shared<ChannelCache>();
+  cache->cacheLastMessage = isWhitelisted(topic, _options.lastMessageCacheTopicPatterns);
+  for (const auto& historyLimit : _options.channelHistoryLimits) {
+    if (std::regex_match(topic, historyLimit.topicPattern)) {
+      cache->historyDurationNs = static_cast<uint64_t>(historyLimit.durationSeconds * 1e9);
+      cache->historyMaxBytes = historyLimit.maxBytes;
+      break;
+    }
+  }
+  if (!cache->cacheLastMessage && cache->historyDurationNs == 0) {
+    return nullptr;
+  }
+  return cache;
+}
+
+template <typename ServerConfiguration>
+inline std::shared_ptr<typename Server<ServerConfiguration>::ChannelCache>
+Server<ServerConfiguration>::findChannelCache(ChannelId chanId) {
+  std::shared_lock<std::shared_mutex> lock(_channelCachesMutex);
+  const auto it = _channelCaches.find(chanId);
+  return it != _channelCaches.end() ? it->second : nullptr;
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::cacheMessage(ChannelCache& cache, uint64_t timestamp,
+                                                      const uint8_t* payload,
+                                                      size_t payloadSize) {
+  const auto previousOldestSequence = oldestCachedSequence(cache);
+  // Time went backwards, e.g. because a bag started looping. The history would be out of order.
+  if (!cache.messages.empty() && timestamp < cache.messages.back().timestamp) {
+    while (!cache.messages.empty()) {
+      evictCachedMessage(cache);
+    }
+  }
+
+  // The payload is shared with later subscribers instead of being copied for each of them.
+  cache.messages.push_back(
+    {timestamp, _nextCachedMessageSequence++,
+     std::make_shared<const std::vector<uint8_t>>(payload, payload + payloadSize)});
+  cache.bytes += payloadSize;
+  _channelCachesBytes += payloadSize;
+
+  if (cache.historyDurationNs == 0) {
+    while (cache.messages.size() > 1) {
+      evictCachedMessage(cache);
+    }
+  } else {
+    while (cache.messages.size() > 1 &&
+           (timestamp - cache.messages.front().timestamp > cache.historyDurationNs ||
+            (cache.historyMaxBytes > 0 && cache.bytes > cache.historyMaxBytes))) {
+      evictCachedMessage(cache);
+    }
+  }
+  updateOldestCachedMessage(cache, previousOldestSequence);
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::evictCachedMessage(ChannelCache& cache) {
+  const size_t payloadSize = cache.messages.front().payload->size();
+  cache.messages.pop_front();
+  cache.bytes -= payloadSize;
+  _channelCachesBytes -= payloadSize;
+}
+
+template <typename ServerConfiguration>
+inline std::optional<uint64_t> Server<ServerConfiguration>::oldestCachedSequence(
+  const ChannelCache& cache) {
+  if (cache.messages.empty()) {
+    return std::nullopt;
+  }
+  return cache.messages.front().sequence;
+}
+
+/// Keep _oldestCachedMessages up to date after the oldest message of `cache` may have changed.
+/// Must be called with the cache's lock held.
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::updateOldestCachedMessage(
+  const ChannelCache& cache, std::optional<uint64_t> previousOldestSequence) {
+  if (_options.lastMessageCacheBudgetBytes == 0) {
+    return;
+  }
+  const auto oldestSequence = oldestCachedSequence(cache);
+  if (oldestSequence == previousOldestSequence) {
+    return;
+  }
+  std::lock_guard<std::mutex> budgetLock(_cacheBudgetMutex);
+  if (previousOldestSequence) {
+    _oldestCachedMessages.erase({*previousOldestSequence, cache.channelId});
+  }
+  if (oldestSequence) {
+    _oldestCachedMessages.emplace(*oldestSequence, cache.channelId);
+  }
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::enforceCacheBudget() {
+  while (_channelCachesBytes.load() > _options.lastMessageCacheBudgetBytes) {
+    // Evict the message that was cached first, whichever channel it belongs to. The budget lock
+    // is released before taking the cache's lock, which is always taken first.
+    std::pair<uint64_t, ChannelId> oldest;
+    {
+      std::lock_guard<std::mutex> budgetLock(_cacheBudgetMutex);
+      if (_oldestCachedMessages.empty()) {
+        return;
+      }
+      oldest = *_oldestCachedMessages.begin();
+    }
+    const auto cache = findChannelCache(oldest.second);
+    if (!cache) {
+      std::lock_guard<std::mutex> budgetLock(_cacheBudgetMutex);
+      _oldestCachedMessages.erase(oldest);
+      continue;
+    }
+    // Otherwise the message was evicted in the meantime, and the oldest messages updated.
+    std::lock_guard<std::mutex> cacheLock(cache->mutex);
+    if (!cache->messages.empty() && cache->messages.front().sequence == oldest.first) {
+      evictCachedMessage(*cache);
+      updateOldestCachedMessage(*cache, oldest.first);
+    }
+  }
+}
+
 template <typename ServerConfiguration>
 inline void Server<ServerConfiguration>::broadcastTime(uint64_t timestamp) {
-  std::array<uint8_t, 1 + 8> message;
-  message[0] = uint8_t(BinaryOpcode::TIME_DATA);
-  foxglove_ws::WriteUint64LE(message.data() + 1, timestamp);
+  std::array<uint8_t, 1 + 8> frame;
+  frame[0] = uint8_t(BinaryOpcode::TIME_DATA);
+  foxglove_ws::WriteUint64LE(frame.data() + 1, timestamp);
 
+  // The same message is shared by all connections instead of allocating one per client.
+  MessagePtr message;
   std::shared_lock<std::shared_mutex> lock(_clientsMutex);
-  for (const auto& [hdl, clientInfo] : _clients) {
-    (void)clientInfo;
-    sendBinary(hdl, message.data(), message.size());
+  for (const auto& client : _clients) {
+    if (!client) {
+      continue;
+    }
+    websocketpp::lib::error_code ec;
+    const auto con = _server.get_con_from_hdl(client->handle, ec);
+    if (ec || !con) {
+      continue;
+    }
+    if (!message) {
+      message = con->get_message(OpCode::BINARY, frame.size());
+      message->set_payload(frame.data(), frame.size());
+      prepareBinaryFrame(message);
+    }
+    con->send(message);
   }
 }
 
 template <typename ServerConfiguration>
 inline void Server<ServerConfiguration>::sendServiceResponse(ConnHandle clientHandle,
                                                              const ServiceResponse& response) {
-  std::vector<uint8_t> payload(1 + response.size());
-  payload[0] = uint8_t(BinaryOpcode::SERVICE_CALL_RESPONSE);
-  response.write(payload.data() + 1);
-  sendBinary(clientHandle, payload.data(), payload.size());
+  sendServiceResponse(clientHandle, response.serviceId, response.callId, response.encoding,
+                      response.data.data(), response.data.size());
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::sendServiceResponse(ConnHandle clientHandle,
+                                                             ServiceId serviceId, uint32_t callId,
+                                                             const std::string& encoding,
+                                                             const uint8_t* data,
+                                                             size_t dataSize) {
+  websocketpp::lib::error_code ec;
+  const auto con = _server.get_con_from_hdl(clientHandle, ec);
+  if (ec || !con) {
+    return;
+  }
+
+  std::array<uint8_t, 1 + 4 + 4 + 4> header;
+  header[0] = uint8_t(BinaryOpcode::SERVICE_CALL_RESPONSE);
+  foxglove_ws::WriteUint32LE(header.data() + 1, serviceId);
+  foxglove_ws::WriteUint32LE(header.data() + 5, callId);
+  foxglove_ws::WriteUint32LE(header.data() + 9, static_cast<uint32_t>(encoding.size()));
+
+  // Large responses (e.g. maps) are copied once, directly into the frame.
+  auto message = con->get_message(OpCode::BINARY, header.size() + encoding.size() + dataSize);
+  message->set_payload(header.data(), header.size());
+  message->append_payload(encoding.data(), encoding.size());
+  message->append_payload(data, dataSize);
+  if (_options.useCompression) {
+    message->set_compressed(true);
+  } else {
+    prepareBinaryFrame(message);
+  }
+  if (const auto sendEc = con->send(message)) {
+    _server.get_elog().write(RECOVERABLE, "Failed to send service response to " +
+                                            remoteEndpointString(clientHandle) + ": " +
+                                            sendEc.message());
+  }
 }
 
 template <typename ServerConfiguration>
@@ -1118,9 +1951,9 @@ inline void Server<ServerConfiguration>::updateConnectionGraph(
   const auto payload = msg.dump();
 
   std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-  for (const auto& [hdl, clientInfo] : _clients) {
-    if (clientInfo.subscribedToConnectionGraph) {
-      _server.send(hdl, payload, OpCode::TEXT);
+  for (const auto& client : _clients) {
+    if (client && client->subscribedToConnectionGraph) {
+      _server.send(client->handle, payload, OpCode::TEXT);
     }
   }
 }
@@ -1134,11 +1967,40 @@ inline std::string Server<ServerConfiguration>::remoteEndpointString(ConnHandle
 
 template <typename ServerConfiguration>
 inline bool Server<ServerConfiguration>::isParameterSubscribed(const std::string& paramName) const {
-  return std::find_if(_clientParamSubscriptions.begin(), _clientParamSubscriptions.end(),
-                      [paramName](const auto& paramSubscriptions) {
-                        return paramSubscriptions.second.find(paramName) !=
-                               paramSubscriptions.second.end();
-                      }) != _clientParamSubscriptions.end();
+  return _paramSubscribers.find(paramName) != _paramSubscribers.end();
+}
+
+template <typename ServerConfiguration>
+inline typename Server<ServerConfiguration>::ClientInfo* Server<ServerConfiguration>::findClient(
+  const ConnectionPtr& con) {
+  const uint32_t slot = con->connectionSlot;
+  if (slot >= _clients.size() || !_clients[slot]) {
+    return nullptr;
+  }
+
+  // Guard against a slot that has been reused by a new connection while this one was closing.
+  auto* client = _clients[slot].get();
+  const bool sameConnection =
+    !client->handle.owner_before(con) && !con.owner_before(client->handle);
+  return sameConnection ? client : nullptr;
+}
+
+template <typename ServerConfiguration>
+inline typename Server<ServerConfiguration>::ClientInfo* Server<ServerConfiguration>::findClient(
+  ConnHandle hdl) {
+  websocketpp::lib::error_code ec;
+  const auto con = _server.get_con_from_hdl(hdl, ec);
+  return con ? findClient(con) : nullptr;
+}
+
+template <typename ServerConfiguration>
+inline typename Server<ServerConfiguration>::ClientInfo& Server<ServerConfiguration>::getClient(
+  ConnHandle hdl) {
+  auto* client = findClient(hdl);
+  if (!client) {
+    throw std::runtime_error("Client " + remoteEndpointString(hdl) + " not found");
+  }
+  return *client;
 }
 
 template <typename ServerConfiguration>
@@ -1146,7 +2008,7 @@ inline void Server<ServerConfiguration>::unsubscribeParamsWithoutSubscriptions(
   ConnHandle hdl, const std::unordered_set<std::string>& paramNames) {
   std::vector<std::string> paramsToUnsubscribe;
   {
-    std::lock_guard<std::mutex> lock(_clientParamSubscriptionsMutex);
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
     std::copy_if(paramNames.begin(), paramNames.end(), std::back_inserter(paramsToUnsubscribe),
                  [this](const std::string& paramName) {
                    return !isParameterSubscribed(paramName);
@@ -1204,12 +2066,218 @@ inline bool Server<ServerConfiguration>::hasHandler(uint32_t op) const {
   }
 }
 
+/// Clients whose group matches an entry of `clientBandwidthQuotas` share one token bucket with
+/// the other clients of their group, other clients get a bucket of their own.
+template <typename ServerConfiguration>
+inline std::shared_ptr<TokenBucket> Server<ServerConfiguration>::createBandwidthQuota(
+  const std::string& clientGroup) {
+  size_t bytesPerSecond = _options.clientBandwidthLimitBytesPerSec;
+  bool groupQuota = false;
+  for (const auto& quota : _options.clientBandwidthQuotas) {
+    if (std::regex_match(clientGroup, quota.clientGroupPattern)) {
+      bytesPerSecond = quota.bytesPerSecond;
+      groupQuota = true;
+      break;
+    }
+  }
+
+  if (bytesPerSecond == 0) {
+    return nullptr;
+  }
+
+  const size_t burstBytes =
+    _options.clientBandwidthBurstBytes > 0 ? _options.clientBandwidthBurstBytes : bytesPerSecond;
+  if (!groupQuota) {
+    return std::make_shared<TokenBucket>(static_cast<double>(bytesPerSecond),
+                                         static_cast<double>(burstBytes));
+  }
+
+  std::lock_guard<std::mutex> lock(_groupBandwidthQuotasMutex);
+  for (auto it = _groupBandwidthQuotas.begin(); it != _groupBandwidthQuotas.end();) {
+    it = it->second.expired() ? _groupBandwidthQuotas.erase(it) : std::next(it);
+  }
+  auto& weakQuota = _groupBandwidthQuotas[clientGroup];
+  auto quota = weakQuota.lock();
+  if (!quota) {
+    quota = std::make_shared<TokenBucket>(static_cast<double>(bytesPerSecond),
+                                          static_cast<double>(burstBytes));
+    weakQuota = quota;
+  }
+  return quota;
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::setClientPublishLimits(
+  ClientPublication& publication) const {
+  const auto& topic = publication.advertisement.topic;
+  std::optional<double> messagesPerSecond;
+  std::optional<size_t> bytesPerSecond;
+  for (const auto& limit : _options.clientPublishLimits) {
+    if (!std::regex_match(topic, limit.topicPattern)) {
+      continue;
+    }
+    // An explicit limit of 0 matches as well, so that it can exempt topics from later entries.
+    if (!messagesPerSecond && limit.messagesPerSecond) {
+      messagesPerSecond = limit.messagesPerSecond;
+    }
+    if (!bytesPerSecond && limit.bytesPerSecond) {
+      bytesPerSecond = limit.bytesPerSecond;
+    }
+  }
+
+  // Allow bursts of one second worth of messages.
+  if (messagesPerSecond.value_or(0.0) > 0.0) {
+    publication.messageRateLimit =
+      std::make_unique<TokenBucket>(*messagesPerSecond, std::max(1.0, *messagesPerSecond));
+  }
+  if (bytesPerSecond.value_or(0) > 0) {
+    publication.byteRateLimit = std::make_unique<TokenBucket>(
+      static_cast<double>(*bytesPerSecond), static_cast<double>(*bytesPerSecond));
+  }
+}
+
+template <typename ServerConfiguration>
+inline bool Server<ServerConfiguration>::isClientPublishLimitExceeded(
+  ClientPublication& publication, size_t payloadSize) const {
+  const auto now = TokenBucket::Clock::now();
+  if (publication.messageRateLimit && !publication.messageRateLimit->tryConsume(1.0, now)) {
+    return true;
+  }
+  if (publication.byteRateLimit &&
+      !publication.byteRateLimit->tryConsume(static_cast<double>(payloadSize), now)) {
+    // The message is dropped, so it must not count against the message rate either.
+    if (publication.messageRateLimit) {
+      publication.messageRateLimit->refund(1.0);
+    }
+    return true;
+  }
+  return false;
+}
+
+/// Returns true if a client message exceeds the publish limits of its channel, in which case it is
+/// dropped and the client is warned. Messages of unknown channels are left to handleBinaryMessage.
+template <typename ServerConfiguration>
+inline bool Server<ServerConfiguration>::dropClientMessageOverLimit(ConnHandle hdl,
+                                                                    const ConnectionPtr& con,
+                                                                    const std::string& payload) {
+  if (payload.size() < ClientMessage::MSG_PAYLOAD_OFFSET) {
+    return false;
+  }
+  const ClientChannelId channelId = *reinterpret_cast<const ClientChannelId*>(payload.data() + 1);
+  std::shared_ptr<ClientPublication> publication;
+  {
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    const auto* client = findClient(con);
+    if (!client) {
+      return false;
+    }
+    const auto channelIt = client->advertisedChannels.find(channelId);
+    if (channelIt == client->advertisedChannels.end()) {
+      return false;
+    }
+    publication = channelIt->second;
+  }
+
+  if (!isClientPublishLimitExceeded(*publication,
+                                    payload.size() - ClientMessage::MSG_PAYLOAD_OFFSET)) {
+    return false;
+  }
+  sendClientWarning(con, hdl, ClientWarning::PublishLimit,
+                    "Publish rate limit of channel " + std::to_string(channelId) +
+                      " exceeded, dropping messages");
+  return true;
+}
+
+template <typename ServerConfiguration>
+inline bool Server<ServerConfiguration>::isOverloadSheddingEnabled() const {
+  return _options.globalSendBufferLimitBytes > 0 || _options.egressCpuBudget > 0.0;
+}
+
+template <typename ServerConfiguration>
+inline int Server<ServerConfiguration>::channelPriority(const std::string& topic) const {
+  for (const auto& channelPriority : _options.channelPriorities) {
+    if (std::regex_match(topic, channelPriority.topicPattern)) {
+      return channelPriority.priority;
+    }
+  }
+  return DEFAULT_CHANNEL_PRIORITY;
+}
+
+/// Evaluate the load periodically on the server thread, independently of messages being sent, so
+/// that shed channels are restored even when no message of a higher priority is sent.
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::scheduleLoadCheck() {
+  _loadCheckTimer =
+    _server.set_timer(LOAD_CHECK_INTERVAL_MS, [this](const websocketpp::lib::error_code& ec) {
+      if (ec) {
+        return;  // Cancelled by stop()
+      }
+      updateLoadShedding();
+      scheduleLoadCheck();
+    });
+}
+
+template <typename ServerConfiguration>
+inline void Server<ServerConfiguration>::updateLoadShedding() {
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  const int64_t lastCheck = _lastLoadCheckNs.exchange(now);
+
+  double load = 0.0;
+  if (_options.globalSendBufferLimitBytes > 0) {
+    size_t bufferedBytes = 0;
+    std::shared_lock<std::shared_mutex> lock(_clientsMutex);
+    for (const auto& client : _clients) {
+      if (!client) {
+        continue;
+      }
+      websocketpp::lib::error_code ec;
+      if (const auto con = _server.get_con_from_hdl(client->handle, ec)) {
+        bufferedBytes += con->get_buffered_amount();
+      }
+    }
+    load = static_cast<double>(bufferedBytes) /
+           static_cast<double>(_options.globalSendBufferLimitBytes);
+  }
+  if (_options.egressCpuBudget > 0.0) {
+    const double cpuUsage =
+      static_cast<double>(_sendPathNs.exchange(0)) / static_cast<double>(now - lastCheck);
+    load = std::max(load, cpuUsage / _options.egressCpuBudget);
+  }
+
+  // Shed (or restore) one priority class per interval so that the server degrades gradually. The
+  // highest priority class is never shed.
+  const size_t shedLevel = _shedLevel.load();
+  size_t newShedLevel = shedLevel;
+  if (load > 1.0 && shedLevel + 1 < _priorityLevels.size()) {
+    newShedLevel = shedLevel + 1;
+  } else if (load < LOAD_RECOVERY_THRESHOLD && shedLevel > 0) {
+    newShedLevel = shedLevel - 1;
+  }
+
+  if (newShedLevel != shedLevel) {
+    _shedLevel = newShedLevel;
+    _server.get_elog().write(WARNING, newShedLevel == 0
+                                        ? "Server load recovered, no longer dropping messages"
+                                        : "Server overloaded, dropping messages of channels with "
+                                          "priority lower than " +
+                                            std::to_string(_priorityLevels[newShedLevel]));
+  }
+}
+
+template <typename ServerConfiguration>
+inline bool Server<ServerConfiguration>::isPriorityShed(int priority) const {
+  const size_t shedLevel = _shedLevel.load();
+  return shedLevel > 0 && priority < _priorityLevels[shedLevel];
+}
+
 template <typename ServerConfiguration>
 void Server<ServerConfiguration>::handleSubscribe(const nlohmann::json& payload, ConnHandle hdl) {
   std::unordered_map<ChannelId, SubscriptionId> clientSubscriptionsByChannel;
   {
     std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    clientSubscriptionsByChannel = _clients.at(hdl).subscriptionsByChannel;
+    clientSubscriptionsByChannel = getClient(hdl).subscriptionsByChannel;
   }
 
   const auto findSubscriptionBySubId =
@@ -1239,9 +2307,55 @@ void Server<ServerConfiguration>::handleSubscribe(const nlohmann::json& payload,
       continue;
     }
 
+    const bool replayHistory = sub.value("replayHistory", false);
+    const auto cache = findChannelCache(channelId);
+    int priority = DEFAULT_CHANNEL_PRIORITY;
     {
+      std::shared_lock<std::shared_mutex> channelsLock(_channelsMutex);
+      const auto priorityIt = _channelPriorities.find(channelId);
+      if (priorityIt != _channelPriorities.end()) {
+        priority = priorityIt->second;
+      }
+    }
+
+    {
+      // Holding the channel cache's lock ensures that no newer message is broadcast before the
+      // cached ones have been queued for the new subscriber. They are sent on the server thread by
+      // replayCachedMessages(), newer messages are queued behind them until then.
+      std::unique_lock<std::mutex> cacheLock;
+      PendingReplay replay;
+      if (cache) {
+        cacheLock = std::unique_lock<std::mutex>(cache->mutex);
+        if (!cache->messages.empty() && replayHistory && cache->historyDurationNs > 0) {
+          // Messages keep their original timestamps, so that clients can place them in time.
+          replay.messages = cache->messages;
+          replay.bytes = cache->bytes;
+        } else if (!cache->messages.empty() && cache->cacheLastMessage) {
+          replay.messages.push_back(cache->messages.back());
+          replay.bytes = cache->messages.back().payload->size();
+        }
+        // Newer messages queued behind the replay may take up as much as the send buffer.
+        replay.maxBytes = std::max(replay.bytes, _options.sendBufferLimitBytes);
+      }
+
       std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-      _clients.at(hdl).subscriptionsByChannel.emplace(channelId, subId);
+      auto& client = getClient(hdl);
+      client.subscriptionsByChannel.emplace(channelId, subId);
+      client.channelPriorities[channelId] = priority;
+      if (!replay.messages.empty()) {
+        std::lock_guard<std::mutex> replayLock(client.replayMutex);
+        if (client.pendingReplays.insert_or_assign(channelId, std::move(replay)).second) {
+          ++_pendingReplayCount;
+        }
+        if (!client.replayScheduled) {
+          client.replayScheduled = true;
+          _server.set_timer(0, [this, hdl](const websocketpp::lib::error_code& ec) {
+            if (!ec) {
+              replayCachedMessages(hdl);
+            }
+          });
+        }
+      }
     }
 
     // In case the subscribeHandler triggers an immediate sendMessage, this must be done *after*
@@ -1255,7 +2369,7 @@ void Server<ServerConfiguration>::handleUnsubscribe(const nlohmann::json& payloa
   std::unordered_map<ChannelId, SubscriptionId> clientSubscriptionsByChannel;
   {
     std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    clientSubscriptionsByChannel = _clients.at(hdl).subscriptionsByChannel;
+    clientSubscriptionsByChannel = getClient(hdl).subscriptionsByChannel;
   }
 
   const auto findSubscriptionBySubId =
@@ -1280,21 +2394,27 @@ void Server<ServerConfiguration>::handleUnsubscribe(const nlohmann::json& payloa
     ChannelId chanId = sub->first;
     _handlers.unsubscribeHandler(chanId, hdl);
     std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    _clients.at(hdl).subscriptionsByChannel.erase(chanId);
+    auto& client = getClient(hdl);
+    client.subscriptionsByChannel.erase(chanId);
+    client.channelPriorities.erase(chanId);
+    std::lock_guard<std::mutex> replayLock(client.replayMutex);
+    _pendingReplayCount -= client.pendingReplays.erase(chanId);
   }
 }
 
 template <typename ServerConfiguration>
 void Server<ServerConfiguration>::handleAdvertise(const nlohmann::json& payload, ConnHandle hdl) {
-  std::unique_lock<std::shared_mutex> clientChannelsLock(_clientChannelsMutex);
-  auto [clientPublicationsIt, isFirstPublication] =
-    _clientChannels.emplace(hdl, std::unordered_map<ClientChannelId, ClientAdvertisement>());
-
-  auto& clientPublications = clientPublicationsIt->second;
+  // Client advertisements are only modified on the handler thread, so checking under a shared lock
+  // and inserting under a unique lock afterwards is free of races.
+  const auto isAdvertised = [this, hdl](ClientChannelId channelId) {
+    std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
+    const auto& advertisedChannels = getClient(hdl).advertisedChannels;
+    return advertisedChannels.find(channelId) != advertisedChannels.end();
+  };
 
   for (const auto& chan : payload.at("channels")) {
     ClientChannelId channelId = chan.at("id");
-    if (!isFirstPublication && clientPublications.find(channelId) != clientPublications.end()) {
+    if (isAdvertised(channelId)) {
       sendStatusAndLogMsg(hdl, StatusLevel::Error,
                           "Channel " + std::to_string(channelId) + " was already advertised");
       continue;
@@ -1307,45 +2427,44 @@ void Server<ServerConfiguration>::handleAdvertise(const nlohmann::json& payload,
                             topic + "' not whitelisted");
       continue;
     }
-    ClientAdvertisement advertisement{};
+    auto publication = std::make_shared<ClientPublication>();
+    auto& advertisement = publication->advertisement;
     advertisement.channelId = channelId;
     advertisement.topic = topic;
     advertisement.encoding = chan.at("encoding").get<std::string>();
     advertisement.schemaName = chan.at("schemaName").get<std::string>();
+    setClientPublishLimits(*publication);
 
     _handlers.clientAdvertiseHandler(advertisement, hdl);
     std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    _clients.at(hdl).advertisedChannels.emplace(channelId);
-    clientPublications.emplace(channelId, advertisement);
+    getClient(hdl).advertisedChannels.emplace(channelId, std::move(publication));
   }
 }
 
 template <typename ServerConfiguration>
 void Server<ServerConfiguration>::handleUnadvertise(const nlohmann::json& payload, ConnHandle hdl) {
-  std::unique_lock<std::shared_mutex> clientChannelsLock(_clientChannelsMutex);
-  auto clientPublicationsIt = _clientChannels.find(hdl);
-  if (clientPublicationsIt == _clientChannels.end()) {
+  std::unordered_set<ClientChannelId> advertisedChannelIds;
+  {
+    std::shared_lock<std::shared_mutex> clientsLock(_clientsMutex);
+    for (const auto& [channelId, advertisement] : getClient(hdl).advertisedChannels) {
+      (void)advertisement;
+      advertisedChannelIds.insert(channelId);
+    }
+  }
+  if (advertisedChannelIds.empty()) {
     sendStatusAndLogMsg(hdl, StatusLevel::Error, "Client has no advertised channels");
     return;
   }
 
-  auto& clientPublications = clientPublicationsIt->second;
-
   for (const auto& chanIdJson : payload.at("channelIds")) {
     ClientChannelId channelId = chanIdJson.get<ClientChannelId>();
-    const auto& channelIt = clientPublications.find(channelId);
-    if (channelIt == clientPublications.end()) {
+    if (advertisedChannelIds.erase(channelId) == 0) {
       continue;
     }
 
     _handlers.clientUnadvertiseHandler(channelId, hdl);
     std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    auto& clientInfo = _clients.at(hdl);
-    clientPublications.erase(channelIt);
-    const auto advertisedChannelIt = clientInfo.advertisedChannels.find(channelId);
-    if (advertisedChannelIt != clientInfo.advertisedChannels.end()) {
-      clientInfo.advertisedChannels.erase(advertisedChannelIt);
-    }
+    getClient(hdl).advertisedChannels.erase(channelId);
   }
 }
 
@@ -1376,15 +2495,18 @@ void Server<ServerConfiguration>::handleSubscribeParameterUpdates(const nlohmann
   std::vector<std::string> paramsToSubscribe;
   {
     // Only consider parameters that are not subscribed yet (by this or by other clients)
-    std::lock_guard<std::mutex> lock(_clientParamSubscriptionsMutex);
+    std::unique_lock<std::shared_mutex> lock(_clientsMutex);
     std::copy_if(paramNames.begin(), paramNames.end(), std::back_inserter(paramsToSubscribe),
                  [this](const std::string& paramName) {
                    return !isParameterSubscribed(paramName);
                  });
 
     // Update the client's parameter subscriptions.
-    auto& clientSubscribedParams = _clientParamSubscriptions[hdl];
-    clientSubscribedParams.insert(paramNames.begin(), paramNames.end());
+    auto& client = getClient(hdl);
+    client.subscribedParameters.insert(paramNames.begin(), paramNames.end());
+    for (const auto& paramName : paramNames) {
+      _paramSubscribers[paramName].insert(&client);
+    }
   }
 
   if (!paramsToSubscribe.empty()) {
@@ -1398,10 +2520,12 @@ void Server<ServerConfiguration>::handleUnsubscribeParameterUpdates(const nlohma
                                                                     ConnHandle hdl) {
   const auto paramNames = payload.at("parameterNames").get<std::unordered_set<std::string>>();
   {
-    std::lock_guard<std::mutex> lock(_clientParamSubscriptionsMutex);
-    auto& clientSubscribedParams = _clientParamSubscriptions[hdl];
+    std::unique_lock<std::shared_mutex> lock(_clientsMutex);
+    auto& client = getClient(hdl);
     for (const auto& paramName : paramNames) {
-      clientSubscribedParams.erase(paramName);
+      if (client.subscribedParameters.erase(paramName) > 0) {
+        removeParamSubscriber(paramName, &client);
+      }
     }
   }
 
@@ -1422,7 +2546,7 @@ void Server<ServerConfiguration>::handleSubscribeConnectionGraph(ConnHandle hdl)
     _server.get_alog().write(APP, "Subscribing to connection graph updates.");
     _handlers.subscribeConnectionGraphHandler(true);
     std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    _clients.at(hdl).subscribedToConnectionGraph = true;
+    getClient(hdl).subscribedToConnectionGraph = true;
   }
 
   json::array_t publishedTopicsJson, subscribedTopicsJson, advertisedServicesJson;
@@ -1456,7 +2580,7 @@ void Server<ServerConfiguration>::handleUnsubscribeConnectionGraph(ConnHandle hd
   bool clientWasSubscribed = false;
   {
     std::unique_lock<std::shared_mutex> clientsLock(_clientsMutex);
-    auto& clientInfo = _clients.at(hdl);
+    auto& clientInfo = getClient(hdl);
     if (clientInfo.subscribedToConnectionGraph) {
       clientWasSubscribed = true;
       clientInfo.subscribedToConnectionGraph = false;
@@ -3,6 +3,7 @@
 #include <websocketpp/config/asio.hpp>
 #include <websocketpp/extensions/permessage_deflate/enabled.hpp>
 
+#include "./websocket_connection.hpp"
 #include "./websocket_logging.hpp"
 
 namespace foxglove_ws {
@@ -25,6 +26,8 @@ struct WebSocketTls : public websocketpp::config::core {
 
   typedef base::rng_type rng_type;
 
+  typedef ConnectionState connection_base;
+
   struct transport_config : public base::transport_config {
     typedef type::concurrency_type concurrency_type;
     typedef CallbackLogger alog_type;
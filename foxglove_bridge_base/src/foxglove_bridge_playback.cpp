@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <websocketpp/common/connection_hdl.hpp>
+
+#include <foxglove_bridge/foxglove_bridge.hpp>
+#include <foxglove_bridge/mcap_player.hpp>
+#include <foxglove_bridge/mcap_reader.hpp>
+#include <foxglove_bridge/parameter.hpp>
+#include <foxglove_bridge/server_factory.hpp>
+
+namespace {
+
+constexpr char PARAM_PLAYBACK_OFFSET[] = "playback_offset";
+
+constexpr char USAGE[] =
+  "Usage: foxglove_bridge_playback [options] <file.mcap>\n"
+  "\n"
+  "Serves the messages of an MCAP file over the Foxglove WebSocket protocol.\n"
+  "\n"
+  "Options:\n"
+  "  --address <address>  Host address to listen on (default: 0.0.0.0)\n"
+  "  --port <port>        Port to listen on, 0 for any free port (default: 8765)\n"
+  "  --rate <rate>        Playback speed relative to real time (default: 1.0)\n"
+  "  --start <seconds>    Offset from the start of the file to start playing back at\n"
+  "  --loop               Restart from the beginning once the end of the file is reached\n"
+  "\n"
+  "Clients seek by setting the 'playback_offset' parameter to an offset in seconds from the start\n"
+  "of the file.\n";
+
+void logHandler(foxglove_ws::WebSocketLogLevel level, char const* msg) {
+  switch (level) {
+    case foxglove_ws::WebSocketLogLevel::Debug:
+      break;
+    case foxglove_ws::WebSocketLogLevel::Info:
+      std::cout << "[INFO] " << msg << std::endl;
+      break;
+    case foxglove_ws::WebSocketLogLevel::Warn:
+      std::cerr << "[WARN] " << msg << std::endl;
+      break;
+    case foxglove_ws::WebSocketLogLevel::Error:
+    case foxglove_ws::WebSocketLogLevel::Critical:
+      std::cerr << "[ERROR] " << msg << std::endl;
+      break;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string address = "0.0.0.0";
+  uint16_t port = 8765;
+  double rate = 1.0;
+  double startOffset = 0.0;
+  bool loop = false;
+  std::string path;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--address" && hasValue) {
+        address = argv[++i];
+      } else if (arg == "--port" && hasValue) {
+        port = static_cast<uint16_t>(std::stoul(argv[++i]));
+      } else if (arg == "--rate" && hasValue) {
+        rate = std::stod(argv[++i]);
+      } else if (arg == "--start" && hasValue) {
+        startOffset = std::stod(argv[++i]);
+      } else if (arg == "--loop") {
+        loop = true;
+      } else if (arg.rfind("--", 0) != 0 && path.empty()) {
+        path = arg;
+      } else {
+        throw std::invalid_argument(arg);
+      }
+    }
+  } catch (const std::exception& ex) {
+    std::cerr << "Invalid argument: " << ex.what() << "\n\n" << USAGE;
+    return 1;
+  }
+  if (path.empty() || rate <= 0.0 || startOffset < 0.0) {
+    std::cerr << USAGE;
+    return 1;
+  }
+
+  // Termination signals are received by sigwait() below instead of interrupting any thread.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  try {
+    foxglove_ws::McapReader reader;
+    reader.open(path);
+
+    foxglove_ws::ServerOptions serverOptions;
+    serverOptions.capabilities = {foxglove_ws::CAPABILITY_TIME, foxglove_ws::CAPABILITY_PARAMETERS};
+    serverOptions.sessionId = std::to_string(std::time(nullptr));
+    auto server = foxglove_ws::ServerFactory::createServer<websocketpp::connection_hdl>(
+      "foxglove_bridge_playback", logHandler, serverOptions);
+    // Created before the server starts, so that the handlers below never see it half constructed.
+    // It is destroyed after the server stopped calling them.
+    foxglove_ws::McapPlayer<websocketpp::connection_hdl> player(*server, reader, logHandler);
+
+    // Only the server thread accesses the offset once the server is started.
+    double playbackOffset = startOffset;
+    const auto playbackOffsetParameter = [&playbackOffset] {
+      return foxglove_ws::Parameter(PARAM_PLAYBACK_OFFSET, playbackOffset);
+    };
+
+    foxglove_ws::ServerHandlers<websocketpp::connection_hdl> handlers;
+    handlers.subscribeHandler = [](foxglove_ws::ChannelId, websocketpp::connection_hdl) {};
+    handlers.unsubscribeHandler = [](foxglove_ws::ChannelId, websocketpp::connection_hdl) {};
+    handlers.parameterRequestHandler = [&](const std::vector<std::string>& names,
+                                           const std::optional<std::string>& requestId,
+                                           websocketpp::connection_hdl hdl) {
+      if (names.empty() ||
+          std::find(names.begin(), names.end(), PARAM_PLAYBACK_OFFSET) != names.end()) {
+        server->publishParameterValues(hdl, {playbackOffsetParameter()}, requestId);
+      } else {
+        server->publishParameterValues(hdl, {}, requestId);
+      }
+    };
+    handlers.parameterChangeHandler = [&](const std::vector<foxglove_ws::Parameter>& parameters,
+                                          const std::optional<std::string>& requestId,
+                                          websocketpp::connection_hdl hdl) {
+      for (const auto& parameter : parameters) {
+        if (parameter.getName() != PARAM_PLAYBACK_OFFSET) {
+          continue;
+        }
+        double offset = -1.0;
+        if (parameter.getType() == foxglove_ws::ParameterType::PARAMETER_DOUBLE) {
+          offset = parameter.getValue().getValue<double>();
+        } else if (parameter.getType() == foxglove_ws::ParameterType::PARAMETER_INTEGER) {
+          offset = static_cast<double>(parameter.getValue().getValue<int64_t>());
+        }
+        if (offset < 0.0) {
+          logHandler(foxglove_ws::WebSocketLogLevel::Warn,
+                     "Ignoring invalid playback_offset, expected a non-negative number");
+          continue;
+        }
+        playbackOffset = offset;
+        player.seek(reader.startTime() + static_cast<uint64_t>(offset * 1e9));
+      }
+      if (requestId) {
+        server->publishParameterValues(hdl, {playbackOffsetParameter()}, requestId);
+      }
+    };
+    server->setHandlers(std::move(handlers));
+    server->start(address, port);
+
+    logHandler(foxglove_ws::WebSocketLogLevel::Info,
+               ("Playing back " + path + " (" + std::to_string(reader.channels().size()) +
+                " channels, foxglove_bridge " + foxglove::FOXGLOVE_BRIDGE_VERSION + ")")
+                 .c_str());
+    player.start(rate, loop, reader.startTime() + static_cast<uint64_t>(startOffset * 1e9));
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    player.stop();
+    server->stop();
+  } catch (const std::exception& ex) {
+    logHandler(foxglove_ws::WebSocketLogLevel::Error, ex.what());
+    return 1;
+  }
+  return 0;
+}
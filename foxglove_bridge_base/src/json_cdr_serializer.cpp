@@ -0,0 +1,997 @@
+#include <foxglove_bridge/json_cdr_serializer.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <foxglove_bridge/base64.hpp>
+
+namespace foxglove_ws {
+
+namespace {
+
+constexpr size_t ENCAPSULATION_HEADER_SIZE = 4;
+constexpr char DEFINITION_DELIMITER_PREFIX[] = "MSG: ";
+constexpr char EMPTY_MESSAGE_FIELD_NAME[] = "structure_needs_at_least_one_member";
+
+bool isLittleEndian() {
+  const uint16_t value = 1;
+  uint8_t firstByte;
+  std::memcpy(&firstByte, &value, 1);
+  return firstByte == 1;
+}
+
+std::string trim(const std::string& str) {
+  const auto begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const auto end = str.find_last_not_of(" \t\r");
+  return str.substr(begin, end - begin + 1);
+}
+
+/// Strip a trailing comment, ignoring '#' characters in quoted default values.
+std::string stripComment(const std::string& line) {
+  char quote = '\0';
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quote != '\0') {
+      if (c == '\\') {
+        ++i;
+      } else if (c == quote) {
+        quote = '\0';
+      }
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '#') {
+      return line.substr(0, i);
+    }
+  }
+  return line;
+}
+
+/// Encode a string as JSON string literal.
+std::string toJsonString(const std::string& str) {
+  std::string json = "\"";
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[7];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+      json += escaped;
+    } else {
+      json += c;
+    }
+  }
+  return json + "\"";
+}
+
+/// Convert a scalar default value of a `.msg` field to JSON. Strings may be single or double
+/// quoted, booleans may be capitalized. Numbers are taken as is and validated by the caller.
+std::string scalarDefaultToJson(const std::string& value, bool isString) {
+  if (isString) {
+    if (value.size() < 2 || (value.front() != '"' && value.front() != '\'') ||
+        value.back() != value.front()) {
+      return toJsonString(value);
+    }
+    std::string unquoted;
+    for (size_t i = 1; i + 1 < value.size(); ++i) {
+      if (value[i] == '\\' && i + 2 < value.size()) {
+        ++i;
+      }
+      unquoted += value[i];
+    }
+    return toJsonString(unquoted);
+  }
+
+  std::string lower = value;
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return lower == "true" || lower == "false" ? lower : value;
+}
+
+/// Convert the default value of a `.msg` field, e.g. `42`, `"a=b"` or `[1, 2]`, to JSON.
+std::string defaultValueToJson(const std::string& value, bool isArray, bool isString) {
+  if (!isArray) {
+    return scalarDefaultToJson(value, isString);
+  } else if (value.size() < 2 || value.front() != '[' || value.back() != ']') {
+    throw std::runtime_error("Expected an array but got " + value);
+  }
+
+  // Split the elements at commas outside of quoted strings.
+  std::string json = "[";
+  const std::string elements = value.substr(1, value.size() - 2);
+  size_t elementStart = 0;
+  char quote = '\0';
+  for (size_t i = 0; i <= elements.size(); ++i) {
+    const char c = i < elements.size() ? elements[i] : ',';
+    if (quote != '\0') {
+      if (c == '\\') {
+        ++i;
+      } else if (c == quote) {
+        quote = '\0';
+      }
+      continue;
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+      continue;
+    } else if (c != ',') {
+      continue;
+    }
+
+    const std::string element = trim(elements.substr(elementStart, i - elementStart));
+    elementStart = i + 1;
+    if (element.empty() && json.size() == 1 && i == elements.size()) {
+      break;  // Empty array
+    }
+    json += (json.size() > 1 ? "," : "") + scalarDefaultToJson(element, isString);
+  }
+  if (quote != '\0') {
+    throw std::runtime_error("Unterminated string in " + value);
+  }
+  return json + "]";
+}
+
+/// Normalize type names to "<package>/<type>", e.g. "geometry_msgs/msg/Twist" becomes
+/// "geometry_msgs/Twist".
+std::string normalizeTypeName(const std::string& typeName) {
+  const auto first = typeName.find('/');
+  const auto last = typeName.rfind('/');
+  if (first == std::string::npos || first == last) {
+    return typeName;
+  }
+  return typeName.substr(0, first) + typeName.substr(last);
+}
+
+uint32_t parseLength(const std::string& str, const std::string& typeName) {
+  uint32_t value = 0;
+  const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+  if (ec != std::errc() || ptr != str.data() + str.size()) {
+    throw std::runtime_error("Invalid array or string bound in type '" + typeName + "'");
+  }
+  return value;
+}
+
+double parseDouble(std::string_view token) {
+#if defined(__cpp_lib_to_chars)
+  double value = 0.0;
+  const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+  if (ec != std::errc() || ptr != token.data() + token.size()) {
+    throw std::runtime_error("Invalid number '" + std::string(token) + "'");
+  }
+  return value;
+#else
+  // strtod requires a null-terminated string.
+  char buffer[64];
+  if (token.size() >= sizeof(buffer)) {
+    throw std::runtime_error("Invalid number '" + std::string(token) + "'");
+  }
+  std::memcpy(buffer, token.data(), token.size());
+  buffer[token.size()] = '\0';
+  char* end = nullptr;
+  const double value = std::strtod(buffer, &end);
+  if (end != buffer + token.size()) {
+    throw std::runtime_error("Invalid number '" + std::string(token) + "'");
+  }
+  return value;
+#endif
+}
+
+template <typename T>
+T parseInteger(std::string_view token) {
+  T value{};
+  const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+  if (ec == std::errc() && ptr == token.data() + token.size()) {
+    return value;
+  } else if (ec == std::errc::result_out_of_range) {
+    throw std::runtime_error("Value " + std::string(token) + " out of range");
+  }
+
+  // Fall back to floating point notation, e.g. "1e3" or "2.0"
+  const double doubleValue = parseDouble(token);
+  double integralPart = 0.0;
+  if (std::abs(std::modf(doubleValue, &integralPart)) > 0.0) {
+    throw std::runtime_error("Expected an integer but got " + std::string(token));
+  } else if (doubleValue < static_cast<double>(std::numeric_limits<T>::min()) ||
+             doubleValue > static_cast<double>(std::numeric_limits<T>::max())) {
+    throw std::runtime_error("Value " + std::string(token) + " out of range");
+  }
+  return static_cast<T>(doubleValue);
+}
+
+}  // namespace
+
+/// Writes CDR data with the alignment relative to the end of the encapsulation header. The output
+/// buffer only grows (geometrically) and is told the written size by finish().
+class JsonCdrSerializer::Writer {
+public:
+  explicit Writer(OutputBuffer& out)
+      : _out(out)
+      , _data(out.data())
+      , _capacity(out.capacity()) {
+    const uint8_t header[ENCAPSULATION_HEADER_SIZE] = {0x00, isLittleEndian() ? uint8_t{0x01}
+                                                                              : uint8_t{0x00},
+                                                       0x00, 0x00};
+    append(header, sizeof(header));
+  }
+
+  void align(size_t alignment) {
+    const size_t offset = _size - ENCAPSULATION_HEADER_SIZE;
+    const size_t padding = (alignment - offset % alignment) % alignment;
+    if (padding > 0) {
+      appendZeros(padding);
+    }
+  }
+
+  template <typename T>
+  void write(T value) {
+    align(sizeof(T));
+    append(&value, sizeof(T));
+  }
+
+  void append(const void* data, size_t size) {
+    reserve(size);
+    std::memcpy(_data + _size, data, size);
+    _size += size;
+  }
+
+  void appendZeros(size_t size) {
+    reserve(size);
+    std::memset(_data + _size, 0, size);
+    _size += size;
+  }
+
+  /// Write a placeholder for a uint32 value that is only known later, see patchUint32.
+  size_t reserveUint32() {
+    align(sizeof(uint32_t));
+    const size_t offset = _size;
+    appendZeros(sizeof(uint32_t));
+    return offset;
+  }
+
+  void patchUint32(size_t offset, uint32_t value) {
+    std::memcpy(_data + offset, &value, sizeof(value));
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  void finish() {
+    _out.finish(_size);
+  }
+
+private:
+  void reserve(size_t size) {
+    if (_size + size > _capacity) {
+      _out.reserve(std::max({_size + size, 2 * _capacity, size_t{256}}));
+      _data = _out.data();
+      _capacity = _out.capacity();
+    }
+  }
+
+  OutputBuffer& _out;
+  uint8_t* _data;
+  size_t _capacity;
+  size_t _size = 0;
+};
+
+namespace {
+
+/// Output buffer writing into a vector, which is used up to its capacity.
+class VectorOutputBuffer : public JsonCdrSerializer::OutputBuffer {
+public:
+  explicit VectorOutputBuffer(std::vector<uint8_t>& out)
+      : _out(out) {
+    _out.resize(_out.capacity());
+  }
+
+  uint8_t* data() override {
+    return _out.data();
+  }
+
+  size_t capacity() const override {
+    return _out.size();
+  }
+
+  void reserve(size_t capacity) override {
+    _out.resize(capacity);
+  }
+
+  void finish(size_t size) override {
+    _out.resize(size);
+  }
+
+private:
+  std::vector<uint8_t>& _out;
+};
+
+}  // namespace
+
+/// Minimal in-place JSON tokenizer.
+class JsonCdrSerializer::Reader {
+public:
+  explicit Reader(std::string_view json)
+      : _json(json) {}
+
+  size_t position() const {
+    return _pos;
+  }
+
+  void seek(size_t position) {
+    _pos = position;
+  }
+
+  char peek() {
+    skipWhitespace();
+    if (_pos >= _json.size()) {
+      fail("Unexpected end of JSON");
+    }
+    return _json[_pos];
+  }
+
+  bool consume(char c) {
+    if (peek() == c) {
+      ++_pos;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!consume(c)) {
+      fail(std::string("Expected '") + c + "'");
+    }
+  }
+
+  bool consumeLiteral(std::string_view literal) {
+    if (peek() == literal.front() && _json.substr(_pos, literal.size()) == literal) {
+      _pos += literal.size();
+      return true;
+    }
+    return false;
+  }
+
+  std::string_view readNumber() {
+    peek();
+    const size_t start = _pos;
+    while (_pos < _json.size() && isNumberChar(_json[_pos])) {
+      ++_pos;
+    }
+    if (start == _pos) {
+      fail("Expected a number");
+    }
+    return _json.substr(start, _pos - start);
+  }
+
+  /// Read a string. Returns a view into the JSON text if the string has no escape sequences,
+  /// otherwise the string is decoded into `scratch`.
+  std::string_view readString(std::string& scratch) {
+    expect('"');
+    const size_t start = _pos;
+    const size_t end = _json.find_first_of("\"\\", start);
+    if (end != std::string_view::npos && _json[end] == '"') {
+      _pos = end + 1;
+      return _json.substr(start, end - start);
+    }
+
+    _pos = start - 1;
+    scratch.clear();
+    decodeString([&scratch](const char* data, size_t size) {
+      scratch.append(data, size);
+    });
+    return scratch;
+  }
+
+  /// Decode a string, calling `append(const char* data, size_t size)` for each decoded chunk.
+  template <typename AppendFn>
+  void decodeString(AppendFn&& append) {
+    expect('"');
+    size_t chunkStart = _pos;
+    while (true) {
+      if (_pos >= _json.size()) {
+        fail("Unterminated string");
+      }
+      const char c = _json[_pos];
+      if (c == '"') {
+        append(_json.data() + chunkStart, _pos - chunkStart);
+        ++_pos;
+        return;
+      } else if (c == '\\') {
+        append(_json.data() + chunkStart, _pos - chunkStart);
+        ++_pos;
+        decodeEscapeSequence(append);
+        chunkStart = _pos;
+      } else {
+        ++_pos;
+      }
+    }
+  }
+
+  /// Skip a value. Nested objects and arrays are tracked on an explicit stack, so that deeply
+  /// nested input can not overflow the call stack.
+  void skipValue() {
+    std::vector<char> closers;
+    do {
+      if (!closers.empty() && closers.back() == '}') {
+        skipString();
+        expect(':');
+      }
+      const char c = peek();
+      if (c == '{' || c == '[') {
+        const char close = c == '{' ? '}' : ']';
+        ++_pos;
+        if (!consume(close)) {
+          closers.push_back(close);
+          continue;
+        }
+      } else if (c == '"') {
+        skipString();
+      } else if (!consumeLiteral("true") && !consumeLiteral("false") && !consumeLiteral("null")) {
+        readNumber();
+      }
+
+      // Close all containers that are complete after this value.
+      while (!closers.empty() && !consume(',')) {
+        expect(closers.back());
+        closers.pop_back();
+      }
+    } while (!closers.empty());
+  }
+
+  /// Fail if anything but whitespace follows the current position.
+  void expectEnd() {
+    skipWhitespace();
+    if (_pos < _json.size()) {
+      fail("Unexpected data after JSON value");
+    }
+  }
+
+  [[noreturn]] void fail(const std::string& message) const {
+    throw std::runtime_error(message + " at offset " + std::to_string(_pos));
+  }
+
+private:
+  static bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+  }
+
+  void skipWhitespace() {
+    while (_pos < _json.size() &&
+           (_json[_pos] == ' ' || _json[_pos] == '\n' || _json[_pos] == '\r' ||
+            _json[_pos] == '\t')) {
+      ++_pos;
+    }
+  }
+
+  void skipString() {
+    expect('"');
+    while (_pos < _json.size() && _json[_pos] != '"') {
+      _pos += _json[_pos] == '\\' ? 2 : 1;
+    }
+    if (_pos >= _json.size()) {
+      fail("Unterminated string");
+    }
+    ++_pos;
+  }
+
+  uint32_t readHex4() {
+    if (_pos + 4 > _json.size()) {
+      fail("Invalid unicode escape sequence");
+    }
+    uint32_t value = 0;
+    const auto [ptr, ec] = std::from_chars(_json.data() + _pos, _json.data() + _pos + 4, value, 16);
+    if (ec != std::errc() || ptr != _json.data() + _pos + 4) {
+      fail("Invalid unicode escape sequence");
+    }
+    _pos += 4;
+    return value;
+  }
+
+  template <typename AppendFn>
+  void decodeEscapeSequence(AppendFn&& append) {
+    if (_pos >= _json.size()) {
+      fail("Unterminated string");
+    }
+    const char c = _json[_pos++];
+    char decoded;
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        decoded = c;
+        break;
+      case 'b':
+        decoded = '\b';
+        break;
+      case 'f':
+        decoded = '\f';
+        break;
+      case 'n':
+        decoded = '\n';
+        break;
+      case 'r':
+        decoded = '\r';
+        break;
+      case 't':
+        decoded = '\t';
+        break;
+      case 'u': {
+        uint32_t codePoint = readHex4();
+        if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+          fail("Unpaired low surrogate in unicode escape sequence");
+        } else if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+          if (_json.substr(_pos, 2) != "\\u") {
+            fail("Unpaired high surrogate in unicode escape sequence");
+          }
+          _pos += 2;
+          const uint32_t lowSurrogate = readHex4();
+          if (lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF) {
+            fail("Invalid low surrogate in unicode escape sequence");
+          }
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+        }
+        appendUtf8(codePoint, append);
+        return;
+      }
+      default:
+        fail(std::string("Invalid escape sequence '\\") + c + "'");
+    }
+    append(&decoded, 1);
+  }
+
+  template <typename AppendFn>
+  static void appendUtf8(uint32_t codePoint, AppendFn&& append) {
+    char utf8[4];
+    size_t size;
+    if (codePoint < 0x80) {
+      utf8[0] = static_cast<char>(codePoint);
+      size = 1;
+    } else if (codePoint < 0x800) {
+      utf8[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+      utf8[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+      size = 2;
+    } else if (codePoint < 0x10000) {
+      utf8[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+      utf8[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      utf8[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+      size = 3;
+    } else {
+      utf8[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+      utf8[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+      utf8[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      utf8[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+      size = 4;
+    }
+    append(utf8, size);
+  }
+
+  std::string_view _json;
+  size_t _pos = 0;
+};
+
+JsonCdrSerializer::JsonCdrSerializer(const std::string& schemaName, const std::string& schema)
+    : _schemaName(schemaName) {
+  // Split the schema into the definitions of the root message and its dependencies.
+  std::vector<std::string> definitions{""};
+  std::vector<std::string> definitionNames{normalizeTypeName(schemaName)};
+  size_t lineStart = 0;
+  while (lineStart <= schema.size()) {
+    auto lineEnd = schema.find('\n', lineStart);
+    if (lineEnd == std::string::npos) {
+      lineEnd = schema.size();
+    }
+    const std::string line = schema.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+
+    if (!line.empty() && line.find_first_not_of('=') == std::string::npos) {
+      continue;  // Delimiter line
+    } else if (line.rfind(DEFINITION_DELIMITER_PREFIX, 0) == 0) {
+      definitions.emplace_back();
+      definitionNames.push_back(
+        normalizeTypeName(trim(line.substr(std::strlen(DEFINITION_DELIMITER_PREFIX)))));
+    } else {
+      definitions.back() += line + "\n";
+    }
+  }
+
+  std::vector<std::string> resolving;
+  _rootMessageIndex =
+    compileMessage(definitionNames.front(), definitions, definitionNames, resolving);
+}
+
+size_t JsonCdrSerializer::compileMessage(const std::string& name,
+                                         const std::vector<std::string>& definitions,
+                                         const std::vector<std::string>& definitionNames,
+                                         std::vector<std::string>& resolving) {
+  const auto compiledIt = std::find_if(_messages.begin(), _messages.end(), [&name](const auto& m) {
+    return m.name == name;
+  });
+  if (compiledIt != _messages.end()) {
+    return static_cast<size_t>(compiledIt - _messages.begin());
+  } else if (std::find(resolving.begin(), resolving.end(), name) != resolving.end()) {
+    throw std::runtime_error("Recursive definition of type '" + name + "'");
+  }
+
+  const auto definitionIt = std::find(definitionNames.begin(), definitionNames.end(), name);
+  if (definitionIt == definitionNames.end()) {
+    throw std::runtime_error("Definition of type '" + name + "' not found");
+  }
+  const std::string& definition = definitions[definitionIt - definitionNames.begin()];
+  const std::string package = name.substr(0, name.find('/'));
+
+  resolving.push_back(name);
+  std::vector<Field> fields;
+  size_t lineStart = 0;
+  while (lineStart < definition.size()) {
+    auto lineEnd = definition.find('\n', lineStart);
+    if (lineEnd == std::string::npos) {
+      lineEnd = definition.size();
+    }
+    std::string line = definition.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+
+    line = trim(stripComment(line));
+    if (line.empty()) {
+      continue;
+    }
+    const auto typeEnd = line.find_first_of(" \t");
+    if (typeEnd == std::string::npos) {
+      throw std::runtime_error("Invalid field definition '" + line + "' in type '" + name + "'");
+    }
+    // Constants are defined as `<type> <NAME>=<value>`, fields as `<type> <name> [<default>]`.
+    const std::string rest = trim(line.substr(typeEnd));
+    const auto nameEnd = rest.find_first_of(" \t=");
+    const auto valueStart = rest.find_first_not_of(" \t", nameEnd);
+    if (valueStart != std::string::npos && rest[valueStart] == '=') {
+      continue;  // Constant
+    }
+
+    Field field;
+    field.name = rest.substr(0, nameEnd);
+    std::string type = line.substr(0, typeEnd);
+
+    // Array suffix: T[], T[<=N] or T[N]
+    if (type.back() == ']') {
+      const auto bracket = type.find('[');
+      if (bracket == std::string::npos) {
+        throw std::runtime_error("Invalid type '" + type + "' in type '" + name + "'");
+      }
+      const std::string length = type.substr(bracket + 1, type.size() - bracket - 2);
+      if (length.empty()) {
+        field.arrayKind = ArrayKind::Sequence;
+      } else if (length.rfind("<=", 0) == 0) {
+        field.arrayKind = ArrayKind::Sequence;
+        field.arrayLength = parseLength(length.substr(2), type);
+      } else {
+        field.arrayKind = ArrayKind::Fixed;
+        field.arrayLength = parseLength(length, type);
+      }
+      type = type.substr(0, bracket);
+    }
+
+    static const std::unordered_map<std::string, std::pair<FieldKind, uint8_t>> PRIMITIVES{
+      {"bool", {FieldKind::Bool, 1}},       {"byte", {FieldKind::UInt8, 1}},
+      {"char", {FieldKind::UInt8, 1}},      {"int8", {FieldKind::Int8, 1}},
+      {"uint8", {FieldKind::UInt8, 1}},     {"int16", {FieldKind::Int16, 2}},
+      {"uint16", {FieldKind::UInt16, 2}},   {"int32", {FieldKind::Int32, 4}},
+      {"uint32", {FieldKind::UInt32, 4}},   {"int64", {FieldKind::Int64, 8}},
+      {"uint64", {FieldKind::UInt64, 8}},   {"float32", {FieldKind::Float32, 4}},
+      {"float64", {FieldKind::Float64, 8}},
+    };
+
+    if (const auto primitiveIt = PRIMITIVES.find(type); primitiveIt != PRIMITIVES.end()) {
+      field.kind = primitiveIt->second.first;
+      field.size = primitiveIt->second.second;
+    } else if (type == "string" || type.rfind("string<=", 0) == 0) {
+      field.kind = FieldKind::String;
+      if (type.size() > std::strlen("string")) {
+        field.stringBound = parseLength(type.substr(std::strlen("string<=")), type);
+      }
+    } else if (type.rfind("wstring", 0) == 0) {
+      throw std::runtime_error("Unsupported type '" + type + "' in type '" + name + "'");
+    } else {
+      std::string nestedName = type == "Header" ? "std_msgs/Header" : normalizeTypeName(type);
+      if (nestedName.find('/') == std::string::npos) {
+        nestedName = package + "/" + nestedName;
+      }
+      field.kind = FieldKind::Message;
+      field.messageIndex = compileMessage(nestedName, definitions, definitionNames, resolving);
+    }
+
+    if (valueStart != std::string::npos) {
+      try {
+        if (field.kind == FieldKind::Message) {
+          throw std::runtime_error("Only primitive fields can have a default value");
+        }
+        field.defaultJson = defaultValueToJson(rest.substr(valueStart),
+                                               field.arrayKind != ArrayKind::None,
+                                               field.kind == FieldKind::String);
+        // Serialize the default value once, so that invalid values are rejected right away.
+        std::vector<uint8_t> scratch;
+        VectorOutputBuffer buffer(scratch);
+        Writer writer(buffer);
+        Reader reader(field.defaultJson);
+        writeField(reader, field, writer);
+        reader.expectEnd();
+      } catch (const std::runtime_error& ex) {
+        throw std::runtime_error("Invalid default value of field '" + field.name + "' in type '" +
+                                 name + "': " + ex.what());
+      }
+    }
+    fields.push_back(std::move(field));
+  }
+  resolving.pop_back();
+
+  // Empty messages are generated with a single dummy member.
+  if (fields.empty()) {
+    Field field;
+    field.name = EMPTY_MESSAGE_FIELD_NAME;
+    field.kind = FieldKind::UInt8;
+    field.size = 1;
+    fields.push_back(std::move(field));
+  }
+
+  _messages.push_back(Message{name, std::move(fields)});
+  return _messages.size() - 1;
+}
+
+void JsonCdrSerializer::serialize(std::string_view json, std::vector<uint8_t>& out) const {
+  VectorOutputBuffer buffer(out);
+  serialize(json, buffer);
+}
+
+void JsonCdrSerializer::serialize(std::string_view json, OutputBuffer& out) const {
+  Reader reader(json);
+  Writer writer(out);
+  writeMessage(reader, _rootMessageIndex, writer);
+  reader.expectEnd();
+  writer.finish();
+}
+
+void JsonCdrSerializer::writeMessage(Reader& reader, size_t messageIndex, Writer& writer) const {
+  if (reader.consumeLiteral("null")) {
+    writeDefaultMessage(messageIndex, writer);
+    return;
+  }
+
+  const auto& fields = _messages[messageIndex].fields;
+  const size_t objectStart = reader.position();
+  std::string scratch;
+  reader.expect('{');
+
+  // Fast path: Fields given in schema order are written as soon as they are read.
+  size_t nextField = 0;
+  bool inOrder = true;
+  if (!reader.consume('}')) {
+    do {
+      const auto key = reader.readString(scratch);
+      reader.expect(':');
+      if (nextField >= fields.size() || key != fields[nextField].name) {
+        inOrder = false;
+        break;
+      }
+      writeField(reader, fields[nextField++], writer);
+    } while (reader.consume(','));
+    if (inOrder) {
+      reader.expect('}');
+    }
+  }
+
+  if (inOrder) {
+    for (; nextField < fields.size(); ++nextField) {
+      writeDefaultField(fields[nextField], writer);
+    }
+    return;
+  }
+
+  // Slow path: Find the values of the remaining fields, then write them in schema order.
+  constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+  std::vector<size_t> valuePositions(fields.size(), NOT_FOUND);
+  reader.seek(objectStart);
+  reader.expect('{');
+  if (!reader.consume('}')) {
+    do {
+      const auto key = reader.readString(scratch);
+      reader.expect(':');
+      for (size_t i = nextField; i < fields.size(); ++i) {
+        if (key == fields[i].name) {
+          valuePositions[i] = reader.position();
+          break;
+        }
+      }
+      reader.skipValue();
+    } while (reader.consume(','));
+    reader.expect('}');
+  }
+  const size_t objectEnd = reader.position();
+
+  for (size_t i = nextField; i < fields.size(); ++i) {
+    if (valuePositions[i] == NOT_FOUND) {
+      writeDefaultField(fields[i], writer);
+    } else {
+      reader.seek(valuePositions[i]);
+      writeField(reader, fields[i], writer);
+    }
+  }
+  reader.seek(objectEnd);
+}
+
+void JsonCdrSerializer::writeField(Reader& reader, const Field& field, Writer& writer) const {
+  try {
+    if (field.arrayKind == ArrayKind::None) {
+      writeValue(reader, field, writer);
+      return;
+    } else if (reader.consumeLiteral("null")) {
+      writeDefaultField(field, writer);
+      return;
+    }
+
+    const bool isSequence = field.arrayKind == ArrayKind::Sequence;
+    const size_t lengthOffset = isSequence ? writer.reserveUint32() : 0;
+    uint32_t length = 0;
+
+    if ((field.kind == FieldKind::UInt8 || field.kind == FieldKind::Int8) && reader.peek() == '"') {
+      // Byte arrays may be given as base64 string
+      std::string scratch;
+      const auto encoded = reader.readString(scratch);
+      const auto decoded = base64Decode(std::string(encoded));
+      length = static_cast<uint32_t>(decoded.size());
+      writer.append(decoded.data(), decoded.size());
+    } else {
+      reader.expect('[');
+      if (!reader.consume(']')) {
+        do {
+          writeValue(reader, field, writer);
+          ++length;
+        } while (reader.consume(','));
+        reader.expect(']');
+      }
+    }
+
+    if (!isSequence && length != field.arrayLength) {
+      throw std::runtime_error("Expected " + std::to_string(field.arrayLength) +
+                               " elements but got " + std::to_string(length));
+    } else if (isSequence && field.arrayLength > 0 && length > field.arrayLength) {
+      throw std::runtime_error("Sequence of " + std::to_string(length) +
+                               " elements exceeds bound of " + std::to_string(field.arrayLength));
+    }
+    if (isSequence) {
+      writer.patchUint32(lengthOffset, length);
+    }
+  } catch (const std::runtime_error& ex) {
+    throw std::runtime_error("Field '" + field.name + "': " + ex.what());
+  }
+}
+
+void JsonCdrSerializer::writeValue(Reader& reader, const Field& field, Writer& writer) const {
+  if (field.kind == FieldKind::Message) {
+    writeMessage(reader, field.messageIndex, writer);
+    return;
+  } else if (field.kind == FieldKind::String) {
+    if (reader.consumeLiteral("null")) {
+      writeDefaultValue(field, writer);
+      return;
+    }
+    const size_t lengthOffset = writer.reserveUint32();
+    const size_t start = writer.size();
+    reader.decodeString([&writer](const char* data, size_t size) {
+      writer.append(data, size);
+    });
+    const size_t length = writer.size() - start;
+    if (field.stringBound > 0 && length > field.stringBound) {
+      throw std::runtime_error("String of length " + std::to_string(length) +
+                               " exceeds bound of " + std::to_string(field.stringBound));
+    }
+    writer.appendZeros(1);  // Null terminator, included in the length
+    writer.patchUint32(lengthOffset, static_cast<uint32_t>(length + 1));
+    return;
+  }
+
+  if (reader.consumeLiteral("null")) {
+    if (field.kind == FieldKind::Float32) {
+      writer.write(std::numeric_limits<float>::quiet_NaN());
+    } else if (field.kind == FieldKind::Float64) {
+      writer.write(std::numeric_limits<double>::quiet_NaN());
+    } else {
+      writeDefaultValue(field, writer);
+    }
+    return;
+  }
+
+  switch (field.kind) {
+    case FieldKind::Bool:
+      if (reader.consumeLiteral("true")) {
+        writer.write(uint8_t{1});
+      } else if (reader.consumeLiteral("false")) {
+        writer.write(uint8_t{0});
+      } else {
+        writer.write(static_cast<uint8_t>(parseInteger<int64_t>(reader.readNumber()) != 0));
+      }
+      break;
+    case FieldKind::Int8:
+      writer.write(parseInteger<int8_t>(reader.readNumber()));
+      break;
+    case FieldKind::UInt8:
+      writer.write(parseInteger<uint8_t>(reader.readNumber()));
+      break;
+    case FieldKind::Int16:
+      writer.write(parseInteger<int16_t>(reader.readNumber()));
+      break;
+    case FieldKind::UInt16:
+      writer.write(parseInteger<uint16_t>(reader.readNumber()));
+      break;
+    case FieldKind::Int32:
+      writer.write(parseInteger<int32_t>(reader.readNumber()));
+      break;
+    case FieldKind::UInt32:
+      writer.write(parseInteger<uint32_t>(reader.readNumber()));
+      break;
+    case FieldKind::Int64:
+      writer.write(parseInteger<int64_t>(reader.readNumber()));
+      break;
+    case FieldKind::UInt64:
+      writer.write(parseInteger<uint64_t>(reader.readNumber()));
+      break;
+    case FieldKind::Float32:
+      writer.write(static_cast<float>(parseDouble(reader.readNumber())));
+      break;
+    case FieldKind::Float64:
+      writer.write(parseDouble(reader.readNumber()));
+      break;
+    default:
+      throw std::runtime_error("Unhandled field kind");
+  }
+}
+
+void JsonCdrSerializer::writeDefaultMessage(size_t messageIndex, Writer& writer) const {
+  for (const auto& field : _messages[messageIndex].fields) {
+    writeDefaultField(field, writer);
+  }
+}
+
+void JsonCdrSerializer::writeDefaultField(const Field& field, Writer& writer) const {
+  if (!field.defaultJson.empty()) {
+    Reader reader(field.defaultJson);
+    writeField(reader, field, writer);
+    return;
+  }
+
+  switch (field.arrayKind) {
+    case ArrayKind::None:
+      writeDefaultValue(field, writer);
+      break;
+    case ArrayKind::Fixed:
+      for (uint32_t i = 0; i < field.arrayLength; ++i) {
+        writeDefaultValue(field, writer);
+      }
+      break;
+    case ArrayKind::Sequence:
+      writer.write(uint32_t{0});
+      break;
+  }
+}
+
+void JsonCdrSerializer::writeDefaultValue(const Field& field, Writer& writer) const {
+  if (field.kind == FieldKind::Message) {
+    writeDefaultMessage(field.messageIndex, writer);
+  } else if (field.kind == FieldKind::String) {
+    writer.write(uint32_t{1});
+    writer.appendZeros(1);
+  } else {
+    writer.align(field.size);
+    writer.appendZeros(field.size);
+  }
+}
+
+}  // namespace foxglove_ws
@@ -0,0 +1,461 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifdef FOXGLOVE_BRIDGE_HAS_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef FOXGLOVE_BRIDGE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include <foxglove_bridge/mcap_reader.hpp>
+
+namespace foxglove_ws {
+
+namespace {
+
+constexpr uint8_t MAGIC[] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+constexpr uint64_t RECORD_HEADER_SIZE = 1 + sizeof(uint64_t);
+constexpr uint64_t FOOTER_LENGTH = sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t);
+/// Number of unchunked messages which are loaded at once when iterating over them.
+constexpr size_t UNCHUNKED_MESSAGES_PER_RANGE = 1024;
+
+enum Opcode : uint8_t {
+  Footer = 0x02,
+  Schema = 0x03,
+  Channel = 0x04,
+  Message = 0x05,
+  Chunk = 0x06,
+  ChunkIndex = 0x08,
+  DataEnd = 0x0F,
+};
+
+/// Bounds checked reading of little endian values.
+class Cursor {
+public:
+  Cursor(const uint8_t* data, uint64_t length)
+      : _data(data)
+      , _end(data + length) {}
+
+  uint64_t remaining() const {
+    return static_cast<uint64_t>(_end - _data);
+  }
+
+  const uint8_t* position() const {
+    return _data;
+  }
+
+  uint8_t readUint8() {
+    return read(1)[0];
+  }
+
+  uint16_t readUint16() {
+    return static_cast<uint16_t>(readUint(sizeof(uint16_t)));
+  }
+
+  uint32_t readUint32() {
+    return static_cast<uint32_t>(readUint(sizeof(uint32_t)));
+  }
+
+  uint64_t readUint64() {
+    return readUint(sizeof(uint64_t));
+  }
+
+  std::string readString() {
+    const uint32_t size = readUint32();
+    const uint8_t* data = read(size);
+    return std::string(reinterpret_cast<const char*>(data), size);
+  }
+
+  const uint8_t* read(uint64_t size) {
+    if (size > remaining()) {
+      throw std::runtime_error("Unexpected end of MCAP record");
+    }
+    const uint8_t* data = _data;
+    _data += size;
+    return data;
+  }
+
+private:
+  uint64_t readUint(size_t size) {
+    const uint8_t* bytes = read(size);
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+      value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  const uint8_t* _data;
+  const uint8_t* _end;
+};
+
+bool isSupportedCompression(const std::string& compression) {
+#ifdef FOXGLOVE_BRIDGE_HAS_ZSTD
+  if (compression == "zstd") {
+    return true;
+  }
+#endif
+#ifdef FOXGLOVE_BRIDGE_HAS_LZ4
+  if (compression == "lz4") {
+    return true;
+  }
+#endif
+  return compression.empty();
+}
+
+void decompress(const std::string& compression, const uint8_t* data, uint64_t size,
+                std::vector<uint8_t>& output) {
+#ifdef FOXGLOVE_BRIDGE_HAS_ZSTD
+  if (compression == "zstd") {
+    const size_t result = ZSTD_decompress(output.data(), output.size(), data, size);
+    if (ZSTD_isError(result) || result != output.size()) {
+      throw std::runtime_error("Failed to decompress zstd chunk");
+    }
+    return;
+  }
+#endif
+#ifdef FOXGLOVE_BRIDGE_HAS_LZ4
+  if (compression == "lz4") {
+    LZ4F_dctx* context = nullptr;
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION))) {
+      throw std::runtime_error("Failed to create lz4 decompression context");
+    }
+    size_t srcOffset = 0;
+    size_t dstOffset = 0;
+    size_t result = 1;
+    while (result != 0 && srcOffset < size && dstOffset < output.size()) {
+      size_t srcSize = size - srcOffset;
+      size_t dstSize = output.size() - dstOffset;
+      result = LZ4F_decompress(context, output.data() + dstOffset, &dstSize, data + srcOffset,
+                               &srcSize, nullptr);
+      if (LZ4F_isError(result)) {
+        break;
+      }
+      srcOffset += srcSize;
+      dstOffset += dstSize;
+    }
+    LZ4F_freeDecompressionContext(context);
+    if (LZ4F_isError(result) || dstOffset != output.size()) {
+      throw std::runtime_error("Failed to decompress lz4 chunk");
+    }
+    return;
+  }
+#endif
+  (void)data;
+  (void)size;
+  (void)output;
+  throw std::runtime_error("Unsupported chunk compression '" + compression + "'");
+}
+
+}  // namespace
+
+McapReader::~McapReader() {
+  close();
+}
+
+void McapReader::open(const std::string& path) {
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    const int error = errno;
+    ::close(fd);
+    throw std::runtime_error("Failed to open " + path + ": " + std::strerror(error));
+  }
+  const size_t size = static_cast<size_t>(fileStat.st_size);
+  if (size < 2 * sizeof(MAGIC) + RECORD_HEADER_SIZE + FOOTER_LENGTH) {
+    ::close(fd);
+    throw std::runtime_error(path + " is not a valid MCAP file (too small)");
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int error = errno;
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Failed to map " + path + ": " + std::strerror(error));
+  }
+  _path = path;
+  _data = static_cast<const uint8_t*>(data);
+  _size = size;
+
+  try {
+    if (std::memcmp(_data, MAGIC, sizeof(MAGIC)) != 0 ||
+        std::memcmp(_data + _size - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+      throw std::runtime_error(path + " is not a valid MCAP file (invalid magic)");
+    }
+
+    const uint64_t footerOffset = _size - sizeof(MAGIC) - RECORD_HEADER_SIZE - FOOTER_LENGTH;
+    Cursor footer(_data + footerOffset, RECORD_HEADER_SIZE + FOOTER_LENGTH);
+    if (footer.readUint8() != Opcode::Footer || footer.readUint64() != FOOTER_LENGTH) {
+      throw std::runtime_error(path + " is not a valid MCAP file (invalid footer)");
+    }
+    const uint64_t summaryStart = footer.readUint64();
+    const uint64_t summaryOffsetStart = footer.readUint64();
+
+    if (summaryStart != 0) {
+      const uint64_t summaryEnd = summaryOffsetStart != 0 ? summaryOffsetStart : footerOffset;
+      if (summaryStart > summaryEnd || summaryEnd > footerOffset) {
+        throw std::runtime_error(path + " is not a valid MCAP file (invalid summary offset)");
+      }
+      readSummary(summaryStart, summaryEnd);
+    }
+    if (_chunks.empty()) {
+      // Unindexed file, the messages have to be located by reading the whole data section.
+      scanDataSection(summaryStart != 0 ? summaryStart : footerOffset);
+    }
+  } catch (const std::exception&) {
+    close();
+    throw;
+  }
+
+  std::stable_sort(_chunks.begin(), _chunks.end(), [](const ChunkRef& a, const ChunkRef& b) {
+    return a.startTime < b.startTime;
+  });
+}
+
+void McapReader::close() {
+  if (_data) {
+    munmap(const_cast<uint8_t*>(_data), _size);
+  }
+  _data = nullptr;
+  _size = 0;
+  _path.clear();
+  _schemas.clear();
+  _channels.clear();
+  _chunks.clear();
+}
+
+uint64_t McapReader::startTime() const {
+  if (_chunks.empty()) {
+    return 0;
+  }
+  return _chunks.front().startTime;
+}
+
+uint64_t McapReader::endTime() const {
+  uint64_t endTime = 0;
+  for (const auto& chunk : _chunks) {
+    endTime = std::max(endTime, chunk.endTime);
+  }
+  return endTime;
+}
+
+McapReader::MessageIterator McapReader::messages(uint64_t startTime) const {
+  return MessageIterator(*this, startTime);
+}
+
+void McapReader::readSummary(uint64_t summaryStart, uint64_t summaryEnd) {
+  Cursor summary(_data + summaryStart, summaryEnd - summaryStart);
+  while (summary.remaining() > 0) {
+    const uint8_t opcode = summary.readUint8();
+    const uint64_t length = summary.readUint64();
+    const uint8_t* data = summary.read(length);
+    if (opcode == Opcode::Schema) {
+      readSchema(data, length);
+    } else if (opcode == Opcode::Channel) {
+      readChannel(data, length);
+    } else if (opcode == Opcode::ChunkIndex) {
+      Cursor chunkIndex(data, length);
+      ChunkRef chunk;
+      chunk.startTime = chunkIndex.readUint64();
+      chunk.endTime = chunkIndex.readUint64();
+      chunk.offset = chunkIndex.readUint64();
+      chunk.length = 0;
+      if (chunk.offset >= summaryStart) {
+        throw std::runtime_error(_path + " is not a valid MCAP file (invalid chunk offset)");
+      }
+      chunkIndex.read(sizeof(uint64_t));         // Chunk length
+      chunkIndex.read(chunkIndex.readUint32());  // Message index offsets
+      chunkIndex.read(sizeof(uint64_t));         // Message index length
+      checkCompression(chunkIndex.readString());
+      _chunks.push_back(chunk);
+    }
+  }
+}
+
+void McapReader::scanDataSection(uint64_t dataEnd) {
+  Cursor records(_data + sizeof(MAGIC), dataEnd - sizeof(MAGIC));
+  ChunkRef unchunked{std::numeric_limits<uint64_t>::max(), 0, 0, 0};
+  size_t unchunkedCount = 0;
+
+  while (records.remaining() > 0) {
+    const uint64_t offset = static_cast<uint64_t>(records.position() - _data);
+    const uint8_t opcode = records.readUint8();
+    const uint64_t length = records.readUint64();
+    const uint8_t* data = records.read(length);
+    if (opcode == Opcode::DataEnd || opcode == Opcode::Footer) {
+      break;
+    } else if (opcode == Opcode::Schema) {
+      readSchema(data, length);
+    } else if (opcode == Opcode::Channel) {
+      readChannel(data, length);
+    } else if (opcode == Opcode::Chunk) {
+      Cursor chunk(data, length);
+      const uint64_t startTime = chunk.readUint64();
+      const uint64_t endTime = chunk.readUint64();
+      chunk.read(sizeof(uint64_t) + sizeof(uint32_t));  // Uncompressed size and CRC
+      checkCompression(chunk.readString());
+      _chunks.push_back({startTime, endTime, offset, 0});
+    } else if (opcode == Opcode::Message) {
+      Cursor message(data, length);
+      message.read(sizeof(uint16_t) + sizeof(uint32_t));
+      const uint64_t logTime = message.readUint64();
+      if (unchunkedCount == 0) {
+        unchunked.offset = offset;
+      }
+      unchunked.startTime = std::min(unchunked.startTime, logTime);
+      unchunked.endTime = std::max(unchunked.endTime, logTime);
+      unchunked.length = offset + RECORD_HEADER_SIZE + length - unchunked.offset;
+      if (++unchunkedCount == UNCHUNKED_MESSAGES_PER_RANGE) {
+        _chunks.push_back(unchunked);
+        unchunked = {std::numeric_limits<uint64_t>::max(), 0, 0, 0};
+        unchunkedCount = 0;
+      }
+    }
+  }
+
+  if (unchunkedCount > 0) {
+    _chunks.push_back(unchunked);
+  }
+}
+
+void McapReader::checkCompression(const std::string& compression) const {
+  // Rejected when opening the file rather than once playback reaches the chunk.
+  if (!isSupportedCompression(compression)) {
+    throw std::runtime_error(_path + " uses unsupported chunk compression '" + compression + "'");
+  }
+}
+
+void McapReader::readSchema(const uint8_t* data, uint64_t length) {
+  Cursor record(data, length);
+  McapSchema schema;
+  schema.id = record.readUint16();
+  schema.name = record.readString();
+  schema.encoding = record.readString();
+  schema.data = record.readString();
+  _schemas[schema.id] = std::move(schema);
+}
+
+void McapReader::readChannel(const uint8_t* data, uint64_t length) {
+  Cursor record(data, length);
+  McapChannel channel;
+  channel.id = record.readUint16();
+  channel.schemaId = record.readUint16();
+  channel.topic = record.readString();
+  channel.messageEncoding = record.readString();
+  _channels[channel.id] = std::move(channel);
+}
+
+McapReader::MessageIterator::MessageIterator(const McapReader& reader, uint64_t startTime)
+    : _reader(reader)
+    , _startTime(startTime) {}
+
+bool McapReader::MessageIterator::next(McapMessageView& message) {
+  // The previously returned message may point into a chunk that is now exhausted.
+  _loadedChunks.erase(std::remove_if(_loadedChunks.begin(), _loadedChunks.end(),
+                                     [](const std::unique_ptr<LoadedChunk>& chunk) {
+                                       return chunk->position == chunk->messages.size();
+                                     }),
+                      _loadedChunks.end());
+
+  const auto& chunks = _reader._chunks;
+  while (true) {
+    LoadedChunk* earliest = nullptr;
+    for (const auto& chunk : _loadedChunks) {
+      if (!earliest || chunk->messages[chunk->position].logTime <
+                         earliest->messages[earliest->position].logTime) {
+        earliest = chunk.get();
+      }
+    }
+
+    // Chunks may overlap in time, so all chunks starting before the earliest loaded message have
+    // to be loaded as well. Typically, only one chunk is loaded at a time.
+    if (_nextChunk < chunks.size() &&
+        (!earliest ||
+         chunks[_nextChunk].startTime <= earliest->messages[earliest->position].logTime)) {
+      const auto& chunk = chunks[_nextChunk++];
+      if (chunk.endTime >= _startTime) {
+        loadChunk(chunk);
+      }
+      continue;
+    }
+
+    if (!earliest) {
+      return false;
+    }
+    message = earliest->messages[earliest->position++];
+    return true;
+  }
+}
+
+void McapReader::MessageIterator::loadChunk(const ChunkRef& chunk) {
+  auto loadedChunk = std::make_unique<LoadedChunk>();
+  const uint8_t* records = _reader._data + chunk.offset;
+  uint64_t recordsLength = chunk.length;
+
+  if (chunk.length == 0) {
+    Cursor chunkRecord(_reader._data + chunk.offset, _reader._size - chunk.offset);
+    if (chunkRecord.readUint8() != Opcode::Chunk) {
+      throw std::runtime_error(_reader._path + ": chunk index points to a non-chunk record");
+    }
+    const uint64_t chunkLength = chunkRecord.readUint64();
+    Cursor chunkData(chunkRecord.read(chunkLength), chunkLength);
+    chunkData.read(sizeof(uint64_t) + sizeof(uint64_t));  // Start and end time
+    const uint64_t uncompressedSize = chunkData.readUint64();
+    chunkData.read(sizeof(uint32_t));  // CRC is not verified
+    const std::string compression = chunkData.readString();
+    recordsLength = chunkData.readUint64();
+    records = chunkData.read(recordsLength);
+    if (!compression.empty()) {
+      loadedChunk->decompressed.resize(uncompressedSize);
+      decompress(compression, records, recordsLength, loadedChunk->decompressed);
+      records = loadedChunk->decompressed.data();
+      recordsLength = uncompressedSize;
+    }
+  }
+
+  Cursor cursor(records, recordsLength);
+  while (cursor.remaining() > 0) {
+    const uint8_t opcode = cursor.readUint8();
+    const uint64_t length = cursor.readUint64();
+    const uint8_t* data = cursor.read(length);
+    if (opcode != Opcode::Message) {
+      continue;
+    }
+    Cursor record(data, length);
+    McapMessageView message;
+    message.channelId = record.readUint16();
+    message.sequence = record.readUint32();
+    message.logTime = record.readUint64();
+    message.publishTime = record.readUint64();
+    message.size = record.remaining();
+    message.data = record.read(message.size);
+    if (message.logTime >= _startTime) {
+      loadedChunk->messages.push_back(message);
+    }
+  }
+
+  if (loadedChunk->messages.empty()) {
+    return;
+  }
+  // Messages within a chunk are not required to be ordered by log time.
+  std::stable_sort(loadedChunk->messages.begin(), loadedChunk->messages.end(),
+                   [](const McapMessageView& a, const McapMessageView& b) {
+                     return a.logTime < b.logTime;
+                   });
+  _loadedChunks.push_back(std::move(loadedChunk));
+}
+
+}  // namespace foxglove_ws
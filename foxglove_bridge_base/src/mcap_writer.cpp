@@ -0,0 +1,182 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <foxglove_bridge/mcap_writer.hpp>
+
+namespace foxglove_ws {
+
+namespace {
+
+constexpr uint8_t MAGIC[] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+constexpr char LIBRARY[] = "foxglove_bridge";
+
+uint64_t stringSize(const std::string& str) {
+  return sizeof(uint32_t) + str.size();
+}
+
+}  // namespace
+
+McapWriter::McapWriter(size_t bufferSize)
+    : _bufferSize(bufferSize) {}
+
+McapWriter::~McapWriter() {
+  if (_file) {
+    try {
+      close();
+    } catch (const std::exception&) {
+      // Errors can not be reported from the destructor.
+    }
+  }
+}
+
+void McapWriter::open(const std::string& path, const std::string& profile) {
+  if (_file) {
+    throw std::runtime_error("MCAP writer is already open");
+  }
+  // O_EXCL so that an existing recording is never overwritten.
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+  if (fd < 0 || !(_file = ::fdopen(fd, "wb"))) {
+    const std::string error = std::strerror(errno);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw std::runtime_error("Failed to open " + path + ": " + error);
+  }
+  // Writes are buffered by the writer itself.
+  std::setvbuf(_file, nullptr, _IONBF, 0);
+  _path = path;
+  _buffer.reserve(_bufferSize);
+
+  writeBytes(MAGIC, sizeof(MAGIC));
+  const std::string library = LIBRARY;
+  writeRecordHeader(Opcode::Header, stringSize(profile) + stringSize(library));
+  writeString(profile);
+  writeString(library);
+}
+
+uint16_t McapWriter::addSchema(const std::string& name, const std::string& encoding,
+                               const std::string& data) {
+  const uint16_t id = _nextSchemaId++;
+  writeRecordHeader(Opcode::Schema,
+                    sizeof(uint16_t) + stringSize(name) + stringSize(encoding) + stringSize(data));
+  writeUint16(id);
+  writeString(name);
+  writeString(encoding);
+  writeString(data);
+  return id;
+}
+
+uint16_t McapWriter::addChannel(uint16_t schemaId, const std::string& topic,
+                                const std::string& messageEncoding) {
+  const uint16_t id = _nextChannelId++;
+  writeRecordHeader(Opcode::Channel, sizeof(uint16_t) + sizeof(uint16_t) + stringSize(topic) +
+                                       stringSize(messageEncoding) + sizeof(uint32_t));
+  writeUint16(id);
+  writeUint16(schemaId);
+  writeString(topic);
+  writeString(messageEncoding);
+  writeUint32(0);  // Empty metadata map
+  return id;
+}
+
+void McapWriter::writeMessage(uint16_t channelId, uint32_t sequence, uint64_t logTime,
+                              uint64_t publishTime, const uint8_t* data, size_t size) {
+  writeRecordHeader(Opcode::Message, sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint64_t) +
+                                       sizeof(uint64_t) + size);
+  writeUint16(channelId);
+  writeUint32(sequence);
+  writeUint64(logTime);
+  writeUint64(publishTime);
+  writeBytes(data, size);
+}
+
+void McapWriter::close() {
+  if (!_file) {
+    return;
+  }
+
+  writeRecordHeader(Opcode::DataEnd, sizeof(uint32_t));
+  writeUint32(0);  // Data section CRC is not computed
+  writeRecordHeader(Opcode::Footer, sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t));
+  writeUint64(0);  // No summary section
+  writeUint64(0);  // No summary offset section
+  writeUint32(0);  // Summary CRC is not computed
+  writeBytes(MAGIC, sizeof(MAGIC));
+
+  std::FILE* file = _file;
+  bool success = true;
+  try {
+    flush();
+  } catch (const std::exception&) {
+    success = false;
+  }
+  _file = nullptr;
+  if (std::fclose(file) != 0 || !success) {
+    throw std::runtime_error("Failed to write " + _path);
+  }
+}
+
+void McapWriter::writeRecordHeader(Opcode opcode, uint64_t length) {
+  const uint8_t opcodeByte = static_cast<uint8_t>(opcode);
+  writeBytes(&opcodeByte, sizeof(opcodeByte));
+  writeUint64(length);
+}
+
+void McapWriter::writeUint16(uint16_t value) {
+  const uint8_t bytes[] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8)};
+  writeBytes(bytes, sizeof(bytes));
+}
+
+void McapWriter::writeUint32(uint32_t value) {
+  uint8_t bytes[sizeof(value)];
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  writeBytes(bytes, sizeof(bytes));
+}
+
+void McapWriter::writeUint64(uint64_t value) {
+  uint8_t bytes[sizeof(value)];
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  writeBytes(bytes, sizeof(bytes));
+}
+
+void McapWriter::writeString(const std::string& str) {
+  writeUint32(static_cast<uint32_t>(str.size()));
+  writeBytes(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+}
+
+void McapWriter::writeBytes(const uint8_t* data, size_t size) {
+  if (!_file) {
+    throw std::runtime_error("MCAP writer is not open");
+  }
+  if (_buffer.size() + size > _bufferSize) {
+    flush();
+  }
+  if (size >= _bufferSize) {
+    // Large payloads are written directly instead of being copied into the buffer first.
+    if (std::fwrite(data, 1, size, _file) != size) {
+      throw std::runtime_error("Failed to write " + _path + ": " + std::strerror(errno));
+    }
+    return;
+  }
+  _buffer.insert(_buffer.end(), data, data + size);
+}
+
+void McapWriter::flush() {
+  if (_buffer.empty()) {
+    return;
+  }
+  if (std::fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size()) {
+    throw std::runtime_error("Failed to write " + _path + ": " + std::strerror(errno));
+  }
+  _buffer.clear();
+}
+
+}  // namespace foxglove_ws
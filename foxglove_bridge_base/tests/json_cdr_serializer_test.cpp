@@ -0,0 +1,224 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/json_cdr_serializer.hpp>
+
+namespace {
+
+constexpr char TWIST_SCHEMA[] =
+  "Vector3 linear\n"
+  "Vector3 angular\n"
+  "================================================================================\n"
+  "MSG: geometry_msgs/Vector3\n"
+  "float64 x\n"
+  "float64 y\n"
+  "float64 z\n";
+
+class CdrBuilder {
+public:
+  CdrBuilder() {
+    data = {0x00, 0x01, 0x00, 0x00};
+  }
+
+  template <typename T>
+  CdrBuilder& add(T value) {
+    while ((data.size() - 4) % sizeof(T) != 0) {
+      data.push_back(0);
+    }
+    const size_t offset = data.size();
+    data.resize(offset + sizeof(T));
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+    return *this;
+  }
+
+  CdrBuilder& addString(const std::string& str) {
+    add(static_cast<uint32_t>(str.size() + 1));
+    data.insert(data.end(), str.begin(), str.end());
+    data.push_back(0);
+    return *this;
+  }
+
+  std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> serialize(const foxglove_ws::JsonCdrSerializer& serializer,
+                               const std::string& json) {
+  std::vector<uint8_t> out;
+  serializer.serialize(json, out);
+  return out;
+}
+
+}  // namespace
+
+TEST(JsonCdrSerializerTest, NestedMessage) {
+  const foxglove_ws::JsonCdrSerializer serializer("geometry_msgs/msg/Twist", TWIST_SCHEMA);
+  const auto expected =
+    CdrBuilder().add(1.0).add(2.0).add(3.0).add(-1.0).add(0.5).add(0.0).data;
+  EXPECT_EQ(expected, serialize(serializer, R"({"linear": {"x": 1, "y": 2.0, "z": 3e0},
+                                                "angular": {"x": -1, "y": 0.5, "z": 0}})"));
+}
+
+TEST(JsonCdrSerializerTest, FieldOrderAndMissingFields) {
+  const foxglove_ws::JsonCdrSerializer serializer("geometry_msgs/msg/Twist", TWIST_SCHEMA);
+  const auto expected =
+    CdrBuilder().add(0.0).add(0.0).add(1.0).add(0.0).add(0.0).add(2.0).data;
+  EXPECT_EQ(expected, serialize(serializer, R"({"angular": {"z": 2, "unknown": [1, {}]},
+                                                "linear": {"z": 1}})"));
+}
+
+TEST(JsonCdrSerializerTest, StringsArraysAndAlignment) {
+  const foxglove_ws::JsonCdrSerializer serializer(
+    "test_msgs/msg/Mixed",
+    "int32 CONSTANT=5\n"
+    "string name  # comment\n"
+    "uint8 flag\n"
+    "int64[] values\n"
+    "float32[2] pair\n"
+    "bool[<=3] bools\n"
+    "uint8[] bytes\n");
+  const auto expected = CdrBuilder()
+                          .addString("a\"b\xc3\xa9")
+                          .add(uint8_t{7})
+                          .add(uint32_t{2})
+                          .add(int64_t{-1})
+                          .add(int64_t{1} << 40)
+                          .add(1.5f)
+                          .add(-2.0f)
+                          .add(uint32_t{2})
+                          .add(uint8_t{1})
+                          .add(uint8_t{0})
+                          .add(uint32_t{3})
+                          .add(uint8_t{'a'})
+                          .add(uint8_t{'b'})
+                          .add(uint8_t{'c'})
+                          .data;
+  EXPECT_EQ(expected, serialize(serializer, R"({"name": "a\"bé", "flag": 7,
+                                                "values": [-1, 1099511627776],
+                                                "pair": [1.5, -2], "bools": [true, false],
+                                                "bytes": "YWJj"})"));
+}
+
+TEST(JsonCdrSerializerTest, EmptyMessage) {
+  const foxglove_ws::JsonCdrSerializer serializer("std_msgs/msg/Empty", "");
+  EXPECT_EQ(CdrBuilder().add(uint8_t{0}).data, serialize(serializer, "{}"));
+}
+
+TEST(JsonCdrSerializerTest, InvalidInput) {
+  const foxglove_ws::JsonCdrSerializer serializer("test_msgs/msg/Bounded",
+                                                  "uint8 small\nint32[2] fixed\nstring<=2 name\n");
+  EXPECT_THROW(serialize(serializer, R"({"small": 256})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"fixed": [1]})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"name": "abc"})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"small": 1)"), std::runtime_error);
+  EXPECT_THROW(foxglove_ws::JsonCdrSerializer("test_msgs/msg/Missing", "Unknown field\n"),
+               std::runtime_error);
+}
+
+TEST(JsonCdrSerializerTest, ConstantsAndDefaultValues) {
+  const foxglove_ws::JsonCdrSerializer serializer(
+    "test_msgs/msg/Defaults",
+    "int32 CONSTANT=5\n"
+    "string OTHER_CONSTANT = 'x'\n"
+    "string equals \"a=b\"\n"
+    "string hash 'c#d'  # comment\n"
+    "int32 number 42\n"
+    "bool flag True\n"
+    "float64[] values [1.5, -2]\n"
+    "string[2] names [\"e,f\", 'g']\n");
+  const auto expected = CdrBuilder()
+                          .addString("a=b")
+                          .addString("c#d")
+                          .add(int32_t{7})
+                          .add(uint8_t{1})
+                          .add(uint32_t{2})
+                          .add(1.5)
+                          .add(-2.0)
+                          .addString("e,f")
+                          .addString("g")
+                          .data;
+  EXPECT_EQ(expected, serialize(serializer, R"({"number": 7})"));
+
+  EXPECT_THROW(foxglove_ws::JsonCdrSerializer("test_msgs/msg/Invalid", "uint8 value 256\n"),
+               std::runtime_error);
+  EXPECT_THROW(foxglove_ws::JsonCdrSerializer("test_msgs/msg/Invalid", "int32[] values [1,\n"),
+               std::runtime_error);
+}
+
+TEST(JsonCdrSerializerTest, TrailingData) {
+  const foxglove_ws::JsonCdrSerializer serializer("std_msgs/msg/Empty", "");
+  EXPECT_EQ(CdrBuilder().add(uint8_t{0}).data, serialize(serializer, " {} \n"));
+  EXPECT_THROW(serialize(serializer, "{} {}"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, "{},"), std::runtime_error);
+}
+
+TEST(JsonCdrSerializerTest, UnicodeEscapeSequences) {
+  const foxglove_ws::JsonCdrSerializer serializer("std_msgs/msg/String", "string data\n");
+  EXPECT_EQ(CdrBuilder().addString("\xc3\xa9\xf0\x9f\x98\x80").data,
+            serialize(serializer, R"({"data": "\u00e9\ud83d\ude00"})"));
+  EXPECT_THROW(serialize(serializer, R"({"data": "\ud83d"})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"data": "\ud83dx"})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"data": "\ud83d\u0041"})"), std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"data": "\ude00"})"), std::runtime_error);
+}
+
+TEST(JsonCdrSerializerTest, DeeplyNestedUnknownField) {
+  const foxglove_ws::JsonCdrSerializer serializer("std_msgs/msg/String", "string data\n");
+  const size_t depth = 1000000;
+  const std::string nested = std::string(depth, '[') + std::string(depth, ']');
+  EXPECT_EQ(CdrBuilder().addString("a").data,
+            serialize(serializer, R"({"x": )" + nested + R"(, "data": "a"})"));
+  EXPECT_EQ(CdrBuilder().addString("a").data,
+            serialize(serializer, R"({"data": "a", "x": [{"y": [1, {}]}, []]})"));
+  EXPECT_THROW(serialize(serializer, R"({"x": )" + std::string(depth, '[') + "}"),
+               std::runtime_error);
+  EXPECT_THROW(serialize(serializer, R"({"x": [{"y" 1}]})"), std::runtime_error);
+}
+
+TEST(JsonCdrSerializerTest, CustomOutputBuffer) {
+  // Buffer of fixed capacity, only grown on request like the buffer of a ROS serialized message.
+  class FixedOutputBuffer : public foxglove_ws::JsonCdrSerializer::OutputBuffer {
+  public:
+    uint8_t* data() override {
+      return buffer.data();
+    }
+    size_t capacity() const override {
+      return buffer.size();
+    }
+    void reserve(size_t capacity) override {
+      ++reserveCalls;
+      buffer.resize(capacity);
+    }
+    void finish(size_t size) override {
+      finishedSize = size;
+    }
+
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(8);
+    size_t reserveCalls = 0;
+    size_t finishedSize = 0;
+  };
+
+  const foxglove_ws::JsonCdrSerializer serializer("geometry_msgs/msg/Twist", TWIST_SCHEMA);
+  const auto expected =
+    CdrBuilder().add(1.0).add(2.0).add(3.0).add(-1.0).add(0.5).add(0.0).data;
+  const std::string json =
+    R"({"linear": {"x": 1, "y": 2, "z": 3}, "angular": {"x": -1, "y": 0.5}})";
+  FixedOutputBuffer out;
+  serializer.serialize(json, out);
+  EXPECT_EQ(1u, out.reserveCalls);
+  ASSERT_EQ(expected.size(), out.finishedSize);
+  out.buffer.resize(out.finishedSize);
+  EXPECT_EQ(expected, out.buffer);
+
+  // The buffer is large enough now, so it is written without growing it again.
+  serializer.serialize(json, out);
+  EXPECT_EQ(1u, out.reserveCalls);
+  EXPECT_EQ(expected.size(), out.finishedSize);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
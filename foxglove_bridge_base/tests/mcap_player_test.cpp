@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/mcap_player.hpp>
+#include <foxglove_bridge/mcap_reader.hpp>
+#include <foxglove_bridge/mcap_writer.hpp>
+
+using foxglove_ws::McapPlayer;
+using foxglove_ws::McapReader;
+using foxglove_ws::McapWriter;
+
+namespace {
+
+constexpr auto TIMEOUT = std::chrono::seconds(5);
+constexpr uint64_t MILLISECOND_NS = 1'000'000;
+
+// Records what the player broadcasts, all other operations are not used by the player.
+class FakeServer : public foxglove_ws::ServerInterface<int> {
+public:
+  void start(const std::string&, uint16_t) override {}
+  void stop() override {}
+
+  std::vector<foxglove_ws::ChannelId> addChannels(
+    const std::vector<foxglove_ws::ChannelWithoutId>& channels) override {
+    std::vector<foxglove_ws::ChannelId> channelIds;
+    for (const auto& channel : channels) {
+      topics.push_back(channel.topic);
+      channelIds.push_back(static_cast<foxglove_ws::ChannelId>(topics.size()));
+    }
+    return channelIds;
+  }
+
+  void removeChannels(const std::vector<foxglove_ws::ChannelId>&) override {}
+  void publishParameterValues(int, const std::vector<foxglove_ws::Parameter>&,
+                              const std::optional<std::string>&) override {}
+  void updateParameterValues(const std::vector<foxglove_ws::Parameter>&) override {}
+  std::vector<foxglove_ws::ServiceId> addServices(
+    const std::vector<foxglove_ws::ServiceWithoutId>&) override {
+    return {};
+  }
+  void removeServices(const std::vector<foxglove_ws::ServiceId>&) override {}
+  void setHandlers(foxglove_ws::ServerHandlers<int>&&) override {}
+  void sendMessage(int, foxglove_ws::ChannelId, uint64_t, const uint8_t*, size_t) override {}
+
+  void broadcastMessage(foxglove_ws::ChannelId, uint64_t timestamp, const uint8_t*,
+                        size_t) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    logTimes.push_back(timestamp);
+    cv.notify_all();
+  }
+
+  void broadcastTime(uint64_t) override {}
+  void sendServiceResponse(int, const foxglove_ws::ServiceResponse&) override {}
+  void sendServiceResponse(int, foxglove_ws::ServiceId, uint32_t, const std::string&,
+                           const uint8_t*, size_t) override {}
+  void sendServiceFailure(int, foxglove_ws::ServiceId, uint32_t, const std::string&) override {}
+  void updateConnectionGraph(const foxglove_ws::MapOfSets&, const foxglove_ws::MapOfSets&,
+                             const foxglove_ws::MapOfSets&) override {}
+  void sendFetchAssetResponse(int, const foxglove_ws::FetchAssetResponse&) override {}
+  uint16_t getPort() override {
+    return 0;
+  }
+  std::string remoteEndpointString(int) override {
+    return "";
+  }
+
+  bool waitForMessages(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, TIMEOUT, [&] {
+      return logTimes.size() >= count;
+    });
+  }
+
+  std::vector<std::string> topics;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<uint64_t> logTimes;
+};
+
+std::string tempPath(const std::string& name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);  // Left over by an aborted run
+  return path.string();
+}
+
+// Writes `count` messages on /chatter, `interval` apart.
+void writeFile(const std::string& path, size_t count, uint64_t interval) {
+  McapWriter writer;
+  writer.open(path, "ros2");
+  const uint16_t schemaId = writer.addSchema("std_msgs/msg/String", "ros2msg", "string data");
+  const uint16_t channelId = writer.addChannel(schemaId, "/chatter", "cdr");
+  for (size_t i = 0; i < count; ++i) {
+    const uint8_t payload = static_cast<uint8_t>(i);
+    writer.writeMessage(channelId, static_cast<uint32_t>(i), 1000 + i * interval,
+                        1000 + i * interval, &payload, 1);
+  }
+  writer.close();
+}
+
+}  // namespace
+
+TEST(McapPlayerTest, PlaysBackMessagesInOrder) {
+  const auto path = tempPath("mcap_player_test_order.mcap");
+  writeFile(path, 5, MILLISECOND_NS);
+  McapReader reader;
+  reader.open(path);
+  std::remove(path.c_str());
+
+  FakeServer server;
+  McapPlayer<int> player(server, reader, [](foxglove_ws::WebSocketLogLevel, char const*) {});
+  EXPECT_EQ(std::vector<std::string>({"/chatter"}), server.topics);
+
+  player.start(10.0, false);
+  ASSERT_TRUE(server.waitForMessages(5));
+  player.stop();
+  std::vector<uint64_t> expected;
+  for (uint64_t i = 0; i < 5; ++i) {
+    expected.push_back(1000 + i * MILLISECOND_NS);
+  }
+  EXPECT_EQ(expected, server.logTimes);
+}
+
+TEST(McapPlayerTest, SeeksDuringPlayback) {
+  const auto path = tempPath("mcap_player_test_seek.mcap");
+  const uint64_t interval = 200 * MILLISECOND_NS;
+  writeFile(path, 10, interval);
+  McapReader reader;
+  reader.open(path);
+  std::remove(path.c_str());
+
+  FakeServer server;
+  McapPlayer<int> player(server, reader, [](foxglove_ws::WebSocketLogLevel, char const*) {});
+  player.start(1.0, false);
+  ASSERT_TRUE(server.waitForMessages(1));
+  player.seek(1000 + 8 * interval);
+  ASSERT_TRUE(server.waitForMessages(3));
+  player.stop();
+  EXPECT_EQ(std::vector<uint64_t>({1000, 1000 + 8 * interval, 1000 + 9 * interval}),
+            server.logTimes);
+}
+
+TEST(McapPlayerTest, LogsCorruptData) {
+  const auto path = tempPath("mcap_player_test_corrupt.mcap");
+  writeFile(path, 1, MILLISECOND_NS);
+  {
+    // Shrink the message record to its log time, which is enough to index it when opening the
+    // file but not to play it back.
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), {});
+    const std::vector<char> header = {0x05, 0x17, 0, 0, 0, 0, 0, 0, 0};  // Length 22 + 1 payload
+    const auto it = std::search(bytes.begin(), bytes.end(), header.begin(), header.end());
+    ASSERT_NE(bytes.end(), it);
+    *(it + 1) = 0x0E;
+    const auto recordEnd = it + static_cast<std::ptrdiff_t>(header.size()) + 0x17;
+    bytes.erase(it + static_cast<std::ptrdiff_t>(header.size()) + 0x0E, recordEnd);
+    file.close();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+  McapReader reader;
+  reader.open(path);
+  std::remove(path.c_str());
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::string> errors;
+  FakeServer server;
+  McapPlayer<int> player(server, reader,
+                         [&](foxglove_ws::WebSocketLogLevel level, char const* msg) {
+                           if (level == foxglove_ws::WebSocketLogLevel::Error) {
+                             std::lock_guard<std::mutex> lock(mutex);
+                             errors.push_back(msg);
+                             cv.notify_all();
+                           }
+                         });
+  player.start(1.0, false);
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(cv.wait_for(lock, TIMEOUT, [&] {
+    return !errors.empty();
+  }));
+  EXPECT_EQ(0u, errors.front().rfind("Playback failed", 0));
+  EXPECT_TRUE(server.logTimes.empty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
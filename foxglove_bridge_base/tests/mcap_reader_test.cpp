@@ -0,0 +1,262 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/mcap_reader.hpp>
+#include <foxglove_bridge/mcap_writer.hpp>
+
+using foxglove_ws::McapMessageView;
+using foxglove_ws::McapReader;
+using foxglove_ws::McapWriter;
+
+namespace {
+
+constexpr uint8_t MAGIC[] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+
+// Minimal serializer for records which McapWriter does not write.
+class RecordBuilder {
+public:
+  void uint16(uint16_t value) {
+    uint(value, 2);
+  }
+
+  void uint32(uint32_t value) {
+    uint(value, 4);
+  }
+
+  void uint64(uint64_t value) {
+    uint(value, 8);
+  }
+
+  void string(const std::string& str) {
+    uint32(static_cast<uint32_t>(str.size()));
+    bytes.insert(bytes.end(), str.begin(), str.end());
+  }
+
+  void record(uint8_t opcode, const std::vector<uint8_t>& content) {
+    bytes.push_back(opcode);
+    uint64(content.size());
+    bytes.insert(bytes.end(), content.begin(), content.end());
+  }
+
+  std::vector<uint8_t> bytes;
+
+private:
+  void uint(uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+};
+
+std::vector<uint8_t> messageRecord(uint16_t channelId, uint64_t logTime, uint8_t payload) {
+  RecordBuilder message;
+  message.uint16(channelId);
+  message.uint32(0);
+  message.uint64(logTime);
+  message.uint64(logTime);
+  message.bytes.push_back(payload);
+  RecordBuilder record;
+  record.record(0x05, message.bytes);
+  return record.bytes;
+}
+
+std::vector<uint8_t> chunkRecord(uint64_t startTime, uint64_t endTime,
+                                 const std::vector<uint8_t>& records,
+                                 const std::string& compression = "") {
+  RecordBuilder chunk;
+  chunk.uint64(startTime);
+  chunk.uint64(endTime);
+  chunk.uint64(records.size());
+  chunk.uint32(0);
+  chunk.string(compression);
+  chunk.uint64(records.size());
+  chunk.bytes.insert(chunk.bytes.end(), records.begin(), records.end());
+  return chunk.bytes;
+}
+
+std::vector<uint8_t> chunkIndexRecord(uint64_t startTime, uint64_t endTime, uint64_t offset,
+                                      const std::string& compression = "") {
+  RecordBuilder chunkIndex;
+  chunkIndex.uint64(startTime);
+  chunkIndex.uint64(endTime);
+  chunkIndex.uint64(offset);
+  chunkIndex.uint64(0);  // Chunk length
+  chunkIndex.uint32(0);  // Empty message index offsets
+  chunkIndex.uint64(0);  // Message index length
+  chunkIndex.string(compression);
+  chunkIndex.uint64(0);  // Compressed size
+  chunkIndex.uint64(0);  // Uncompressed size
+  return chunkIndex.bytes;
+}
+
+std::string tempPath(const std::string& name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);  // Left over by an aborted run
+  return path.string();
+}
+
+std::vector<uint64_t> readLogTimes(McapReader& reader, uint64_t startTime = 0) {
+  std::vector<uint64_t> logTimes;
+  auto it = reader.messages(startTime);
+  McapMessageView message;
+  while (it.next(message)) {
+    logTimes.push_back(message.logTime);
+  }
+  return logTimes;
+}
+
+}  // namespace
+
+TEST(McapReaderTest, ReadsUnchunkedFile) {
+  const auto path = tempPath("mcap_reader_test_unchunked.mcap");
+  {
+    McapWriter writer;
+    writer.open(path, "ros2");
+    const auto schemaId = writer.addSchema("std_msgs/msg/String", "ros2msg", "string data");
+    const auto channelId = writer.addChannel(schemaId, "/chatter", "cdr");
+    for (uint8_t i = 0; i < 5; ++i) {
+      writer.writeMessage(channelId, i, 100 + i, 100 + i, &i, sizeof(i));
+    }
+  }
+
+  McapReader reader;
+  reader.open(path);
+  std::remove(path.c_str());  // The mapping stays valid
+
+  ASSERT_EQ(1u, reader.schemas().size());
+  EXPECT_EQ("std_msgs/msg/String", reader.schemas().begin()->second.name);
+  EXPECT_EQ("string data", reader.schemas().begin()->second.data);
+  ASSERT_EQ(1u, reader.channels().size());
+  EXPECT_EQ("/chatter", reader.channels().begin()->second.topic);
+  EXPECT_EQ(reader.schemas().begin()->first, reader.channels().begin()->second.schemaId);
+  EXPECT_EQ(100u, reader.startTime());
+  EXPECT_EQ(104u, reader.endTime());
+
+  auto it = reader.messages(102);
+  McapMessageView message;
+  for (uint8_t i = 2; i < 5; ++i) {
+    ASSERT_TRUE(it.next(message));
+    EXPECT_EQ(100u + i, message.logTime);
+    EXPECT_EQ(i, message.sequence);
+    ASSERT_EQ(1u, message.size);
+    EXPECT_EQ(i, message.data[0]);
+  }
+  EXPECT_FALSE(it.next(message));
+}
+
+TEST(McapReaderTest, MergesOverlappingChunksUsingSummary) {
+  RecordBuilder file;
+  file.bytes.assign(std::begin(MAGIC), std::end(MAGIC));
+  RecordBuilder header;
+  header.string("");
+  header.string("");
+  file.record(0x01, header.bytes);
+
+  RecordBuilder channel;
+  channel.uint16(3);
+  channel.uint16(0);
+  channel.string("/topic");
+  channel.string("json");
+  channel.uint32(0);
+
+  // The first chunk has unordered messages, the second one overlaps with it.
+  std::vector<uint8_t> firstRecords = messageRecord(3, 30, 'c');
+  for (const auto& record : {messageRecord(3, 10, 'a'), messageRecord(3, 40, 'd')}) {
+    firstRecords.insert(firstRecords.end(), record.begin(), record.end());
+  }
+  const uint64_t firstChunkOffset = file.bytes.size();
+  file.record(0x06, chunkRecord(10, 40, firstRecords));
+  const uint64_t secondChunkOffset = file.bytes.size();
+  file.record(0x06, chunkRecord(20, 20, messageRecord(3, 20, 'b')));
+  file.record(0x0F, std::vector<uint8_t>(4, 0));
+
+  const uint64_t summaryStart = file.bytes.size();
+  file.record(0x04, channel.bytes);
+  file.record(0x08, chunkIndexRecord(20, 20, secondChunkOffset));
+  file.record(0x08, chunkIndexRecord(10, 40, firstChunkOffset));
+
+  RecordBuilder footer;
+  footer.uint64(summaryStart);
+  footer.uint64(0);
+  footer.uint32(0);
+  file.record(0x02, footer.bytes);
+  file.bytes.insert(file.bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+
+  const auto path = tempPath("mcap_reader_test_chunked.mcap");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(file.bytes.data()),
+              static_cast<std::streamsize>(file.bytes.size()));
+  }
+
+  McapReader reader;
+  reader.open(path);
+  std::remove(path.c_str());
+
+  ASSERT_EQ(1u, reader.channels().size());
+  EXPECT_EQ("json", reader.channels().at(3).messageEncoding);
+  EXPECT_EQ(10u, reader.startTime());
+  EXPECT_EQ(40u, reader.endTime());
+  EXPECT_EQ(std::vector<uint64_t>({10, 20, 30, 40}), readLogTimes(reader));
+  EXPECT_EQ(std::vector<uint64_t>({30, 40}), readLogTimes(reader, 25));
+  EXPECT_TRUE(readLogTimes(reader, 41).empty());
+}
+
+TEST(McapReaderTest, ThrowsOnInvalidFile) {
+  const auto path = tempPath("mcap_reader_test_invalid.mcap");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << std::string(100, 'x');
+  }
+
+  McapReader reader;
+  EXPECT_THROW(reader.open(path), std::runtime_error);
+  std::remove(path.c_str());
+  EXPECT_THROW(reader.open("/nonexistent_directory/file.mcap"), std::runtime_error);
+}
+
+TEST(McapReaderTest, RejectsUnsupportedCompression) {
+  for (const bool withSummary : {true, false}) {
+    RecordBuilder file;
+    file.bytes.assign(std::begin(MAGIC), std::end(MAGIC));
+    RecordBuilder header;
+    header.string("");
+    header.string("");
+    file.record(0x01, header.bytes);
+    const uint64_t chunkOffset = file.bytes.size();
+    file.record(0x06, chunkRecord(10, 10, messageRecord(1, 10, 'a'), "brotli"));
+    file.record(0x0F, std::vector<uint8_t>(4, 0));
+
+    const uint64_t summaryStart = file.bytes.size();
+    if (withSummary) {
+      file.record(0x08, chunkIndexRecord(10, 10, chunkOffset, "brotli"));
+    }
+    RecordBuilder footer;
+    footer.uint64(withSummary ? summaryStart : 0);
+    footer.uint64(0);
+    footer.uint32(0);
+    file.record(0x02, footer.bytes);
+    file.bytes.insert(file.bytes.end(), std::begin(MAGIC), std::end(MAGIC));
+
+    const auto path = tempPath("mcap_reader_test_compression.mcap");
+    {
+      std::ofstream out(path, std::ios::binary);
+      out.write(reinterpret_cast<const char*>(file.bytes.data()),
+                static_cast<std::streamsize>(file.bytes.size()));
+    }
+
+    McapReader reader;
+    EXPECT_THROW(reader.open(path), std::runtime_error) << "withSummary: " << withSummary;
+    std::remove(path.c_str());
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/mcap_writer.hpp>
+
+using foxglove_ws::McapWriter;
+
+namespace {
+
+constexpr uint8_t MAGIC[] = {0x89, 'M', 'C', 'A', 'P', '0', '\r', '\n'};
+
+struct Record {
+  uint8_t opcode;
+  std::vector<uint8_t> content;
+};
+
+uint64_t readUint(const uint8_t* data, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Split the file into records, checking the leading and trailing magic.
+std::vector<Record> readRecords(const std::vector<uint8_t>& file) {
+  std::vector<Record> records;
+  EXPECT_GE(file.size(), 2 * sizeof(MAGIC));
+  EXPECT_TRUE(std::equal(std::begin(MAGIC), std::end(MAGIC), file.begin()));
+  EXPECT_TRUE(std::equal(std::begin(MAGIC), std::end(MAGIC), file.end() - sizeof(MAGIC)));
+
+  size_t offset = sizeof(MAGIC);
+  while (offset + 9 <= file.size() - sizeof(MAGIC)) {
+    const uint8_t opcode = file[offset];
+    const uint64_t length = readUint(&file[offset + 1], 8);
+    offset += 9;
+    EXPECT_LE(offset + length, file.size() - sizeof(MAGIC));
+    records.push_back({opcode, {file.begin() + offset, file.begin() + offset + length}});
+    offset += length;
+  }
+  EXPECT_EQ(offset, file.size() - sizeof(MAGIC));
+  return records;
+}
+
+std::string tempPath(const std::string& name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);  // Left over by an aborted run
+  return path.string();
+}
+
+}  // namespace
+
+TEST(McapWriterTest, WritesRecordsInOrder) {
+  const auto path = tempPath("mcap_writer_test_records.mcap");
+  const std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+  {
+    McapWriter writer;
+    writer.open(path, "ros2");
+    const auto schemaId = writer.addSchema("std_msgs/msg/String", "ros2msg", "string data");
+    EXPECT_NE(0, schemaId);
+    const auto channelId = writer.addChannel(schemaId, "/chatter", "cdr");
+    writer.writeMessage(channelId, 7, 1000, 900, payload.data(), payload.size());
+    writer.close();
+  }
+
+  const auto records = readRecords(readFile(path));
+  std::remove(path.c_str());
+  ASSERT_EQ(6u, records.size());
+  EXPECT_EQ(0x01, records[0].opcode);  // Header
+  EXPECT_EQ(0x03, records[1].opcode);  // Schema
+  EXPECT_EQ(0x04, records[2].opcode);  // Channel
+  EXPECT_EQ(0x05, records[3].opcode);  // Message
+  EXPECT_EQ(0x0F, records[4].opcode);  // Data end
+  EXPECT_EQ(0x02, records[5].opcode);  // Footer
+
+  const auto& header = records[0].content;
+  ASSERT_GE(header.size(), 8u);
+  EXPECT_EQ(4u, readUint(header.data(), 4));
+  EXPECT_EQ("ros2", std::string(header.begin() + 4, header.begin() + 8));
+
+  const auto& message = records[3].content;
+  ASSERT_EQ(2 + 4 + 8 + 8 + payload.size(), message.size());
+  EXPECT_EQ(0u, readUint(&message[0], 2));
+  EXPECT_EQ(7u, readUint(&message[2], 4));
+  EXPECT_EQ(1000u, readUint(&message[6], 8));
+  EXPECT_EQ(900u, readUint(&message[14], 8));
+  EXPECT_TRUE(std::equal(payload.begin(), payload.end(), message.begin() + 22));
+}
+
+TEST(McapWriterTest, WritesMessagesLargerThanBuffer) {
+  const auto path = tempPath("mcap_writer_test_large.mcap");
+  std::vector<uint8_t> payload(1000);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  {
+    McapWriter writer(64);
+    writer.open(path, "ros2");
+    const auto channelId = writer.addChannel(0, "/large", "cdr");
+    for (uint32_t i = 0; i < 3; ++i) {
+      writer.writeMessage(channelId, i, i, i, payload.data(), payload.size());
+    }
+  }  // Closed by the destructor
+
+  const auto records = readRecords(readFile(path));
+  std::remove(path.c_str());
+  ASSERT_EQ(7u, records.size());
+  for (size_t i = 2; i < 5; ++i) {
+    ASSERT_EQ(0x05, records[i].opcode);
+    EXPECT_EQ(i - 2, readUint(&records[i].content[2], 4));
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(), records[i].content.begin() + 22));
+  }
+}
+
+TEST(McapWriterTest, ThrowsIfFileCanNotBeCreated) {
+  McapWriter writer;
+  EXPECT_THROW(writer.open("/nonexistent_directory/file.mcap", "ros2"), std::runtime_error);
+}
+
+TEST(McapWriterTest, DoesNotOverwriteExistingFile) {
+  const auto path = tempPath("mcap_writer_test_existing.mcap");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "existing";
+  }
+  McapWriter writer;
+  EXPECT_THROW(writer.open(path, "ros2"), std::runtime_error);
+  std::ifstream in(path, std::ios::binary);
+  EXPECT_EQ("existing", std::string(std::istreambuf_iterator<char>(in), {}));
+  std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
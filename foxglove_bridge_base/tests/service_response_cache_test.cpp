@@ -0,0 +1,104 @@
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/service_response_cache.hpp>
+
+using namespace std::chrono_literals;
+using foxglove_ws::ServiceResponseCache;
+
+namespace {
+
+ServiceResponseCache::Response makeResponse(std::vector<uint8_t> data) {
+  return std::make_shared<const std::vector<uint8_t>>(std::move(data));
+}
+
+}  // namespace
+
+TEST(ServiceResponseCacheTest, CoalescesIdenticalCallsInFlight) {
+  ServiceResponseCache cache;
+  const auto now = ServiceResponseCache::Clock::now();
+  const std::vector<uint8_t> request = {1, 2, 3};
+
+  const auto first = cache.lookup(1, request, 10, now);
+  EXPECT_FALSE(first.response);
+  EXPECT_FALSE(first.inFlightCall);
+
+  const auto second = cache.lookup(1, request, 11, now);
+  EXPECT_FALSE(second.response);
+  ASSERT_TRUE(second.inFlightCall);
+  EXPECT_EQ(10u, *second.inFlightCall);
+
+  // Other requests and other services are not coalesced.
+  EXPECT_FALSE(cache.lookup(1, {1, 2}, 12, now).inFlightCall);
+  EXPECT_FALSE(cache.lookup(2, request, 13, now).inFlightCall);
+
+  EXPECT_EQ(1u, cache.statistics().coalesced);
+  EXPECT_EQ(3u, cache.statistics().misses);
+}
+
+TEST(ServiceResponseCacheTest, ServesResponsesUntilExpiry) {
+  ServiceResponseCache cache;
+  const auto now = ServiceResponseCache::Clock::now();
+  const std::vector<uint8_t> request = {1, 2, 3};
+
+  cache.lookup(1, request, 10, now);
+  cache.complete(10, makeResponse({4, 5}), now + 1s);
+
+  const auto hit = cache.lookup(1, request, 11, now + 500ms);
+  ASSERT_TRUE(hit.response);
+  EXPECT_EQ(std::vector<uint8_t>({4, 5}), *hit.response);
+  EXPECT_EQ(1u, cache.statistics().hits);
+
+  const auto expired = cache.lookup(1, request, 12, now + 1s);
+  EXPECT_FALSE(expired.response);
+  EXPECT_FALSE(expired.inFlightCall);
+  EXPECT_EQ(2u, cache.statistics().misses);
+
+  // The expired entry is kept as long as the new call is in flight.
+  cache.removeExpired(now + 2s);
+  EXPECT_EQ(1u, cache.size());
+  cache.complete(12, makeResponse({6}), now + 2s);
+  cache.removeExpired(now + 2s);
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(ServiceResponseCacheTest, AbandonedCallsAreForgotten) {
+  ServiceResponseCache cache;
+  const auto now = ServiceResponseCache::Clock::now();
+  const std::vector<uint8_t> request = {1};
+
+  cache.lookup(1, request, 10, now);
+  cache.abandon(10);
+  EXPECT_EQ(0u, cache.size());
+
+  const auto retry = cache.lookup(1, request, 11, now);
+  EXPECT_FALSE(retry.inFlightCall);
+  // Completing or abandoning an unknown call is a no-op.
+  cache.complete(10, makeResponse({2}), now + 1s);
+  cache.abandon(12);
+  EXPECT_FALSE(cache.lookup(1, request, 13, now).response);
+}
+
+TEST(ServiceResponseCacheTest, RemovesResponsesOfService) {
+  ServiceResponseCache cache;
+  const auto now = ServiceResponseCache::Clock::now();
+
+  cache.lookup(1, {1}, 10, now);
+  cache.complete(10, makeResponse({2}), now + 1s);
+  cache.lookup(1, {2}, 11, now);
+  cache.lookup(2, {1}, 12, now);
+  cache.complete(12, makeResponse({3}), now + 1s);
+
+  cache.removeService(1);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_FALSE(cache.lookup(1, {1}, 13, now).response);
+  EXPECT_TRUE(cache.lookup(2, {1}, 14, now).response);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
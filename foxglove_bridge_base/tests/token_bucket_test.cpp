@@ -0,0 +1,54 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <foxglove_bridge/token_bucket.hpp>
+
+using namespace std::chrono_literals;
+using foxglove_ws::TokenBucket;
+
+TEST(TokenBucketTest, StartsFull) {
+  const auto start = TokenBucket::Clock::now();
+  TokenBucket bucket(100.0, 50.0, start);
+  EXPECT_TRUE(bucket.tryConsume(30.0, start));
+  EXPECT_TRUE(bucket.tryConsume(20.0, start));
+  EXPECT_FALSE(bucket.tryConsume(1.0, start));
+}
+
+TEST(TokenBucketTest, RefillsOverTime) {
+  const auto start = TokenBucket::Clock::now();
+  TokenBucket bucket(100.0, 50.0, start);
+  EXPECT_TRUE(bucket.tryConsume(50.0, start));
+  EXPECT_FALSE(bucket.tryConsume(20.0, start + 100ms));
+  EXPECT_TRUE(bucket.tryConsume(20.0, start + 200ms));
+  // Refill is capped at the bucket capacity.
+  EXPECT_TRUE(bucket.tryConsume(50.0, start + 10s));
+  EXPECT_FALSE(bucket.tryConsume(1.0, start + 10s));
+}
+
+TEST(TokenBucketTest, FullBucketGrantsOversizedRequest) {
+  const auto start = TokenBucket::Clock::now();
+  TokenBucket bucket(100.0, 50.0, start);
+  EXPECT_TRUE(bucket.tryConsume(150.0, start));
+  // The resulting debt has to be paid off before further requests are granted.
+  EXPECT_FALSE(bucket.tryConsume(1.0, start + 1s));
+  EXPECT_TRUE(bucket.tryConsume(1.0, start + 1010ms));
+}
+
+TEST(TokenBucketTest, RefundReturnsTokens) {
+  const auto start = TokenBucket::Clock::now();
+  TokenBucket bucket(100.0, 50.0, start);
+  EXPECT_TRUE(bucket.tryConsume(50.0, start));
+  bucket.refund(20.0);
+  EXPECT_TRUE(bucket.tryConsume(20.0, start));
+  EXPECT_FALSE(bucket.tryConsume(1.0, start));
+  // Refunds are capped at the bucket capacity.
+  bucket.refund(100.0);
+  EXPECT_TRUE(bucket.tryConsume(50.0, start));
+  EXPECT_FALSE(bucket.tryConsume(1.0, start));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,6 +7,7 @@
 #include <xmlrpcpp/XmlRpc.h>
 
 #include <foxglove_bridge/parameter.hpp>
+#include <foxglove_bridge/server_interface.hpp>
 
 namespace foxglove_bridge {
 
@@ -15,4 +16,13 @@ XmlRpc::XmlRpcValue toRosParam(const foxglove_ws::ParameterValue& param);
 
 std::vector<std::regex> parseRegexPatterns(const std::vector<std::string>& strings);
 
+std::vector<foxglove_ws::ClientBandwidthQuota> parseClientBandwidthQuotas(
+  const std::vector<std::string>& specs);
+
+std::vector<foxglove_ws::ChannelPriority> parseChannelPriorities(
+  const std::vector<std::string>& specs);
+
+std::vector<foxglove_ws::ClientPublishLimit> parseClientPublishLimits(
+  const std::vector<std::string>& rateSpecs, const std::vector<std::string>& bandwidthSpecs);
+
 }  // namespace foxglove_bridge
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace foxglove_bridge {
 
@@ -12,4 +17,32 @@ namespace foxglove_bridge {
 std::string retrieveServiceType(const std::string& serviceName,
                                 std::chrono::milliseconds timeout_ms);
 
+/**
+ * Retrieves the types of many services, probing several service servers concurrently. Retrieved
+ * types are cached by service name and service server address. The address is looked up on the
+ * master on every call, so that only services that are new or have moved to another server (e.g.
+ * because their node was restarted) are probed again.
+ */
+class ServiceTypeRetriever {
+public:
+  using ErrorCallback =
+    std::function<void(const std::string& serviceName, const std::string& error)>;
+
+  /**
+   * @param serviceNames All services that currently exist. Cached types of other services are
+   * dropped.
+   * @param maxConcurrentProbes Maximum number of service servers probed at the same time.
+   * @return Types by service name. Services whose type could not be retrieved are missing, and
+   * reported to `onError` from the calling thread.
+   */
+  std::unordered_map<std::string, std::string> retrieve(
+    const std::vector<std::string>& serviceNames, std::chrono::milliseconds timeout,
+    size_t maxConcurrentProbes, const ErrorCallback& onError);
+
+private:
+  std::mutex _mutex;
+  /// Server address ("host:port") and type by service name.
+  std::unordered_map<std::string, std::pair<std::string, std::string>> _cache;
+};
+
 }  // namespace foxglove_bridge
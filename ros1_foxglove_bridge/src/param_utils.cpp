@@ -2,7 +2,10 @@
 #include <iostream>
 #include <stdexcept>
 
+#include <ros/console.h>
+
 #include <foxglove_bridge/param_utils.hpp>
+#include <foxglove_bridge/regex_utils.hpp>
 
 namespace foxglove_bridge {
 
@@ -85,4 +88,71 @@ std::vector<std::regex> parseRegexPatterns(const std::vector<std::string>& patte
   return result;
 }
 
+std::vector<foxglove_ws::ClientBandwidthQuota> parseClientBandwidthQuotas(
+  const std::vector<std::string>& specs) {
+  std::vector<foxglove_ws::ClientBandwidthQuota> result;
+  for (const auto& spec : specs) {
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientBandwidthQuota quota;
+      quota.clientGroupPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      quota.bytesPerSecond = std::stoul(value);
+      result.push_back(std::move(quota));
+    } catch (const std::exception& ex) {
+      ROS_ERROR("Ignoring invalid client bandwidth quota '%s': %s", spec.c_str(), ex.what());
+    }
+  }
+  return result;
+}
+
+std::vector<foxglove_ws::ChannelPriority> parseChannelPriorities(
+  const std::vector<std::string>& specs) {
+  std::vector<foxglove_ws::ChannelPriority> result;
+  for (const auto& spec : specs) {
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ChannelPriority priority;
+      priority.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      priority.priority = std::stoi(value);
+      result.push_back(std::move(priority));
+    } catch (const std::exception& ex) {
+      ROS_ERROR("Ignoring invalid topic priority '%s': %s", spec.c_str(), ex.what());
+    }
+  }
+  return result;
+}
+
+std::vector<foxglove_ws::ClientPublishLimit> parseClientPublishLimits(
+  const std::vector<std::string>& rateSpecs, const std::vector<std::string>& bandwidthSpecs) {
+  std::vector<foxglove_ws::ClientPublishLimit> result;
+  for (const auto& spec : rateSpecs) {
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientPublishLimit limit;
+      limit.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      limit.messagesPerSecond = std::stod(value);
+      result.push_back(std::move(limit));
+    } catch (const std::exception& ex) {
+      ROS_ERROR("Ignoring invalid client publish rate limit '%s': %s", spec.c_str(), ex.what());
+    }
+  }
+  for (const auto& spec : bandwidthSpecs) {
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientPublishLimit limit;
+      limit.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      limit.bytesPerSecond = std::stoul(value);
+      result.push_back(std::move(limit));
+    } catch (const std::exception& ex) {
+      ROS_ERROR("Ignoring invalid client publish bandwidth limit '%s': %s", spec.c_str(),
+                ex.what());
+    }
+  }
+  return result;
+}
+
 }  // namespace foxglove_bridge
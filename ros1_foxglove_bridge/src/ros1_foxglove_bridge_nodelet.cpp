@@ -1,7 +1,10 @@
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <regex>
 #include <shared_mutex>
 #include <string>
@@ -48,7 +51,12 @@ constexpr uint32_t SUBSCRIPTION_QUEUE_LENGTH = 10;
 constexpr double MIN_UPDATE_PERIOD_MS = 100.0;
 constexpr uint32_t PUBLICATION_QUEUE_LENGTH = 10;
 constexpr int DEFAULT_SERVICE_TYPE_RETRIEVAL_TIMEOUT_MS = 250;
+constexpr int DEFAULT_SERVICE_TYPE_RETRIEVAL_CONCURRENCY = 16;
 constexpr int MAX_INVALID_PARAMS_TRACKED = 1000;
+constexpr double DEFAULT_TIME_BROADCAST_RATE = 60.0;
+constexpr int DEFAULT_SERVICE_CALL_THREADS = 4;
+constexpr double DEFAULT_SERVICE_CALL_TIMEOUT = 5.0;
+constexpr int DEFAULT_MAX_QUEUED_SERVICE_CALLS = 64;
 
 using ConnectionHandle = websocketpp::connection_hdl;
 using TopicAndDatatype = std::pair<std::string, std::string>;
@@ -78,6 +86,17 @@ public:
                                                foxglove_ws::DEFAULT_CAPABILITIES.end()));
     _serviceRetrievalTimeoutMs = nhp.param<int>("service_type_retrieval_timeout_ms",
                                                 DEFAULT_SERVICE_TYPE_RETRIEVAL_TIMEOUT_MS);
+    _serviceRetrievalConcurrency = static_cast<size_t>(std::max(
+      1, nhp.param<int>("service_type_retrieval_concurrency",
+                        DEFAULT_SERVICE_TYPE_RETRIEVAL_CONCURRENCY)));
+    const auto timeBroadcastRate =
+      nhp.param<double>("time_broadcast_rate", DEFAULT_TIME_BROADCAST_RATE);
+    const auto serviceCallThreads = static_cast<size_t>(
+      std::max(1, nhp.param<int>("service_call_threads", DEFAULT_SERVICE_CALL_THREADS)));
+    _serviceCallTimeout = std::chrono::duration<double>(
+      nhp.param<double>("service_call_timeout", DEFAULT_SERVICE_CALL_TIMEOUT));
+    _maxQueuedServiceCalls = static_cast<size_t>(
+      std::max(1, nhp.param<int>("max_queued_service_calls", DEFAULT_MAX_QUEUED_SERVICE_CALLS)));
 
     const auto topicWhitelistPatterns =
       nhp.param<std::vector<std::string>>("topic_whitelist", {".*"});
@@ -113,6 +132,39 @@ public:
       ROS_ERROR("Failed to parse one or more asset URI whitelist patterns");
     }
 
+    const auto clientBandwidthLimit =
+      static_cast<size_t>(nhp.param<double>("client_bandwidth_limit", 0.0));
+    const auto clientBandwidthBurst =
+      static_cast<size_t>(nhp.param<double>("client_bandwidth_burst", 0.0));
+    const auto clientBandwidthGroups =
+      nhp.param<std::vector<std::string>>("client_bandwidth_groups", {});
+    const auto clientBandwidthQuotas = parseClientBandwidthQuotas(clientBandwidthGroups);
+    if (clientBandwidthGroups.size() != clientBandwidthQuotas.size()) {
+      ROS_ERROR("Failed to parse one or more client bandwidth groups");
+    }
+
+    const auto globalSendBufferLimit =
+      static_cast<size_t>(nhp.param<double>("global_send_buffer_limit", 0.0));
+    const auto egressCpuBudget = nhp.param<double>("egress_cpu_budget", 0.0);
+    const auto parameterUpdateInterval =
+      static_cast<size_t>(std::max(0, nhp.param<int>("parameter_update_interval_ms", 0)));
+    const auto topicPriorities = nhp.param<std::vector<std::string>>("topic_priorities", {});
+    const auto channelPriorities = parseChannelPriorities(topicPriorities);
+    if (topicPriorities.size() != channelPriorities.size()) {
+      ROS_ERROR("Failed to parse one or more topic priorities");
+    }
+
+    const auto clientPublishRateLimits =
+      nhp.param<std::vector<std::string>>("client_publish_rate_limits", {});
+    const auto clientPublishBandwidthLimits =
+      nhp.param<std::vector<std::string>>("client_publish_bandwidth_limits", {});
+    const auto clientPublishLimits =
+      parseClientPublishLimits(clientPublishRateLimits, clientPublishBandwidthLimits);
+    if (clientPublishRateLimits.size() + clientPublishBandwidthLimits.size() !=
+        clientPublishLimits.size()) {
+      ROS_ERROR("Failed to parse one or more client publish limits");
+    }
+
     const char* rosDistro = std::getenv("ROS_DISTRO");
     ROS_INFO("Starting foxglove_bridge (%s, %s@%s) with %s", rosDistro,
              foxglove::FOXGLOVE_BRIDGE_VERSION, foxglove::FOXGLOVE_BRIDGE_GIT_HASH,
@@ -133,6 +185,14 @@ public:
       serverOptions.keyfile = keyfile;
       serverOptions.useCompression = useCompression;
       serverOptions.clientTopicWhitelistPatterns = clientTopicWhitelistPatterns;
+      serverOptions.clientBandwidthLimitBytesPerSec = clientBandwidthLimit;
+      serverOptions.clientBandwidthBurstBytes = clientBandwidthBurst;
+      serverOptions.clientBandwidthQuotas = clientBandwidthQuotas;
+      serverOptions.globalSendBufferLimitBytes = globalSendBufferLimit;
+      serverOptions.egressCpuBudget = egressCpuBudget;
+      serverOptions.parameterUpdateIntervalMs = parameterUpdateInterval;
+      serverOptions.channelPriorities = channelPriorities;
+      serverOptions.clientPublishLimits = clientPublishLimits;
 
       const auto logHandler =
         std::bind(&FoxgloveBridge::logHandler, this, std::placeholders::_1, std::placeholders::_2);
@@ -140,6 +200,10 @@ public:
       // Fetching of assets may be blocking, hence we fetch them in a separate thread.
       _fetchAssetQueue =
         std::make_unique<foxglove_ws::CallbackQueue>(logHandler, 1 /* num_threads */);
+      // Service calls block until the service has responded, hence they are made by a pool of
+      // threads so that calls to slow services do not hold up other calls and client requests.
+      _serviceCallQueue =
+        std::make_unique<foxglove_ws::CallbackQueue>(logHandler, serviceCallThreads);
 
       _server = foxglove_ws::ServerFactory::createServer<ConnectionHandle>(
         "foxglove_bridge", logHandler, serverOptions);
@@ -187,7 +251,30 @@ public:
 
       updateAdvertisedTopicsAndServices(ros::TimerEvent());
 
-      if (_useSimTime) {
+      if (_serviceCallTimeout.count() > 0.0) {
+        _serviceCallTimeoutTimer = getMTNodeHandle().createWallTimer(
+          ros::WallDuration(std::max(0.01, _serviceCallTimeout.count() / 10.0)),
+          [this](const ros::WallTimerEvent&) {
+            abortTimedOutServiceCalls();
+          });
+      }
+
+      if (_useSimTime && timeBroadcastRate > 0.0) {
+        // Only remember the latest time and broadcast it at a fixed rate, so that the
+        // broadcasting cost does not depend on the /clock rate.
+        _clockSubscription = getMTNodeHandle().subscribe<rosgraph_msgs::Clock>(
+          "/clock", 10, [&](const rosgraph_msgs::Clock::ConstPtr msg) {
+            _latestClockTime = msg->clock.toNSec();
+          });
+        _timeBroadcastTimer = getMTNodeHandle().createWallTimer(
+          ros::WallDuration(1.0 / timeBroadcastRate), [this](const ros::WallTimerEvent&) {
+            const uint64_t timestamp = _latestClockTime;
+            if (timestamp != _lastBroadcastedClockTime) {
+              _lastBroadcastedClockTime = timestamp;
+              _server->broadcastTime(timestamp);
+            }
+          });
+      } else if (_useSimTime) {
         _clockSubscription = getMTNodeHandle().subscribe<rosgraph_msgs::Clock>(
           "/clock", 10, [&](const rosgraph_msgs::Clock::ConstPtr msg) {
             _server->broadcastTime(msg->clock.toNSec());
@@ -204,6 +291,18 @@ public:
     if (_server) {
       _server->stop();
     }
+    // Dropping the connections makes calls to hung services return, so that the service call
+    // threads can be joined before the connection pool they use is destroyed.
+    _serviceCallTimeoutTimer.stop();
+    {
+      std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+      _serviceClientsShutdown = true;
+      for (auto& busyClient : _busyServiceClients) {
+        busyClient.client.shutdown();
+      }
+      _idleServiceClients.clear();
+    }
+    _serviceCallQueue.reset();
   }
 
 private:
@@ -601,23 +700,64 @@ private:
       }
     }
     for (auto serviceId : servicesToRemove) {
+      removeIdleServiceClients(_advertisedServices.at(serviceId).name);
       _advertisedServices.erase(serviceId);
     }
     _server->removeServices(servicesToRemove);
 
-    // Advertise new services
-    std::vector<foxglove_ws::ServiceWithoutId> newServices;
+    // Advertise new services. Advertised services are only modified by graph updates, which never
+    // run concurrently, so the lock is released while retrieving the types of new services.
+    std::unordered_map<std::string, std::pair<foxglove_ws::ServiceId, std::string>>
+      advertisedServiceTypes;
+    for (const auto& [serviceId, service] : _advertisedServices) {
+      advertisedServiceTypes.emplace(service.name, std::make_pair(serviceId, service.type));
+    }
+    std::vector<std::string> newServiceNames;
     for (const auto& serviceName : serviceNames) {
-      if (std::find_if(_advertisedServices.begin(), _advertisedServices.end(),
-                       [&serviceName](const auto& idWithService) {
-                         return idWithService.second.name == serviceName;
-                       }) != _advertisedServices.end()) {
-        continue;  // Already advertised
+      if (advertisedServiceTypes.find(serviceName) == advertisedServiceTypes.end()) {
+        newServiceNames.push_back(serviceName);
       }
+    }
+    lock.unlock();
+
+    // Advertised services are retrieved again as well. They are only probed if their server
+    // address changed, e.g. because their node was restarted, possibly with another service type.
+    const std::unordered_set<std::string> newServiceNameSet(newServiceNames.begin(),
+                                                            newServiceNames.end());
+    const auto serviceTypes = _serviceTypeRetriever.retrieve(
+      serviceNames, std::chrono::milliseconds(_serviceRetrievalTimeoutMs),
+      _serviceRetrievalConcurrency,
+      [&newServiceNameSet](const std::string& serviceName, const std::string& error) {
+        if (newServiceNameSet.find(serviceName) != newServiceNameSet.end()) {
+          ROS_ERROR("Failed to retrieve service type or service description of service %s: %s",
+                    serviceName.c_str(), error.c_str());
+        } else {
+          ROS_DEBUG("Failed to look up advertised service %s: %s", serviceName.c_str(),
+                    error.c_str());
+        }
+      });
+
+    // Services whose type changed are advertised again with their new type.
+    std::vector<foxglove_ws::ServiceId> changedServiceIds;
+    for (const auto& [serviceName, idAndType] : advertisedServiceTypes) {
+      const auto typeIt = serviceTypes.find(serviceName);
+      if (typeIt != serviceTypes.end() && typeIt->second != idAndType.second) {
+        ROS_INFO("Type of service %s changed from %s to %s, advertising it again",
+                 serviceName.c_str(), idAndType.second.c_str(), typeIt->second.c_str());
+        changedServiceIds.push_back(idAndType.first);
+        newServiceNames.push_back(serviceName);
+      }
+    }
+
+    std::vector<foxglove_ws::ServiceWithoutId> newServices;
+    for (const auto& serviceName : newServiceNames) {
+      const auto typeIt = serviceTypes.find(serviceName);
+      if (typeIt == serviceTypes.end()) {
+        continue;
+      }
+      const auto& serviceType = typeIt->second;
 
       try {
-        const auto serviceType =
-          retrieveServiceType(serviceName, std::chrono::milliseconds(_serviceRetrievalTimeoutMs));
         const auto srvDescription = _rosTypeInfoProvider.getServiceDescription(serviceType);
 
         foxglove_ws::ServiceWithoutId service;
@@ -643,6 +783,14 @@ private:
       }
     }
 
+    lock.lock();
+    if (!changedServiceIds.empty()) {
+      for (auto serviceId : changedServiceIds) {
+        removeIdleServiceClients(_advertisedServices.at(serviceId).name);
+        _advertisedServices.erase(serviceId);
+      }
+      _server->removeServices(changedServiceIds);
+    }
     const auto serviceIds = _server->addServices(newServices);
     for (size_t i = 0; i < serviceIds.size(); ++i) {
       _advertisedServices.emplace(serviceIds[i], newServices[i]);
@@ -851,24 +999,22 @@ private:
   }
 
   void serviceRequest(const foxglove_ws::ServiceRequest& request, ConnectionHandle clientHandle) {
-    std::shared_lock<std::shared_mutex> lock(_servicesMutex);
-    const auto serviceIt = _advertisedServices.find(request.serviceId);
-    if (serviceIt == _advertisedServices.end()) {
-      const auto errMsg =
-        "Service with id " + std::to_string(request.serviceId) + " does not exist";
-      ROS_ERROR_STREAM(errMsg);
-      throw foxglove_ws::ServiceError(request.serviceId, errMsg);
+    std::string serviceName, serviceType;
+    {
+      std::shared_lock<std::shared_mutex> lock(_servicesMutex);
+      const auto serviceIt = _advertisedServices.find(request.serviceId);
+      if (serviceIt == _advertisedServices.end()) {
+        const auto errMsg =
+          "Service with id " + std::to_string(request.serviceId) + " does not exist";
+        ROS_ERROR_STREAM(errMsg);
+        throw foxglove_ws::ServiceError(request.serviceId, errMsg);
+      }
+      serviceName = serviceIt->second.name;
+      serviceType = serviceIt->second.type;
     }
-    const auto& serviceName = serviceIt->second.name;
-    const auto& serviceType = serviceIt->second.type;
     ROS_DEBUG("Received a service request for service %s (%s)", serviceName.c_str(),
               serviceType.c_str());
 
-    if (!ros::service::exists(serviceName, false)) {
-      throw foxglove_ws::ServiceError(request.serviceId,
-                                      "Service '" + serviceName + "' does not exist");
-    }
-
     const auto srvDescription = _rosTypeInfoProvider.getServiceDescription(serviceType);
     if (!srvDescription) {
       const auto errMsg =
@@ -877,21 +1023,146 @@ private:
       throw foxglove_ws::ServiceError(request.serviceId, errMsg);
     }
 
+    // Calls waiting for a free thread are bounded, so that a hung service can not make them pile
+    // up without limit.
+    if (++_queuedServiceCalls > _maxQueuedServiceCalls) {
+      --_queuedServiceCalls;
+      _server->sendServiceFailure(clientHandle, request.serviceId, request.callId,
+                                  "Too many pending service calls, call to service '" +
+                                    serviceName + "' rejected");
+      return;
+    }
+
+    // The deadline includes the time spent waiting for a free thread.
+    const auto deadline =
+      _serviceCallTimeout.count() > 0.0
+        ? std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(_serviceCallTimeout)
+        : std::chrono::steady_clock::time_point::max();
+    _serviceCallQueue->addCallback([this, request, serviceName, serviceType,
+                                    md5sum = srvDescription->md5, clientHandle, deadline]() {
+      --_queuedServiceCalls;
+      callService(request, serviceName, serviceType, md5sum, clientHandle, deadline);
+    });
+  }
+
+  void callService(const foxglove_ws::ServiceRequest& request, const std::string& serviceName,
+                   const std::string& serviceType, const std::string& md5sum,
+                   ConnectionHandle clientHandle,
+                   std::chrono::steady_clock::time_point deadline) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      _server->sendServiceFailure(clientHandle, request.serviceId, request.callId,
+                                  "Call to service '" + serviceName +
+                                    "' timed out while waiting to be made");
+      return;
+    }
+
+    auto client = takeServiceClient(serviceName, md5sum);
+    if (!client) {
+      _server->sendServiceFailure(clientHandle, request.serviceId, request.callId,
+                                  "Service '" + serviceName + "' does not exist");
+      return;
+    }
+
+    std::list<BusyServiceClient>::iterator busyIt;
+    {
+      std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+      if (_serviceClientsShutdown) {
+        return;
+      }
+      busyIt = _busyServiceClients.insert(_busyServiceClients.end(), {*client, deadline});
+    }
+
     GenericService genReq, genRes;
     genReq.type = genRes.type = serviceType;
-    genReq.md5sum = genRes.md5sum = srvDescription->md5;
+    genReq.md5sum = genRes.md5sum = md5sum;
     genReq.data = request.data;
 
-    if (ros::service::call(serviceName, genReq, genRes)) {
-      foxglove_ws::ServiceResponse res;
-      res.serviceId = request.serviceId;
-      res.callId = request.callId;
-      res.encoding = request.encoding;
-      res.data = genRes.data;
-      _server->sendServiceResponse(clientHandle, res);
+    const bool success = client->call(genReq, genRes);
+    bool timedOut = false;
+    {
+      std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+      timedOut = busyIt->timedOut;
+      _busyServiceClients.erase(busyIt);
+    }
+    if (timedOut) {
+      _server->sendServiceFailure(clientHandle, request.serviceId, request.callId,
+                                  "Call to service '" + serviceName + "' timed out");
+    } else if (success) {
+      releaseServiceClient(serviceName, md5sum, std::move(*client));
+      _server->sendServiceResponse(clientHandle, request.serviceId, request.callId,
+                                   request.encoding, genRes.data.data(), genRes.data.size());
     } else {
-      throw foxglove_ws::ServiceError(
-        request.serviceId, "Failed to call service " + serviceName + "(" + serviceType + ")");
+      // The connection is dropped rather than reused, as the service may have gone away.
+      _server->sendServiceFailure(
+        clientHandle, request.serviceId, request.callId,
+        "Failed to call service " + serviceName + "(" + serviceType + ")");
+    }
+  }
+
+  /// Drop the connections of calls that are past their deadline, which makes the calls return.
+  void abortTimedOutServiceCalls() {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+    for (auto& busyClient : _busyServiceClients) {
+      if (!busyClient.timedOut && now >= busyClient.deadline) {
+        busyClient.timedOut = true;
+        busyClient.client.shutdown();
+      }
+    }
+  }
+
+  /// Take an idle persistent connection to the service out of the pool, or open a new one.
+  std::optional<ros::ServiceClient> takeServiceClient(const std::string& serviceName,
+                                                      const std::string& md5sum) {
+    {
+      std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+      const auto idleIt = _idleServiceClients.find({serviceName, md5sum});
+      if (idleIt != _idleServiceClients.end()) {
+        auto& idleClients = idleIt->second;
+        while (!idleClients.empty()) {
+          auto client = std::move(idleClients.back());
+          idleClients.pop_back();
+          if (client.isValid()) {
+            return client;
+          }
+        }
+      }
+    }
+
+    if (!ros::service::exists(serviceName, false)) {
+      return std::nullopt;
+    }
+    ros::ServiceClientOptions options;
+    options.service = serviceName;
+    options.md5sum = md5sum;
+    options.persistent = true;
+    return getMTNodeHandle().serviceClient(options);
+  }
+
+  void releaseServiceClient(const std::string& serviceName, const std::string& md5sum,
+                            ros::ServiceClient client) {
+    std::shared_lock<std::shared_mutex> servicesLock(_servicesMutex);
+    const bool advertised =
+      std::find_if(_advertisedServices.begin(), _advertisedServices.end(),
+                   [&serviceName](const auto& idWithService) {
+                     return idWithService.second.name == serviceName;
+                   }) != _advertisedServices.end();
+    if (advertised) {
+      std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+      _idleServiceClients[{serviceName, md5sum}].push_back(std::move(client));
+    }
+  }
+
+  /// Close the idle connections to a service, e.g. once it has been removed from the graph.
+  void removeIdleServiceClients(const std::string& serviceName) {
+    std::lock_guard<std::mutex> lock(_serviceClientsMutex);
+    for (auto it = _idleServiceClients.begin(); it != _idleServiceClients.end();) {
+      if (it->first.first == serviceName) {
+        it = _idleServiceClients.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
 
@@ -948,11 +1219,37 @@ private:
   size_t _maxUpdateMs = size_t(DEFAULT_MAX_UPDATE_MS);
   size_t _updateCount = 0;
   ros::Subscriber _clockSubscription;
+  ros::WallTimer _timeBroadcastTimer;
+  std::atomic<uint64_t> _latestClockTime = 0;
+  uint64_t _lastBroadcastedClockTime = 0;
   bool _useSimTime = false;
   std::vector<std::string> _capabilities;
   int _serviceRetrievalTimeoutMs = DEFAULT_SERVICE_TYPE_RETRIEVAL_TIMEOUT_MS;
+  size_t _serviceRetrievalConcurrency = DEFAULT_SERVICE_TYPE_RETRIEVAL_CONCURRENCY;
+  ServiceTypeRetriever _serviceTypeRetriever;
   std::atomic<bool> _subscribeGraphUpdates = false;
   std::unique_ptr<foxglove_ws::CallbackQueue> _fetchAssetQueue;
+  // Idle persistent connections by service name and MD5 sum, so that service calls do not have to
+  // look up the service and connect to it every time. Each connection is used by one call at a
+  // time.
+  std::unordered_map<std::pair<std::string, std::string>, std::vector<ros::ServiceClient>,
+                     PairHash>
+    _idleServiceClients;
+  // Connections of calls in progress, which are dropped once the call is past its deadline.
+  struct BusyServiceClient {
+    ros::ServiceClient client;
+    std::chrono::steady_clock::time_point deadline;
+    bool timedOut = false;
+  };
+  std::list<BusyServiceClient> _busyServiceClients;
+  bool _serviceClientsShutdown = false;
+  std::chrono::duration<double> _serviceCallTimeout{DEFAULT_SERVICE_CALL_TIMEOUT};
+  size_t _maxQueuedServiceCalls = DEFAULT_MAX_QUEUED_SERVICE_CALLS;
+  std::atomic<size_t> _queuedServiceCalls = 0;
+  ros::WallTimer _serviceCallTimeoutTimer;
+  std::mutex _serviceClientsMutex;
+  // Declared after the connection pool, which its threads use, so that it is destroyed first.
+  std::unique_ptr<foxglove_ws::CallbackQueue> _serviceCallQueue;
   std::unordered_set<std::string> _invalidParams;
 };
 
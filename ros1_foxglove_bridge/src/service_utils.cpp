@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <future>
+#include <thread>
+#include <unordered_set>
 
 #include <ros/connection.h>
 #include <ros/connection_manager.h>
@@ -11,23 +15,25 @@
 #include <foxglove_bridge/service_utils.hpp>
 
 namespace foxglove_bridge {
+namespace {
+
+void lookupService(const std::string& serviceName, std::string& srvHost, uint32_t& srvPort) {
+  if (!ros::ServiceManager::instance()->lookupService(serviceName, srvHost, srvPort)) {
+    throw std::runtime_error("Failed to lookup service " + serviceName);
+  }
+}
 
 /**
- * Looks up the service server host & port and opens a TCP connection to it to retrieve the header
- * which contains the service type.
+ * Opens a TCP connection to the service server to retrieve the header which contains the service
+ * type.
  *
  * The implementation is similar to how ROS does it under the hood when creating a service server
  * link:
  * https://github.com/ros/ros_comm/blob/845f74602c7464e08ef5ac6fd9e26c97d0fe42c9/clients/roscpp/src/libros/service_manager.cpp#L246-L261
  * https://github.com/ros/ros_comm/blob/845f74602c7464e08ef5ac6fd9e26c97d0fe42c9/clients/roscpp/src/libros/service_server_link.cpp#L114-L130
  */
-std::string retrieveServiceType(const std::string& serviceName, std::chrono::milliseconds timeout) {
-  std::string srvHost;
-  uint32_t srvPort;
-  if (!ros::ServiceManager::instance()->lookupService(serviceName, srvHost, srvPort)) {
-    throw std::runtime_error("Failed to lookup service " + serviceName);
-  }
-
+std::string probeServiceType(const std::string& serviceName, const std::string& srvHost,
+                             uint32_t srvPort, std::chrono::milliseconds timeout) {
   auto transport =
     boost::make_shared<ros::TransportTCP>(&ros::PollManager::instance()->getPollSet());
   auto connection = boost::make_shared<ros::Connection>();
@@ -73,4 +79,86 @@ std::string retrieveServiceType(const std::string& serviceName, std::chrono::mil
   return future.get();
 }
 
+}  // namespace
+
+std::string retrieveServiceType(const std::string& serviceName, std::chrono::milliseconds timeout) {
+  std::string srvHost;
+  uint32_t srvPort;
+  lookupService(serviceName, srvHost, srvPort);
+  return probeServiceType(serviceName, srvHost, srvPort, timeout);
+}
+
+std::unordered_map<std::string, std::string> ServiceTypeRetriever::retrieve(
+  const std::vector<std::string>& serviceNames, std::chrono::milliseconds timeout,
+  size_t maxConcurrentProbes, const ErrorCallback& onError) {
+  {
+    // Drop services that are gone, so that the cache does not grow with every service that ever
+    // existed.
+    const std::unordered_set<std::string> existingServiceNames(serviceNames.begin(),
+                                                               serviceNames.end());
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto cacheIt = _cache.begin(); cacheIt != _cache.end();) {
+      if (existingServiceNames.find(cacheIt->first) == existingServiceNames.end()) {
+        cacheIt = _cache.erase(cacheIt);
+      } else {
+        ++cacheIt;
+      }
+    }
+  }
+
+  std::unordered_map<std::string, std::string> types;
+  std::vector<std::pair<std::string, std::string>> errors;
+  std::mutex resultsMutex;
+  std::atomic<size_t> nextService = 0;
+
+  // Each worker looks up and probes one service after the other, so that a slow service server
+  // only holds up its own worker.
+  const auto work = [&]() {
+    for (size_t i = nextService++; i < serviceNames.size(); i = nextService++) {
+      const auto& serviceName = serviceNames[i];
+      try {
+        std::string srvHost;
+        uint32_t srvPort;
+        lookupService(serviceName, srvHost, srvPort);
+        const auto srvAddress = srvHost + ":" + std::to_string(srvPort);
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          const auto cacheIt = _cache.find(serviceName);
+          if (cacheIt != _cache.end() && cacheIt->second.first == srvAddress) {
+            std::lock_guard<std::mutex> resultsLock(resultsMutex);
+            types.emplace(serviceName, cacheIt->second.second);
+            continue;
+          }
+        }
+
+        const auto serviceType = probeServiceType(serviceName, srvHost, srvPort, timeout);
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _cache[serviceName] = {srvAddress, serviceType};
+        }
+        std::lock_guard<std::mutex> resultsLock(resultsMutex);
+        types.emplace(serviceName, serviceType);
+      } catch (const std::exception& ex) {
+        std::lock_guard<std::mutex> resultsLock(resultsMutex);
+        errors.emplace_back(serviceName, ex.what());
+      }
+    }
+  };
+
+  const size_t numWorkers = std::min(std::max<size_t>(maxConcurrentProbes, 1), serviceNames.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < numWorkers; ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (const auto& [serviceName, error] : errors) {
+    onError(serviceName, error);
+  }
+  return types;
+}
+
 }  // namespace foxglove_bridge
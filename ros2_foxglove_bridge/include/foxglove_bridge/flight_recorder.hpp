@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <rclcpp/serialized_message.hpp>
+
+#include <foxglove_bridge/callback_queue.hpp>
+#include <foxglove_bridge/common.hpp>
+
+namespace foxglove_bridge {
+
+/// Keeps the most recent messages of a set of channels in memory, and writes them to an MCAP file
+/// on demand.
+///
+/// Recording only keeps a reference to the serialized message which was received anyway, so it
+/// costs little more than a deque insertion. Messages are dropped once they are older than the
+/// configured duration or the recorder exceeds its memory limit. Channels that are removed keep
+/// their messages until these are dropped, so that a dump still contains the topics of a node that
+/// crashed.
+class FlightRecorder {
+public:
+  using DumpCallback = std::function<void(bool success, const std::string& message)>;
+
+  FlightRecorder(std::chrono::nanoseconds duration, size_t maxBytes,
+                 foxglove_ws::LogCallback logCallback);
+
+  void addChannel(foxglove_ws::ChannelId channelId, const foxglove_ws::ChannelWithoutId& channel);
+
+  void removeChannel(foxglove_ws::ChannelId channelId);
+
+  void record(foxglove_ws::ChannelId channelId, uint64_t timestamp,
+              std::shared_ptr<const rclcpp::SerializedMessage> msg);
+
+  /// Write a snapshot of the recorded messages to the given file. The file is written by a
+  /// background thread, which calls `done` once finished.
+  /// @return false if a previous dump is still being written.
+  bool dump(const std::string& path, DumpCallback done);
+
+private:
+  struct RecordedChannel {
+    foxglove_ws::ChannelWithoutId channel;
+    size_t messageCount = 0;
+    bool removed = false;
+  };
+
+  struct RecordedMessage {
+    foxglove_ws::ChannelId channelId;
+    uint64_t timestamp;
+    std::shared_ptr<const rclcpp::SerializedMessage> msg;
+  };
+
+  using RecordedChannels = std::unordered_map<foxglove_ws::ChannelId, RecordedChannel>;
+
+  const RecordedMessage* oldestMessage() const;
+  void dropOldestMessage();
+  void unfreezeMessages();
+
+  static void writeMcap(const std::string& path, const RecordedChannels& channels,
+                        const std::deque<RecordedMessage>& messages);
+
+  const uint64_t _durationNs;
+  const size_t _maxBytes;
+  std::mutex _mutex;
+  RecordedChannels _channels;
+  std::deque<RecordedMessage> _messages;
+  // While a dump is written, the messages recorded before it. The writer reads them without
+  // holding _mutex, so the first _frozenDropped of them are only dropped logically.
+  std::shared_ptr<std::deque<RecordedMessage>> _frozenMessages;
+  size_t _frozenDropped = 0;
+  size_t _bytes = 0;
+  std::atomic<bool> _dumping = false;
+  foxglove_ws::CallbackQueue _writerQueue;
+};
+
+}  // namespace foxglove_bridge
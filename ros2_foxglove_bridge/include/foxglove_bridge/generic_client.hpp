@@ -8,6 +8,16 @@
 
 namespace foxglove_bridge {
 
+/// Type support libraries and handles of a service type.
+struct ServiceTypeSupport {
+  std::shared_ptr<rcpputils::SharedLibrary> typeSupportLib;
+  std::shared_ptr<rcpputils::SharedLibrary> typeIntrospectionLib;
+  const rosidl_service_type_support_t* serviceTypeSupportHdl = nullptr;
+  const rosidl_message_type_support_t* requestTypeSupportHdl = nullptr;
+  const rosidl_message_type_support_t* responseTypeSupportHdl = nullptr;
+  const rosidl_service_type_support_t* typeIntrospectionHdl = nullptr;
+};
+
 class GenericClient : public rclcpp::ClientBase {
 public:
   using SharedRequest = std::shared_ptr<rclcpp::SerializedMessage>;
@@ -21,6 +31,11 @@ public:
   using CallbackType = std::function<void(SharedFuture)>;
   using CallbackWithRequestType = std::function<void(SharedFutureWithRequest)>;
 
+  struct FutureAndRequestId {
+    SharedFuture future;
+    int64_t request_id;
+  };
+
   RCLCPP_SMART_PTR_DEFINITIONS(GenericClient)
 
   GenericClient(rclcpp::node_interfaces::NodeBaseInterface* node_base,
@@ -35,18 +50,17 @@ public:
                        std::shared_ptr<void> response) override;
   SharedFuture async_send_request(SharedRequest request);
   SharedFuture async_send_request(SharedRequest request, CallbackType&& cb);
+  FutureAndRequestId async_send_request_with_id(SharedRequest request, CallbackType&& cb);
+  /// Forget a pending request, e.g. after it timed out. Its callback will not be called.
+  /// @return false if there was no pending request with the given id.
+  bool remove_pending_request(int64_t request_id);
 
 private:
   RCLCPP_DISABLE_COPY(GenericClient)
 
   std::map<int64_t, std::tuple<SharedPromise, CallbackType, SharedFuture>> pending_requests_;
   std::mutex pending_requests_mutex_;
-  std::shared_ptr<rcpputils::SharedLibrary> _typeSupportLib;
-  std::shared_ptr<rcpputils::SharedLibrary> _typeIntrospectionLib;
-  const rosidl_service_type_support_t* _serviceTypeSupportHdl;
-  const rosidl_message_type_support_t* _requestTypeSupportHdl;
-  const rosidl_message_type_support_t* _responseTypeSupportHdl;
-  const rosidl_service_type_support_t* _typeIntrospectionHdl;
+  std::shared_ptr<const ServiceTypeSupport> _typeSupport;
 };
 
 }  // namespace foxglove_bridge
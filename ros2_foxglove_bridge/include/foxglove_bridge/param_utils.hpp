@@ -6,6 +6,8 @@
 
 #include <rclcpp/node.hpp>
 
+#include <foxglove_bridge/server_interface.hpp>
+
 namespace foxglove_bridge {
 
 constexpr char PARAM_PORT[] = "port";
@@ -27,16 +29,72 @@ constexpr char PARAM_INCLUDE_HIDDEN[] = "include_hidden";
 constexpr char PARAM_DISABLE_LOAN_MESSAGE[] = "disable_load_message";
 constexpr char PARAM_ASSET_URI_ALLOWLIST[] = "asset_uri_allowlist";
 constexpr char PARAM_IGN_UNRESPONSIVE_PARAM_NODES[] = "ignore_unresponsive_param_nodes";
+constexpr char PARAM_TIME_BROADCAST_RATE[] = "time_broadcast_rate";
+constexpr char PARAM_CLIENT_BANDWIDTH_LIMIT[] = "client_bandwidth_limit";
+constexpr char PARAM_CLIENT_BANDWIDTH_BURST[] = "client_bandwidth_burst";
+constexpr char PARAM_CLIENT_BANDWIDTH_GROUPS[] = "client_bandwidth_groups";
+constexpr char PARAM_GLOBAL_SEND_BUFFER_LIMIT[] = "global_send_buffer_limit";
+constexpr char PARAM_EGRESS_CPU_BUDGET[] = "egress_cpu_budget";
+constexpr char PARAM_PARAMETER_UPDATE_INTERVAL[] = "parameter_update_interval_ms";
+constexpr char PARAM_TOPIC_PRIORITIES[] = "topic_priorities";
+constexpr char PARAM_CLIENT_PUBLISH_RATE_LIMITS[] = "client_publish_rate_limits";
+constexpr char PARAM_CLIENT_PUBLISH_BANDWIDTH_LIMITS[] = "client_publish_bandwidth_limits";
+constexpr char PARAM_SUBSCRIPTION_LINGER_DURATION[] = "subscription_linger_duration";
+constexpr char PARAM_LAST_MESSAGE_CACHE_TOPICS[] = "last_message_cache_topics";
+constexpr char PARAM_LAST_MESSAGE_CACHE_BUDGET[] = "last_message_cache_budget";
+constexpr char PARAM_TOPIC_HISTORY_DURATIONS[] = "topic_history_durations";
+constexpr char PARAM_TOPIC_HISTORY_MAX_BYTES[] = "topic_history_max_bytes";
+constexpr char PARAM_FLIGHT_RECORDER_TOPICS[] = "flight_recorder_topics";
+constexpr char PARAM_FLIGHT_RECORDER_DURATION[] = "flight_recorder_duration";
+constexpr char PARAM_FLIGHT_RECORDER_MAX_BYTES[] = "flight_recorder_max_bytes";
+constexpr char PARAM_FLIGHT_RECORDER_DIRECTORY[] = "flight_recorder_directory";
+constexpr char PARAM_SERVICE_CALL_TIMEOUT[] = "service_call_timeout";
+constexpr char PARAM_MAX_CONCURRENT_SERVICE_CALLS[] = "max_concurrent_service_calls";
+constexpr char PARAM_SERVICE_RESPONSE_CACHE_TTLS[] = "service_response_cache_ttls";
+constexpr char PARAM_PARAMETER_CACHE_MAX_AGE[] = "parameter_cache_max_age";
 
 constexpr int64_t DEFAULT_PORT = 8765;
 constexpr char DEFAULT_ADDRESS[] = "0.0.0.0";
 constexpr int64_t DEFAULT_SEND_BUFFER_LIMIT = 10000000;
 constexpr int64_t DEFAULT_MIN_QOS_DEPTH = 1;
 constexpr int64_t DEFAULT_MAX_QOS_DEPTH = 25;
+constexpr double DEFAULT_TIME_BROADCAST_RATE = 60.0;
+constexpr double DEFAULT_SUBSCRIPTION_LINGER_DURATION = 0.0;
+constexpr int64_t DEFAULT_LAST_MESSAGE_CACHE_BUDGET = 50000000;
+constexpr int64_t DEFAULT_TOPIC_HISTORY_MAX_BYTES = 10000000;
+constexpr double DEFAULT_FLIGHT_RECORDER_DURATION = 60.0;
+constexpr int64_t DEFAULT_FLIGHT_RECORDER_MAX_BYTES = 500000000;
+constexpr char DEFAULT_FLIGHT_RECORDER_DIRECTORY[] = "/tmp";
+constexpr double DEFAULT_SERVICE_CALL_TIMEOUT = 5.0;
+constexpr int64_t DEFAULT_MAX_CONCURRENT_SERVICE_CALLS = 16;
+constexpr double DEFAULT_PARAMETER_CACHE_MAX_AGE = 60.0;
+
+/// Time for which the responses of services matching the pattern are cached. Identical calls to
+/// these services are assumed to be idempotent.
+struct ServiceResponseCacheTtl {
+  std::regex servicePattern;
+  double ttlSeconds = 0.0;
+};
 
 void declareParameters(rclcpp::Node* node);
 
 std::vector<std::regex> parseRegexStrings(rclcpp::Node* node,
                                           const std::vector<std::string>& strings);
 
+std::vector<foxglove_ws::ClientBandwidthQuota> parseClientBandwidthQuotas(
+  rclcpp::Node* node, const std::vector<std::string>& specs);
+
+std::vector<foxglove_ws::ChannelPriority> parseChannelPriorities(
+  rclcpp::Node* node, const std::vector<std::string>& specs);
+
+std::vector<foxglove_ws::ChannelHistoryLimit> parseChannelHistoryLimits(
+  rclcpp::Node* node, const std::vector<std::string>& specs, size_t maxBytes);
+
+std::vector<foxglove_ws::ClientPublishLimit> parseClientPublishLimits(
+  rclcpp::Node* node, const std::vector<std::string>& rateSpecs,
+  const std::vector<std::string>& bandwidthSpecs);
+
+std::vector<ServiceResponseCacheTtl> parseServiceResponseCacheTtls(
+  rclcpp::Node* node, const std::vector<std::string>& specs);
+
 }  // namespace foxglove_bridge
@@ -5,6 +5,7 @@
 #include <mutex>
 #include <regex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -16,20 +17,37 @@ namespace foxglove_bridge {
 
 using ParameterList = std::vector<foxglove_ws::Parameter>;
 using ParamUpdateFunc = std::function<void(const ParameterList&)>;
+using ParamResultFunc = std::function<void(const ParameterList&)>;
+using ParamSetDoneFunc = std::function<void()>;
 
 enum class UnresponsiveNodePolicy {
   Ignore,
   Retry,
 };
 
+/// Parameters of a node, kept up to date from parameter events.
+struct NodeParameters {
+  std::unordered_map<std::string, foxglove_ws::Parameter> params;  // By name without node name
+  std::chrono::steady_clock::time_point fetchTime;
+};
+
 class ParameterInterface {
 public:
+  /// @param cacheMaxAge Time after which the cached parameters of a node are fetched again, in case
+  /// parameter events were missed. 0 disables the cache.
   ParameterInterface(rclcpp::Node* node, std::vector<std::regex> paramWhitelistPatterns,
-                     UnresponsiveNodePolicy unresponsiveNodePolicy);
+                     UnresponsiveNodePolicy unresponsiveNodePolicy,
+                     std::chrono::duration<double> cacheMaxAge);
 
-  ParameterList getParams(const std::vector<std::string>& paramNames,
-                          const std::chrono::duration<double>& timeout);
-  void setParams(const ParameterList& params, const std::chrono::duration<double>& timeout);
+  /// Get parameters without blocking. `resultFunc` is called once, with the parameters of all
+  /// nodes, when the last node has responded or timed out (right away if all of them are cached).
+  /// Called from executor threads.
+  void getParams(const std::vector<std::string>& paramNames,
+                 const std::chrono::duration<double>& timeout, ParamResultFunc resultFunc);
+  /// Set parameters without blocking. `doneFunc` is called once all nodes have responded or timed
+  /// out. Called from executor threads.
+  void setParams(const ParameterList& params, const std::chrono::duration<double>& timeout,
+                 ParamSetDoneFunc doneFunc);
   void subscribeParams(const std::vector<std::string>& paramNames);
   void unsubscribeParams(const std::vector<std::string>& paramNames);
   void setParamUpdateCallback(ParamUpdateFunc paramUpdateFunc);
@@ -40,20 +58,52 @@ private:
   rclcpp::CallbackGroup::SharedPtr _callbackGroup;
   std::mutex _mutex;
   std::unordered_map<std::string, rclcpp::AsyncParametersClient::SharedPtr> _paramClientsByNode;
-  std::unordered_map<std::string, std::unordered_set<std::string>> _subscribedParamsByNode;
-  std::unordered_map<std::string, rclcpp::SubscriptionBase::SharedPtr> _paramSubscriptionsByNode;
   std::unordered_set<std::string> _ignoredNodeNames;
   UnresponsiveNodePolicy _unresponsiveNodePolicy;
+  // Parameter subscriptions of the clients, served from the single parameter events subscription.
+  // Separate from _mutex, so that parameter events are not held up by get and set requests.
+  std::mutex _subscriptionsMutex;
+  std::unordered_map<std::string, std::unordered_set<std::string>> _subscribedParamsByNode;
+  std::unordered_map<std::string, foxglove_ws::Parameter> _pendingParamUpdates;
+  rclcpp::TimerBase::SharedPtr _paramUpdateTimer;  // Only set while updates are pending
   ParamUpdateFunc _paramUpdateFunc;
+  // Parameters of all nodes that have been fetched, answering requests without calling the nodes.
+  // Never locked while waiting for nodes, so that parameter events are never held up.
+  std::chrono::duration<double> _cacheMaxAge;
+  std::mutex _cacheMutex;
+  std::unordered_map<std::string, NodeParameters> _paramCache;
+  uint64_t _paramEventCount = 0;
+  std::unordered_map<std::string, uint64_t> _lastParamEventByNode;
+  rclcpp::Subscription<rcl_interfaces::msg::ParameterEvent>::SharedPtr _paramEventsSubscription;
+  // Requests to nodes that are waiting for a response, failed once their deadline has passed.
+  struct PendingNodeRequest {
+    std::chrono::steady_clock::time_point deadline;
+    std::function<void()> expire;
+  };
+  std::unordered_map<uint64_t, PendingNodeRequest> _pendingNodeRequests;  // Guarded by _mutex
+  uint64_t _nextNodeRequestId = 0;
+  rclcpp::TimerBase::SharedPtr _nodeRequestTimer;
 
-  ParameterList getNodeParameters(rclcpp::AsyncParametersClient::SharedPtr paramClient,
-                                  const std::string& nodeName,
-                                  const std::vector<std::string>& paramNames,
-                                  const std::chrono::duration<double>& timeout);
+  rclcpp::AsyncParametersClient::SharedPtr getParamClient(const std::string& nodeName);
+  void getNodeParameters(rclcpp::AsyncParametersClient::SharedPtr paramClient,
+                         const std::string& nodeName, const std::vector<std::string>& paramNames,
+                         const std::chrono::duration<double>& timeout,
+                         std::function<void(ParameterList)> onSuccess,
+                         std::function<void(const std::string&)> onFailure);
   void setNodeParameters(rclcpp::AsyncParametersClient::SharedPtr paramClient,
                          const std::string& nodeName, const std::vector<rclcpp::Parameter>& params,
-                         const std::chrono::duration<double>& timeout);
+                         const std::chrono::duration<double>& timeout, ParamSetDoneFunc doneFunc);
+  void handleUnresponsiveNode(const std::string& nodeName);
+  uint64_t addNodeRequest(const std::chrono::duration<double>& timeout,
+                          std::function<void()> expire);
+  bool finishNodeRequest(uint64_t requestId);
+  bool isNodeRequestPending(uint64_t requestId);
+  void expireNodeRequests();
   bool isWhitelistedParam(const std::string& paramName);
+  void updateParamCache(const rcl_interfaces::msg::ParameterEvent& event);
+  void invalidateParamCache(const std::string& nodeName);
+  void queueParamUpdates(const rcl_interfaces::msg::ParameterEvent& event);
+  void sendParamUpdates();
 };
 
 }  // namespace foxglove_bridge
@@ -2,35 +2,86 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <thread>
 
 #include <rclcpp/rclcpp.hpp>
 #include <rosgraph_msgs/msg/clock.hpp>
-#include <rosx_introspection/ros_parser.hpp>
+#include <std_srvs/srv/trigger.hpp>
 #include <websocketpp/common/connection_hdl.hpp>
 
 #include <foxglove_bridge/callback_queue.hpp>
+#include <foxglove_bridge/flight_recorder.hpp>
 #include <foxglove_bridge/foxglove_bridge.hpp>
 #include <foxglove_bridge/generic_client.hpp>
+#include <foxglove_bridge/json_cdr_serializer.hpp>
 #include <foxglove_bridge/message_definition_cache.hpp>
 #include <foxglove_bridge/param_utils.hpp>
 #include <foxglove_bridge/parameter_interface.hpp>
 #include <foxglove_bridge/regex_utils.hpp>
+#include <foxglove_bridge/serialized_message_pool.hpp>
 #include <foxglove_bridge/server_factory.hpp>
+#include <foxglove_bridge/service_response_cache.hpp>
 #include <foxglove_bridge/utils.hpp>
 
 namespace foxglove_bridge {
 
 using ConnectionHandle = websocketpp::connection_hdl;
 using LogLevel = foxglove_ws::WebSocketLogLevel;
+using JsonSerializers =
+  std::unordered_map<std::string, std::shared_ptr<const foxglove_ws::JsonCdrSerializer>>;
 using Subscription = rclcpp::GenericSubscription::SharedPtr;
-using SubscriptionsByClient = std::map<ConnectionHandle, Subscription, std::owner_less<>>;
+
+/// Client that messages of a ROS subscription are forwarded to. `clientHandle` is accessed
+/// atomically, so that a lingering subscription (without client) can be handed over to the next
+/// subscribing client. For transient local topics, the last `historyDepth` messages are kept so
+/// that they can be replayed to that client. While `replayPending` is set, received messages are
+/// only added to the history, which is sent to the client by the replay.
+struct SubscriptionTarget {
+  std::shared_ptr<const ConnectionHandle> clientHandle;
+  size_t historyDepth = 0;
+  std::mutex historyMutex;
+  std::deque<std::shared_ptr<const rclcpp::SerializedMessage>> history;
+  bool replayPending = false;
+};
+
+struct ClientSubscription {
+  Subscription subscription;
+  std::shared_ptr<SubscriptionTarget> target;
+};
+
+struct LingeringSubscription {
+  ClientSubscription clientSubscription;
+  std::chrono::steady_clock::time_point expiry;
+};
+
+using SubscriptionsByClient = std::map<ConnectionHandle, ClientSubscription, std::owner_less<>>;
 using Publication = rclcpp::GenericPublisher::SharedPtr;
 using ClientPublications = std::unordered_map<foxglove_ws::ClientChannelId, Publication>;
 using PublicationsByClient = std::map<ConnectionHandle, ClientPublications, std::owner_less<>>;
 
+/// Service call of a client that has not been answered yet. Calls are queued until the service is
+/// available, and fail once their deadline has passed.
+struct PendingServiceCall {
+  foxglove_ws::ServiceRequest request;
+  ConnectionHandle clientHandle;
+  std::chrono::steady_clock::time_point deadline;
+  bool sent = false;
+  std::optional<int64_t> requestId;  // Id of the ROS request, once sent
+  std::optional<uint64_t> leaderKey;  // Identical call whose response is shared, instead of sending
+};
+
+struct ServiceCalls {
+  std::string serviceName;
+  GenericClient::SharedPtr client;
+  std::unordered_map<uint64_t, PendingServiceCall> pending;
+  // Set for idempotent services, whose identical calls are coalesced and responses cached.
+  std::optional<std::chrono::duration<double>> responseCacheTtl;
+};
+
 class FoxgloveBridge : public rclcpp::Node {
 public:
   using TopicAndDatatype = std::pair<std::string, std::string>;
@@ -58,6 +109,11 @@ private:
   };
 
   std::unique_ptr<foxglove_ws::ServerInterface<ConnectionHandle>> _server;
+  std::unique_ptr<FlightRecorder> _flightRecorder;
+  std::vector<std::regex> _flightRecorderPatterns;
+  std::string _flightRecorderDirectory;
+  std::atomic<unsigned int> _flightRecordingCount = 0;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr _dumpFlightRecordingService;
   foxglove::MessageDefinitionCache _messageDefinitionCache;
   std::vector<std::regex> _topicWhitelistPatterns;
   std::vector<std::regex> _serviceWhitelistPatterns;
@@ -67,8 +123,33 @@ private:
   std::unordered_map<foxglove_ws::ChannelId, foxglove_ws::ChannelWithoutId> _advertisedTopics;
   std::unordered_map<foxglove_ws::ServiceId, foxglove_ws::ServiceWithoutId> _advertisedServices;
   std::unordered_map<foxglove_ws::ChannelId, SubscriptionsByClient> _subscriptions;
+  std::unordered_map<foxglove_ws::ChannelId, std::shared_ptr<SerializedMessagePool>>
+    _serializedMessagePools;
+  // Subscriptions kept alive after the last client of their channel unsubscribed, so that
+  // re-subscribing (e.g. when switching layouts) does not need to wait for discovery and transient
+  // local history again.
+  std::unordered_map<foxglove_ws::ChannelId, LingeringSubscription> _lingeringSubscriptions;
+  std::chrono::duration<double> _subscriptionLingerDuration{0.0};
+  rclcpp::TimerBase::SharedPtr _lingerExpiryTimer;
+  rclcpp::TimerBase::SharedPtr _messagePoolStatisticsTimer;
+  // First subscriptions of a channel that did (hits) or did not (misses) reuse a lingering one.
+  size_t _lingerHits = 0;
+  size_t _lingerMisses = 0;
+  // Subscriptions of channels whose last message or history is cached by the server. They are
+  // created when the channel is advertised and forward messages to all subscribed clients.
+  std::vector<std::regex> _cachedTopicPatterns;
+  std::unordered_map<foxglove_ws::ChannelId, Subscription> _cacheSubscriptions;
   PublicationsByClient _clientAdvertisedTopics;
-  std::unordered_map<foxglove_ws::ServiceId, GenericClient::SharedPtr> _serviceClients;
+  // Service clients and their pending calls. Never locked while calling into ROS, so that a slow
+  // or missing service does not hold up calls to other services.
+  std::unordered_map<foxglove_ws::ServiceId, ServiceCalls> _serviceCalls;
+  std::mutex _serviceCallsMutex;
+  uint64_t _nextServiceCallKey = 0;
+  std::chrono::duration<double> _serviceCallTimeout{DEFAULT_SERVICE_CALL_TIMEOUT};
+  size_t _maxConcurrentServiceCalls = DEFAULT_MAX_CONCURRENT_SERVICE_CALLS;
+  rclcpp::TimerBase::SharedPtr _serviceCallTimer;
+  std::vector<ServiceResponseCacheTtl> _serviceResponseCacheTtls;
+  foxglove_ws::ServiceResponseCache _serviceResponseCache;  // Guarded by _serviceCallsMutex
   rclcpp::CallbackGroup::SharedPtr _subscriptionCallbackGroup;
   rclcpp::CallbackGroup::SharedPtr _clientPublishCallbackGroup;
   rclcpp::CallbackGroup::SharedPtr _servicesCallbackGroup;
@@ -79,21 +160,46 @@ private:
   size_t _minQosDepth = DEFAULT_MIN_QOS_DEPTH;
   size_t _maxQosDepth = DEFAULT_MAX_QOS_DEPTH;
   std::shared_ptr<rclcpp::Subscription<rosgraph_msgs::msg::Clock>> _clockSubscription;
+  rclcpp::TimerBase::SharedPtr _timeBroadcastTimer;
+  std::atomic<int64_t> _latestClockTime = -1;
+  int64_t _lastBroadcastedClockTime = -1;
   bool _useSimTime = false;
   std::vector<std::string> _capabilities;
   std::atomic<bool> _subscribeGraphUpdates = false;
   bool _includeHidden = false;
   bool _disableLoanMessage = true;
   std::unique_ptr<foxglove_ws::CallbackQueue> _fetchAssetQueue;
-  std::unordered_map<std::string, std::shared_ptr<RosMsgParser::Parser>> _jsonParsers;
+  // JSON serializers by schema name. Copy-on-write, so that client messages can look up their
+  // serializer without locking. Modified under _clientAdvertisementsMutex.
+  std::shared_ptr<const JsonSerializers> _jsonSerializers = std::make_shared<JsonSerializers>();
   std::atomic<bool> _shuttingDown = false;
 
   void subscribeConnectionGraph(bool subscribe);
 
+  rclcpp::QoS determineQoS(const std::string& topic);
+
   void subscribe(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle);
 
+  void subscribeForLastMessageCache(foxglove_ws::ChannelId channelId,
+                                    const foxglove_ws::ChannelWithoutId& channel);
+
   void unsubscribe(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle);
 
+  std::shared_ptr<SubscriptionTarget> reuseLingeringSubscription(
+    foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle,
+    SubscriptionsByClient& subscriptionsByClient);
+
+  void replaySubscriptionHistory(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle,
+                                 SubscriptionTarget& target);
+
+  void expireLingeringSubscriptions();
+
+  void logMessagePoolStatistics();
+
+  double lingerHitRate() const;
+
+  void releaseMessagePoolIfUnused(foxglove_ws::ChannelId channelId);
+
   void clientAdvertise(const foxglove_ws::ClientAdvertisement& advertisement, ConnectionHandle hdl);
 
   void clientUnadvertise(foxglove_ws::ChannelId channelId, ConnectionHandle hdl);
@@ -113,11 +219,34 @@ private:
 
   void logHandler(LogLevel level, char const* msg);
 
+  void broadcastLatestClockTime();
+
   void rosMessageHandler(const foxglove_ws::ChannelId& channelId, ConnectionHandle clientHandle,
                          std::shared_ptr<const rclcpp::SerializedMessage> msg);
 
+  void dumpFlightRecording(std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+
+  void cachedChannelMessageHandler(foxglove_ws::ChannelId channelId,
+                                   std::shared_ptr<const rclcpp::SerializedMessage> msg);
+
   void serviceRequest(const foxglove_ws::ServiceRequest& request, ConnectionHandle clientHandle);
 
+  void sendServiceCall(foxglove_ws::ServiceId serviceId, const GenericClient::SharedPtr& client,
+                       uint64_t callKey);
+
+  void serviceResponse(foxglove_ws::ServiceId serviceId, uint64_t callKey,
+                       std::chrono::duration<double> cacheTtl, GenericClient::SharedFuture future);
+
+  /// Answer a pending call, and the calls coalesced with it, with a service call failure.
+  void failServiceCall(foxglove_ws::ServiceId serviceId, uint64_t callKey,
+                       const std::string& message);
+
+  void sendWaitingServiceCalls();
+
+  void expireServiceCalls();
+
+  void clientDisconnected(ConnectionHandle clientHandle);
+
   void fetchAsset(const std::string& assetId, uint32_t requestId, ConnectionHandle clientHandle);
 
   bool hasCapability(const std::string& capability);
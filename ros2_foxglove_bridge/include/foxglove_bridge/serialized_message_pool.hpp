@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <rclcpp/generic_subscription.hpp>
+#include <rclcpp/node.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+#include <foxglove_bridge/json_cdr_serializer.hpp>
+
+namespace foxglove_bridge {
+
+/// Interval in which the bridges log the statistics of their pools at debug level.
+constexpr std::chrono::seconds MESSAGE_POOL_STATISTICS_INTERVAL{30};
+
+/// Pool of serialized message buffers of a single topic, grouped in power-of-two size classes.
+///
+/// rclcpp allocates a new serialized message for every sample taken by a generic subscription and
+/// frees it once the callback returned. For large messages (point clouds, images) this results in
+/// constant malloc / free churn and page faults. Buffers handed out by the pool are instead
+/// returned to it when the last reference is dropped, and reused for the next sample.
+class SerializedMessagePool : public std::enable_shared_from_this<SerializedMessagePool> {
+public:
+  struct Statistics {
+    uint64_t allocations = 0;  // Number of buffers allocated by the pool
+    uint64_t reuses = 0;       // Number of samples that were taken into a recycled buffer
+    size_t pooledBytes = 0;    // Capacity of the buffers currently held by the pool
+    size_t largestMessage = 0;
+  };
+
+  /// @param maxBuffersPerSizeClass Maximum number of idle buffers kept per size class.
+  explicit SerializedMessagePool(size_t maxBuffersPerSizeClass = 2);
+
+  /// Get a buffer which is large enough for the last message seen on this topic. The buffer is
+  /// returned to the pool when the last copy of the shared pointer is destroyed, even if that
+  /// happens after the pool itself was destroyed.
+  std::shared_ptr<rclcpp::SerializedMessage> acquire();
+
+  Statistics statistics() const;
+
+private:
+  static constexpr size_t MIN_CAPACITY = 4096;
+  static constexpr size_t SIZE_CLASS_COUNT = 64;
+
+  void release(rclcpp::SerializedMessage* message);
+
+  const size_t _maxBuffersPerSizeClass;
+  mutable std::mutex _mutex;
+  std::array<std::vector<std::unique_ptr<rclcpp::SerializedMessage>>, SIZE_CLASS_COUNT>
+    _freeBuffers;
+  size_t _expectedSize = 0;
+  Statistics _statistics;
+};
+
+/// Generic subscription which takes samples into buffers of a SerializedMessagePool.
+class PooledGenericSubscription : public rclcpp::GenericSubscription {
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(PooledGenericSubscription)
+
+  template <typename CallbackT>
+  PooledGenericSubscription(rclcpp::node_interfaces::NodeBaseInterface* nodeBase,
+                            std::shared_ptr<rcpputils::SharedLibrary> typeSupportLib,
+                            const std::string& topic, const std::string& type,
+                            const rclcpp::QoS& qos, CallbackT&& callback,
+                            const rclcpp::SubscriptionOptions& options,
+                            std::shared_ptr<SerializedMessagePool> pool)
+      : rclcpp::GenericSubscription(nodeBase, std::move(typeSupportLib), topic, type, qos,
+                                    std::forward<CallbackT>(callback), options)
+      , _pool(std::move(pool)) {}
+
+  std::shared_ptr<rclcpp::SerializedMessage> create_serialized_message() override;
+  void return_serialized_message(std::shared_ptr<rclcpp::SerializedMessage>& message) override;
+
+private:
+  std::shared_ptr<SerializedMessagePool> _pool;
+};
+
+/// Drop-in replacement for rclcpp::Node::create_generic_subscription which uses the given pool.
+rclcpp::GenericSubscription::SharedPtr createPooledGenericSubscription(
+  rclcpp::Node& node, const std::string& topic, const std::string& type, const rclcpp::QoS& qos,
+  std::function<void(std::shared_ptr<const rclcpp::SerializedMessage>)> callback,
+  const rclcpp::SubscriptionOptions& options, std::shared_ptr<SerializedMessagePool> pool);
+
+/// Output buffer of the JSON to CDR serializer that writes straight into a serialized message.
+class SerializedMessageOutputBuffer : public foxglove_ws::JsonCdrSerializer::OutputBuffer {
+public:
+  explicit SerializedMessageOutputBuffer(rclcpp::SerializedMessage& message)
+      : _message(message) {}
+
+  uint8_t* data() override {
+    return _message.get_rcl_serialized_message().buffer;
+  }
+
+  size_t capacity() const override {
+    return _message.capacity();
+  }
+
+  void reserve(size_t capacity) override {
+    _message.reserve(capacity);
+  }
+
+  void finish(size_t size) override {
+    _message.get_rcl_serialized_message().buffer_length = size;
+  }
+
+private:
+  rclcpp::SerializedMessage& _message;
+};
+
+/// Peak resident set size of this process in kilobytes, or 0 if it could not be determined.
+long getPeakRssKb();
+
+}  // namespace foxglove_bridge
@@ -0,0 +1,164 @@
+#include <iterator>
+
+#include <foxglove_bridge/flight_recorder.hpp>
+#include <foxglove_bridge/mcap_writer.hpp>
+
+namespace foxglove_bridge {
+
+FlightRecorder::FlightRecorder(std::chrono::nanoseconds duration, size_t maxBytes,
+                               foxglove_ws::LogCallback logCallback)
+    : _durationNs(static_cast<uint64_t>(duration.count()))
+    , _maxBytes(maxBytes)
+    , _writerQueue(logCallback, 1 /* num_threads */) {}
+
+void FlightRecorder::addChannel(foxglove_ws::ChannelId channelId,
+                                const foxglove_ws::ChannelWithoutId& channel) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& recordedChannel = _channels[channelId];
+  recordedChannel.channel = channel;
+  recordedChannel.removed = false;
+}
+
+void FlightRecorder::removeChannel(foxglove_ws::ChannelId channelId) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _channels.find(channelId);
+  if (it == _channels.end()) {
+    return;
+  } else if (it->second.messageCount == 0) {
+    _channels.erase(it);
+  } else {
+    it->second.removed = true;
+  }
+}
+
+void FlightRecorder::record(foxglove_ws::ChannelId channelId, uint64_t timestamp,
+                            std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto it = _channels.find(channelId);
+  if (it == _channels.end() || it->second.removed) {
+    return;
+  }
+
+  ++it->second.messageCount;
+  _bytes += msg->capacity();
+  _messages.push_back({channelId, timestamp, std::move(msg)});
+
+  for (auto oldest = oldestMessage();
+       oldest && (_bytes > _maxBytes || oldest->timestamp + _durationNs < timestamp);
+       oldest = oldestMessage()) {
+    dropOldestMessage();
+  }
+}
+
+bool FlightRecorder::dump(const std::string& path, DumpCallback done) {
+  if (_dumping.exchange(true)) {
+    return false;
+  }
+
+  // The recorded messages are swapped out rather than copied, so that the lock is only held
+  // briefly. They stay part of the recording while the writer reads them, and are merged back
+  // with the messages recorded in the meantime once the file is written.
+  auto channels = std::make_shared<RecordedChannels>();
+  auto messages = std::make_shared<std::deque<RecordedMessage>>();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    *channels = _channels;
+    messages->swap(_messages);
+    _frozenMessages = messages;
+    _frozenDropped = 0;
+  }
+
+  _writerQueue.addCallback([this, path, channels, messages, done = std::move(done)]() {
+    bool success = true;
+    std::string result;
+    try {
+      writeMcap(path, *channels, *messages);
+      result = "Wrote " + std::to_string(messages->size()) + " messages to " + path;
+    } catch (const std::exception& ex) {
+      success = false;
+      result = "Failed to write flight recording: " + std::string(ex.what());
+    }
+    unfreezeMessages();
+    done(success, result);
+    _dumping = false;
+  });
+  return true;
+}
+
+const FlightRecorder::RecordedMessage* FlightRecorder::oldestMessage() const {
+  if (_frozenMessages && _frozenDropped < _frozenMessages->size()) {
+    return &(*_frozenMessages)[_frozenDropped];
+  }
+  return _messages.empty() ? nullptr : &_messages.front();
+}
+
+void FlightRecorder::dropOldestMessage() {
+  const auto& oldest = *oldestMessage();
+  _bytes -= oldest.msg->capacity();
+  const auto channelIt = _channels.find(oldest.channelId);
+  if (channelIt != _channels.end() && --channelIt->second.messageCount == 0 &&
+      channelIt->second.removed) {
+    _channels.erase(channelIt);
+  }
+  if (_frozenMessages && _frozenDropped < _frozenMessages->size()) {
+    ++_frozenDropped;  // Still read by the writer, erased by unfreezeMessages()
+  } else {
+    _messages.pop_front();
+  }
+}
+
+void FlightRecorder::unfreezeMessages() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& frozen = *_frozenMessages;
+  frozen.erase(frozen.begin(), frozen.begin() + static_cast<std::ptrdiff_t>(_frozenDropped));
+  frozen.insert(frozen.end(), std::make_move_iterator(_messages.begin()),
+                std::make_move_iterator(_messages.end()));
+  _messages.swap(frozen);
+  _frozenMessages.reset();
+  _frozenDropped = 0;
+}
+
+void FlightRecorder::writeMcap(const std::string& path, const RecordedChannels& channels,
+                               const std::deque<RecordedMessage>& messages) {
+  foxglove_ws::McapWriter writer;
+  writer.open(path, "ros2");
+
+  std::unordered_map<std::string, uint16_t> schemaIds;
+  std::unordered_map<foxglove_ws::ChannelId, uint16_t> mcapChannelIds;
+  for (const auto& [channelId, recordedChannel] : channels) {
+    if (recordedChannel.messageCount == 0) {
+      continue;
+    }
+    const auto& channel = recordedChannel.channel;
+    uint16_t schemaId = 0;  // No schema
+    if (!channel.schema.empty()) {
+      auto schemaIt = schemaIds.find(channel.schemaName);
+      if (schemaIt == schemaIds.end()) {
+        schemaIt = schemaIds
+                     .emplace(channel.schemaName,
+                              writer.addSchema(channel.schemaName,
+                                               channel.schemaEncoding.value_or("ros2msg"),
+                                               channel.schema))
+                     .first;
+      }
+      schemaId = schemaIt->second;
+    }
+    mcapChannelIds.emplace(channelId, writer.addChannel(schemaId, channel.topic, channel.encoding));
+  }
+
+  std::unordered_map<uint16_t, uint32_t> sequences;
+  for (const auto& message : messages) {
+    const auto channelIt = mcapChannelIds.find(message.channelId);
+    if (channelIt == mcapChannelIds.end()) {
+      continue;  // Recorded after the snapshot of the channels was taken
+    }
+    const auto& rclSerializedMsg = message.msg->get_rcl_serialized_message();
+    writer.writeMessage(channelIt->second, sequences[channelIt->second]++, message.timestamp,
+                        message.timestamp, rclSerializedMsg.buffer,
+                        rclSerializedMsg.buffer_length);
+  }
+
+  writer.close();
+}
+
+}  // namespace foxglove_bridge
@@ -1,5 +1,8 @@
 #include <future>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include <rclcpp/client.hpp>
 #include <rclcpp/serialized_message.hpp>
@@ -50,7 +53,11 @@ std::shared_ptr<void> allocate_message(const MessageMembers* members) {
   }
   memset(buffer, 0, members->size_of_);
   members->init_function(buffer, rosidl_runtime_cpp::MessageInitialization::ALL);
-  return std::shared_ptr<void>(buffer, free);
+  // Strings and sequences of the message are owned by the message and released by fini_function.
+  return std::shared_ptr<void>(buffer, [members](void* message) {
+    members->fini_function(message);
+    free(message);
+  });
 }
 
 std::string getTypeIntrospectionSymbolName(const std::string& serviceType) {
@@ -92,54 +99,76 @@ std::string getServiceTypeSupportHandleSymbolName(const std::string& serviceType
          lengthPrefixedString("rosidl_service_type_support_t") + "v";
 }
 
-GenericClient::GenericClient(rclcpp::node_interfaces::NodeBaseInterface* nodeBase,
-                             rclcpp::node_interfaces::NodeGraphInterface::SharedPtr nodeGraph,
-                             std::string serviceName, std::string serviceType,
-                             rcl_client_options_t& client_options)
-    : rclcpp::ClientBase(nodeBase, nodeGraph) {
-  const auto [pkgName, middleModule, typeName] = extract_type_identifier(serviceType);
+std::shared_ptr<const ServiceTypeSupport> loadServiceTypeSupport(const std::string& serviceType) {
   const auto requestTypeName = serviceType + "_Request";
   const auto responseTypeName = serviceType + "_Response";
+  auto typeSupport = std::make_shared<ServiceTypeSupport>();
 
-  _typeSupportLib = rclcpp::get_typesupport_library(serviceType, TYPESUPPORT_LIB_NAME);
-  _typeIntrospectionLib =
+  typeSupport->typeSupportLib = rclcpp::get_typesupport_library(serviceType, TYPESUPPORT_LIB_NAME);
+  typeSupport->typeIntrospectionLib =
     rclcpp::get_typesupport_library(serviceType, TYPESUPPORT_INTROSPECTION_LIB_NAME);
-  if (!_typeSupportLib || !_typeIntrospectionLib) {
+  if (!typeSupport->typeSupportLib || !typeSupport->typeIntrospectionLib) {
     throw std::runtime_error("Failed to load shared library for service type " + serviceType);
   }
+  auto& typeSupportLib = *typeSupport->typeSupportLib;
 
   const auto typesupportSymbolName = getServiceTypeSupportHandleSymbolName(serviceType);
-  if (!_typeSupportLib->has_symbol(typesupportSymbolName)) {
+  if (!typeSupportLib.has_symbol(typesupportSymbolName)) {
     throw std::runtime_error("Failed to find symbol '" + typesupportSymbolName + "' in " +
-                             _typeSupportLib->get_library_path());
+                             typeSupportLib.get_library_path());
   }
 
   const rosidl_service_type_support_t* (*get_ts)() = nullptr;
-  _serviceTypeSupportHdl =
-    (reinterpret_cast<decltype(get_ts)>(_typeSupportLib->get_symbol(typesupportSymbolName)))();
+  typeSupport->serviceTypeSupportHdl =
+    (reinterpret_cast<decltype(get_ts)>(typeSupportLib.get_symbol(typesupportSymbolName)))();
 
   const auto typeinstrospection_symbol_name = getTypeIntrospectionSymbolName(serviceType);
 
   // This will throw runtime_error if the symbol was not found.
-  _typeIntrospectionHdl = (reinterpret_cast<decltype(get_ts)>(
-    _typeIntrospectionLib->get_symbol(typeinstrospection_symbol_name)))();
+  typeSupport->typeIntrospectionHdl = (reinterpret_cast<decltype(get_ts)>(
+    typeSupport->typeIntrospectionLib->get_symbol(typeinstrospection_symbol_name)))();
 
   // get_typesupport_handle is deprecated since rclcpp 25.0.0
   // (https://github.com/ros2/rclcpp/pull/2209)
 #if RCLCPP_VERSION_GTE(25, 0, 0)
-  _requestTypeSupportHdl =
-    rclcpp::get_message_typesupport_handle(requestTypeName, TYPESUPPORT_LIB_NAME, *_typeSupportLib);
-  _responseTypeSupportHdl = rclcpp::get_message_typesupport_handle(
-    responseTypeName, TYPESUPPORT_LIB_NAME, *_typeSupportLib);
+  typeSupport->requestTypeSupportHdl =
+    rclcpp::get_message_typesupport_handle(requestTypeName, TYPESUPPORT_LIB_NAME, typeSupportLib);
+  typeSupport->responseTypeSupportHdl =
+    rclcpp::get_message_typesupport_handle(responseTypeName, TYPESUPPORT_LIB_NAME, typeSupportLib);
 #else
-  _requestTypeSupportHdl =
-    rclcpp::get_typesupport_handle(requestTypeName, TYPESUPPORT_LIB_NAME, *_typeSupportLib);
-  _responseTypeSupportHdl =
-    rclcpp::get_typesupport_handle(responseTypeName, TYPESUPPORT_LIB_NAME, *_typeSupportLib);
+  typeSupport->requestTypeSupportHdl =
+    rclcpp::get_typesupport_handle(requestTypeName, TYPESUPPORT_LIB_NAME, typeSupportLib);
+  typeSupport->responseTypeSupportHdl =
+    rclcpp::get_typesupport_handle(responseTypeName, TYPESUPPORT_LIB_NAME, typeSupportLib);
 #endif
 
-  rcl_ret_t ret = rcl_client_init(this->get_client_handle().get(), this->get_rcl_node_handle(),
-                                  _serviceTypeSupportHdl, serviceName.c_str(), &client_options);
+  return typeSupport;
+}
+
+/// Looking up and loading the type support libraries goes through the ament index, so the result
+/// is shared by all clients of the same service type. It is released with the last client.
+std::shared_ptr<const ServiceTypeSupport> getServiceTypeSupport(const std::string& serviceType) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<const ServiceTypeSupport>> cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto typeSupport = cache[serviceType].lock()) {
+    return typeSupport;
+  }
+  auto typeSupport = loadServiceTypeSupport(serviceType);
+  cache[serviceType] = typeSupport;
+  return typeSupport;
+}
+
+GenericClient::GenericClient(rclcpp::node_interfaces::NodeBaseInterface* nodeBase,
+                             rclcpp::node_interfaces::NodeGraphInterface::SharedPtr nodeGraph,
+                             std::string serviceName, std::string serviceType,
+                             rcl_client_options_t& client_options)
+    : rclcpp::ClientBase(nodeBase, nodeGraph)
+    , _typeSupport(getServiceTypeSupport(serviceType)) {
+  rcl_ret_t ret =
+    rcl_client_init(this->get_client_handle().get(), this->get_rcl_node_handle(),
+                    _typeSupport->serviceTypeSupportHdl, serviceName.c_str(), &client_options);
   if (ret != RCL_RET_OK) {
     if (ret == RCL_RET_SERVICE_NAME_INVALID) {
       auto rcl_node_handle = this->get_rcl_node_handle();
@@ -153,7 +182,7 @@ GenericClient::GenericClient(rclcpp::node_interfaces::NodeBaseInterface* nodeBas
 }
 
 std::shared_ptr<void> GenericClient::create_response() {
-  auto srv_members = static_cast<const ServiceMembers*>(_typeIntrospectionHdl->data);
+  auto srv_members = static_cast<const ServiceMembers*>(_typeSupport->typeIntrospectionHdl->data);
   return allocate_message(srv_members->response_members_);
 }
 
@@ -166,17 +195,9 @@ void GenericClient::handle_response(std::shared_ptr<rmw_request_id_t> request_he
   std::unique_lock<std::mutex> lock(pending_requests_mutex_);
   int64_t sequence_number = request_header->sequence_number;
 
-  auto ser_response = std::make_shared<rclcpp::SerializedMessage>();
-  rmw_ret_t r = rmw_serialize(response.get(), _responseTypeSupportHdl,
-                              &ser_response->get_rcl_serialized_message());
-  if (r != RMW_RET_OK) {
-    RCUTILS_LOG_ERROR_NAMED("foxglove_bridge", "Failed to serialize service response. Ignoring...");
-    return;
-  }
-
-  // TODO(esteve) this should throw instead since it is not expected to happen in the first place
+  // Responses to requests that were removed (e.g. because they timed out) can still arrive.
   if (this->pending_requests_.count(sequence_number) == 0) {
-    RCUTILS_LOG_ERROR_NAMED("foxglove_bridge", "Received invalid sequence number. Ignoring...");
+    RCUTILS_LOG_DEBUG_NAMED("foxglove_bridge", "Received unknown sequence number. Ignoring...");
     return;
   }
   auto tuple = this->pending_requests_[sequence_number];
@@ -184,10 +205,24 @@ void GenericClient::handle_response(std::shared_ptr<rmw_request_id_t> request_he
   auto callback = std::get<1>(tuple);
   auto future = std::get<2>(tuple);
   this->pending_requests_.erase(sequence_number);
-  // Unlock here to allow the service to be called recursively from one of its callbacks.
+  // Unlock here to allow the service to be called recursively from one of its callbacks, and to
+  // not block other requests while serializing a large response.
   lock.unlock();
 
-  call_promise->set_value(ser_response);
+  // There is no API to take a serialized response, so the response is serialized again. The
+  // buffer is handed to the callback as is, without further copies. The request is no longer
+  // pending, so a failure is handed to the callback as well, for the caller to be answered.
+  try {
+    auto ser_response = std::make_shared<rclcpp::SerializedMessage>();
+    rmw_ret_t r = rmw_serialize(response.get(), _typeSupport->responseTypeSupportHdl,
+                                &ser_response->get_rcl_serialized_message());
+    if (r != RMW_RET_OK) {
+      rclcpp::exceptions::throw_from_rcl_error(r, "failed to serialize service response");
+    }
+    call_promise->set_value(ser_response);
+  } catch (...) {
+    call_promise->set_exception(std::current_exception());
+  }
   callback(future);
 }
 
@@ -197,16 +232,25 @@ GenericClient::SharedFuture GenericClient::async_send_request(SharedRequest requ
 
 GenericClient::SharedFuture GenericClient::async_send_request(SharedRequest request,
                                                               CallbackType&& cb) {
-  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
-  int64_t sequence_number;
+  return async_send_request_with_id(request, std::forward<CallbackType>(cb)).future;
+}
 
-  auto srv_members = static_cast<const ServiceMembers*>(_typeIntrospectionHdl->data);
+GenericClient::FutureAndRequestId GenericClient::async_send_request_with_id(SharedRequest request,
+                                                                            CallbackType&& cb) {
+  auto srv_members = static_cast<const ServiceMembers*>(_typeSupport->typeIntrospectionHdl->data);
   auto buf = allocate_message(srv_members->request_members_);
 
+  // rcl can only send typed requests, hence the request is deserialized first. This happens before
+  // locking, so that large requests do not hold up responses to other requests.
   const rmw_serialized_message_t* sm = &request->get_rcl_serialized_message();
-  if (const auto ret = rmw_deserialize(sm, _requestTypeSupportHdl, buf.get()) != RCL_RET_OK) {
+  if (const auto ret = rmw_deserialize(sm, _typeSupport->requestTypeSupportHdl, buf.get());
+      ret != RMW_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to desirialize request");
   }
+
+  // Locked while sending, so that the response can not be handled before the request is pending.
+  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+  int64_t sequence_number;
   rcl_ret_t ret = rcl_send_request(get_client_handle().get(), buf.get(), &sequence_number);
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
@@ -216,7 +260,12 @@ GenericClient::SharedFuture GenericClient::async_send_request(SharedRequest requ
   SharedFuture f(call_promise->get_future());
   pending_requests_[sequence_number] =
     std::make_tuple(call_promise, std::forward<CallbackType>(cb), f);
-  return f;
+  return {f, sequence_number};
+}
+
+bool GenericClient::remove_pending_request(int64_t request_id) {
+  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+  return pending_requests_.erase(request_id) > 0;
 }
 
 }  // namespace foxglove_bridge
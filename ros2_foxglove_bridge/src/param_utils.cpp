@@ -2,6 +2,7 @@
 
 #include <foxglove_bridge/common.hpp>
 #include <foxglove_bridge/param_utils.hpp>
+#include <foxglove_bridge/regex_utils.hpp>
 
 namespace foxglove_bridge {
 
@@ -187,6 +188,287 @@ void declareParameters(rclcpp::Node* node) {
     "Avoid requesting parameters from previously unresponsive nodes";
   ignUnresponsiveParamNodes.read_only = true;
   node->declare_parameter(PARAM_IGN_UNRESPONSIVE_PARAM_NODES, true, ignUnresponsiveParamNodes);
+
+  auto parameterCacheMaxAgeDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  parameterCacheMaxAgeDescription.name = PARAM_PARAMETER_CACHE_MAX_AGE;
+  parameterCacheMaxAgeDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  parameterCacheMaxAgeDescription.description =
+    "Parameters of other nodes are cached and kept up to date from /parameter_events. Duration "
+    "(seconds) after which the parameters of a node are fetched again, in case events were "
+    "missed. 0 disables the cache.";
+  parameterCacheMaxAgeDescription.floating_point_range.resize(1);
+  parameterCacheMaxAgeDescription.floating_point_range[0].from_value = 0.0;
+  parameterCacheMaxAgeDescription.floating_point_range[0].to_value = 86400.0;
+  parameterCacheMaxAgeDescription.read_only = true;
+  node->declare_parameter(PARAM_PARAMETER_CACHE_MAX_AGE, DEFAULT_PARAMETER_CACHE_MAX_AGE,
+                          parameterCacheMaxAgeDescription);
+
+  auto timeBroadcastRateDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  timeBroadcastRateDescription.name = PARAM_TIME_BROADCAST_RATE;
+  timeBroadcastRateDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  timeBroadcastRateDescription.description =
+    "Rate (Hz) at which the latest /clock time is broadcasted to clients when use_sim_time is "
+    "enabled. 0 means that every /clock message is broadcasted.";
+  timeBroadcastRateDescription.floating_point_range.resize(1);
+  timeBroadcastRateDescription.floating_point_range[0].from_value = 0.0;
+  timeBroadcastRateDescription.floating_point_range[0].to_value = 10000.0;
+  timeBroadcastRateDescription.read_only = true;
+  node->declare_parameter(PARAM_TIME_BROADCAST_RATE, DEFAULT_TIME_BROADCAST_RATE,
+                          timeBroadcastRateDescription);
+
+  auto subscriptionLingerDurationDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  subscriptionLingerDurationDescription.name = PARAM_SUBSCRIPTION_LINGER_DURATION;
+  subscriptionLingerDurationDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  subscriptionLingerDurationDescription.description =
+    "Duration (seconds) for which a ROS subscription is kept alive after the last client "
+    "unsubscribed, so that it can be reused when a client subscribes again. 0 disables lingering.";
+  subscriptionLingerDurationDescription.floating_point_range.resize(1);
+  subscriptionLingerDurationDescription.floating_point_range[0].from_value = 0.0;
+  subscriptionLingerDurationDescription.floating_point_range[0].to_value = 3600.0;
+  subscriptionLingerDurationDescription.read_only = true;
+  node->declare_parameter(PARAM_SUBSCRIPTION_LINGER_DURATION, DEFAULT_SUBSCRIPTION_LINGER_DURATION,
+                          subscriptionLingerDurationDescription);
+
+  auto lastMessageCacheTopicsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  lastMessageCacheTopicsDescription.name = PARAM_LAST_MESSAGE_CACHE_TOPICS;
+  lastMessageCacheTopicsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  lastMessageCacheTopicsDescription.description =
+    "List of regular expressions (ECMAScript) of topics whose last message is cached and sent to "
+    "clients as soon as they subscribe. Matching topics are subscribed to on startup.";
+  lastMessageCacheTopicsDescription.read_only = true;
+  node->declare_parameter(PARAM_LAST_MESSAGE_CACHE_TOPICS, std::vector<std::string>(),
+                          lastMessageCacheTopicsDescription);
+
+  auto lastMessageCacheBudgetDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  lastMessageCacheBudgetDescription.name = PARAM_LAST_MESSAGE_CACHE_BUDGET;
+  lastMessageCacheBudgetDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  lastMessageCacheBudgetDescription.description =
+    "Limit in bytes for the sum of all cached last messages and topic histories. When exceeded, "
+    "the oldest messages of the topic are dropped. 0 means unlimited.";
+  lastMessageCacheBudgetDescription.integer_range.resize(1);
+  lastMessageCacheBudgetDescription.integer_range[0].from_value = 0;
+  lastMessageCacheBudgetDescription.integer_range[0].to_value =
+    std::numeric_limits<int64_t>::max();
+  lastMessageCacheBudgetDescription.read_only = true;
+  node->declare_parameter(PARAM_LAST_MESSAGE_CACHE_BUDGET, DEFAULT_LAST_MESSAGE_CACHE_BUDGET,
+                          lastMessageCacheBudgetDescription);
+
+  auto topicHistoryDurationsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  topicHistoryDurationsDescription.name = PARAM_TOPIC_HISTORY_DURATIONS;
+  topicHistoryDurationsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  topicHistoryDurationsDescription.description =
+    "List of '<pattern>:<seconds>' entries. The messages of the last <seconds> of topics matching "
+    "the regular expression (ECMAScript) are kept, and replayed to clients that request it when "
+    "subscribing. Matching topics are subscribed to on startup. First match wins.";
+  topicHistoryDurationsDescription.read_only = true;
+  node->declare_parameter(PARAM_TOPIC_HISTORY_DURATIONS, std::vector<std::string>(),
+                          topicHistoryDurationsDescription);
+
+  auto topicHistoryMaxBytesDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  topicHistoryMaxBytesDescription.name = PARAM_TOPIC_HISTORY_MAX_BYTES;
+  topicHistoryMaxBytesDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  topicHistoryMaxBytesDescription.description =
+    "Limit in bytes for the history of a single topic. The oldest messages are dropped first. 0 "
+    "means unlimited.";
+  topicHistoryMaxBytesDescription.integer_range.resize(1);
+  topicHistoryMaxBytesDescription.integer_range[0].from_value = 0;
+  topicHistoryMaxBytesDescription.integer_range[0].to_value = std::numeric_limits<int64_t>::max();
+  topicHistoryMaxBytesDescription.read_only = true;
+  node->declare_parameter(PARAM_TOPIC_HISTORY_MAX_BYTES, DEFAULT_TOPIC_HISTORY_MAX_BYTES,
+                          topicHistoryMaxBytesDescription);
+
+  auto flightRecorderTopicsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  flightRecorderTopicsDescription.name = PARAM_FLIGHT_RECORDER_TOPICS;
+  flightRecorderTopicsDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  flightRecorderTopicsDescription.description =
+    "List of regular expressions (ECMAScript) of topics that are continuously recorded in memory, "
+    "and written to an MCAP file when the ~/dump_flight_recording service is called. An empty "
+    "list disables the flight recorder.";
+  flightRecorderTopicsDescription.read_only = true;
+  node->declare_parameter(PARAM_FLIGHT_RECORDER_TOPICS, std::vector<std::string>(),
+                          flightRecorderTopicsDescription);
+
+  auto flightRecorderDurationDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  flightRecorderDurationDescription.name = PARAM_FLIGHT_RECORDER_DURATION;
+  flightRecorderDurationDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  flightRecorderDurationDescription.description =
+    "Duration (seconds) of the most recent messages kept by the flight recorder.";
+  flightRecorderDurationDescription.floating_point_range.resize(1);
+  flightRecorderDurationDescription.floating_point_range[0].from_value = 0.0;
+  flightRecorderDurationDescription.floating_point_range[0].to_value = 3600.0;
+  flightRecorderDurationDescription.read_only = true;
+  node->declare_parameter(PARAM_FLIGHT_RECORDER_DURATION, DEFAULT_FLIGHT_RECORDER_DURATION,
+                          flightRecorderDurationDescription);
+
+  auto flightRecorderMaxBytesDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  flightRecorderMaxBytesDescription.name = PARAM_FLIGHT_RECORDER_MAX_BYTES;
+  flightRecorderMaxBytesDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  flightRecorderMaxBytesDescription.description =
+    "Memory limit in bytes of the flight recorder. When exceeded, the oldest messages are dropped.";
+  flightRecorderMaxBytesDescription.integer_range.resize(1);
+  flightRecorderMaxBytesDescription.integer_range[0].from_value = 0;
+  flightRecorderMaxBytesDescription.integer_range[0].to_value =
+    std::numeric_limits<int64_t>::max();
+  flightRecorderMaxBytesDescription.read_only = true;
+  node->declare_parameter(PARAM_FLIGHT_RECORDER_MAX_BYTES, DEFAULT_FLIGHT_RECORDER_MAX_BYTES,
+                          flightRecorderMaxBytesDescription);
+
+  auto flightRecorderDirectoryDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  flightRecorderDirectoryDescription.name = PARAM_FLIGHT_RECORDER_DIRECTORY;
+  flightRecorderDirectoryDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  flightRecorderDirectoryDescription.description =
+    "Directory the MCAP files of the flight recorder are written to.";
+  flightRecorderDirectoryDescription.read_only = true;
+  node->declare_parameter(PARAM_FLIGHT_RECORDER_DIRECTORY, DEFAULT_FLIGHT_RECORDER_DIRECTORY,
+                          flightRecorderDirectoryDescription);
+
+  auto serviceCallTimeoutDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  serviceCallTimeoutDescription.name = PARAM_SERVICE_CALL_TIMEOUT;
+  serviceCallTimeoutDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  serviceCallTimeoutDescription.description =
+    "Duration (seconds) after which a service call that has not been answered fails. This "
+    "includes the time spent waiting for the service to become available.";
+  serviceCallTimeoutDescription.floating_point_range.resize(1);
+  serviceCallTimeoutDescription.floating_point_range[0].from_value = 0.1;
+  serviceCallTimeoutDescription.floating_point_range[0].to_value = 3600.0;
+  serviceCallTimeoutDescription.read_only = true;
+  node->declare_parameter(PARAM_SERVICE_CALL_TIMEOUT, DEFAULT_SERVICE_CALL_TIMEOUT,
+                          serviceCallTimeoutDescription);
+
+  auto maxConcurrentServiceCallsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  maxConcurrentServiceCallsDescription.name = PARAM_MAX_CONCURRENT_SERVICE_CALLS;
+  maxConcurrentServiceCallsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  maxConcurrentServiceCallsDescription.description =
+    "Maximum number of pending calls per service. Further calls fail immediately.";
+  maxConcurrentServiceCallsDescription.integer_range.resize(1);
+  maxConcurrentServiceCallsDescription.integer_range[0].from_value = 1;
+  maxConcurrentServiceCallsDescription.integer_range[0].to_value = 1000;
+  maxConcurrentServiceCallsDescription.read_only = true;
+  node->declare_parameter(PARAM_MAX_CONCURRENT_SERVICE_CALLS,
+                          DEFAULT_MAX_CONCURRENT_SERVICE_CALLS,
+                          maxConcurrentServiceCallsDescription);
+
+  auto serviceResponseCacheTtlsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  serviceResponseCacheTtlsDescription.name = PARAM_SERVICE_RESPONSE_CACHE_TTLS;
+  serviceResponseCacheTtlsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  serviceResponseCacheTtlsDescription.description =
+    "List of '<pattern>:<seconds>' entries for idempotent services. Responses of services matching "
+    "the regular expression (ECMAScript) are cached for <seconds> per request, and identical "
+    "calls made while one is in flight share its response. 0 seconds only shares responses of "
+    "calls in flight. First match wins.";
+  serviceResponseCacheTtlsDescription.read_only = true;
+  node->declare_parameter(PARAM_SERVICE_RESPONSE_CACHE_TTLS, std::vector<std::string>(),
+                          serviceResponseCacheTtlsDescription);
+
+  auto clientBandwidthLimitDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  clientBandwidthLimitDescription.name = PARAM_CLIENT_BANDWIDTH_LIMIT;
+  clientBandwidthLimitDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  clientBandwidthLimitDescription.description =
+    "Per-client egress bandwidth limit in bytes per second. Messages exceeding a client's quota "
+    "are dropped. 0 means unlimited.";
+  clientBandwidthLimitDescription.integer_range.resize(1);
+  clientBandwidthLimitDescription.integer_range[0].from_value = 0;
+  clientBandwidthLimitDescription.integer_range[0].to_value = std::numeric_limits<int64_t>::max();
+  clientBandwidthLimitDescription.read_only = true;
+  node->declare_parameter(PARAM_CLIENT_BANDWIDTH_LIMIT, 0, clientBandwidthLimitDescription);
+
+  auto clientBandwidthBurstDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  clientBandwidthBurstDescription.name = PARAM_CLIENT_BANDWIDTH_BURST;
+  clientBandwidthBurstDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  clientBandwidthBurstDescription.description =
+    "Capacity in bytes of a client's bandwidth bucket, i.e. the number of bytes that may be sent "
+    "to the client in a burst. 0 means one second worth of the client's limit.";
+  clientBandwidthBurstDescription.integer_range.resize(1);
+  clientBandwidthBurstDescription.integer_range[0].from_value = 0;
+  clientBandwidthBurstDescription.integer_range[0].to_value = std::numeric_limits<int64_t>::max();
+  clientBandwidthBurstDescription.read_only = true;
+  node->declare_parameter(PARAM_CLIENT_BANDWIDTH_BURST, 0, clientBandwidthBurstDescription);
+
+  auto clientBandwidthGroupsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  clientBandwidthGroupsDescription.name = PARAM_CLIENT_BANDWIDTH_GROUPS;
+  clientBandwidthGroupsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  clientBandwidthGroupsDescription.description =
+    "List of '<pattern>:<bytes_per_second>' bandwidth limits overriding client_bandwidth_limit. "
+    "The regular expression (ECMAScript) is matched against the 'group' query parameter of the "
+    "connection URI or, if not given, the client's remote endpoint. First match wins.";
+  clientBandwidthGroupsDescription.read_only = true;
+  node->declare_parameter(PARAM_CLIENT_BANDWIDTH_GROUPS, std::vector<std::string>(),
+                          clientBandwidthGroupsDescription);
+
+  auto globalSendBufferLimitDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  globalSendBufferLimitDescription.name = PARAM_GLOBAL_SEND_BUFFER_LIMIT;
+  globalSendBufferLimitDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  globalSendBufferLimitDescription.description =
+    "Limit in bytes for the sum of all connection send buffers. When exceeded, messages of the "
+    "lowest priority channels are dropped. 0 means unlimited.";
+  globalSendBufferLimitDescription.integer_range.resize(1);
+  globalSendBufferLimitDescription.integer_range[0].from_value = 0;
+  globalSendBufferLimitDescription.integer_range[0].to_value = std::numeric_limits<int64_t>::max();
+  globalSendBufferLimitDescription.read_only = true;
+  node->declare_parameter(PARAM_GLOBAL_SEND_BUFFER_LIMIT, 0, globalSendBufferLimitDescription);
+
+  auto egressCpuBudgetDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  egressCpuBudgetDescription.name = PARAM_EGRESS_CPU_BUDGET;
+  egressCpuBudgetDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  egressCpuBudgetDescription.description =
+    "Fraction of a CPU core that may be spent sending messages to clients. When exceeded, "
+    "messages of the lowest priority channels are dropped. 0 means unlimited.";
+  egressCpuBudgetDescription.floating_point_range.resize(1);
+  egressCpuBudgetDescription.floating_point_range[0].from_value = 0.0;
+  egressCpuBudgetDescription.floating_point_range[0].to_value = 1024.0;
+  egressCpuBudgetDescription.read_only = true;
+  node->declare_parameter(PARAM_EGRESS_CPU_BUDGET, 0.0, egressCpuBudgetDescription);
+
+  auto parameterUpdateIntervalDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  parameterUpdateIntervalDescription.name = PARAM_PARAMETER_UPDATE_INTERVAL;
+  parameterUpdateIntervalDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  parameterUpdateIntervalDescription.description =
+    "Minimum interval (milliseconds) between parameter updates sent to clients. Updates within the "
+    "interval are coalesced, only the latest value of each parameter is sent. 0 disables "
+    "coalescing.";
+  parameterUpdateIntervalDescription.integer_range.resize(1);
+  parameterUpdateIntervalDescription.integer_range[0].from_value = 0;
+  parameterUpdateIntervalDescription.integer_range[0].to_value = 10000;
+  parameterUpdateIntervalDescription.read_only = true;
+  node->declare_parameter(PARAM_PARAMETER_UPDATE_INTERVAL, 0, parameterUpdateIntervalDescription);
+
+  auto topicPrioritiesDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  topicPrioritiesDescription.name = PARAM_TOPIC_PRIORITIES;
+  topicPrioritiesDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  topicPrioritiesDescription.description =
+    "List of '<pattern>:<priority>' entries assigning priority classes to topics matching the "
+    "regular expression (ECMAScript). Higher values are more important, unmatched topics have "
+    "priority 0. First match wins.";
+  topicPrioritiesDescription.read_only = true;
+  node->declare_parameter(PARAM_TOPIC_PRIORITIES, std::vector<std::string>(),
+                          topicPrioritiesDescription);
+
+  auto clientPublishRateLimitsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  clientPublishRateLimitsDescription.name = PARAM_CLIENT_PUBLISH_RATE_LIMITS;
+  clientPublishRateLimitsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  clientPublishRateLimitsDescription.description =
+    "List of '<pattern>:<messages_per_second>' entries limiting the rate at which clients may "
+    "publish on advertised topics matching the regular expression (ECMAScript). First match wins.";
+  clientPublishRateLimitsDescription.read_only = true;
+  node->declare_parameter(PARAM_CLIENT_PUBLISH_RATE_LIMITS, std::vector<std::string>(),
+                          clientPublishRateLimitsDescription);
+
+  auto clientPublishBandwidthLimitsDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  clientPublishBandwidthLimitsDescription.name = PARAM_CLIENT_PUBLISH_BANDWIDTH_LIMITS;
+  clientPublishBandwidthLimitsDescription.type =
+    rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  clientPublishBandwidthLimitsDescription.description =
+    "List of '<pattern>:<bytes_per_second>' entries limiting the bandwidth at which clients may "
+    "publish on advertised topics matching the regular expression (ECMAScript). First match wins.";
+  clientPublishBandwidthLimitsDescription.read_only = true;
+  node->declare_parameter(PARAM_CLIENT_PUBLISH_BANDWIDTH_LIMITS, std::vector<std::string>(),
+                          clientPublishBandwidthLimitsDescription);
 }
 
 std::vector<std::regex> parseRegexStrings(rclcpp::Node* node,
@@ -195,6 +477,9 @@ std::vector<std::regex> parseRegexStrings(rclcpp::Node* node,
   regexVector.reserve(strings.size());
 
   for (const auto& pattern : strings) {
+    if (pattern.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
     try {
       regexVector.push_back(
         std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase));
@@ -207,4 +492,151 @@ std::vector<std::regex> parseRegexStrings(rclcpp::Node* node,
   return regexVector;
 }
 
+std::vector<foxglove_ws::ClientBandwidthQuota> parseClientBandwidthQuotas(
+  rclcpp::Node* node, const std::vector<std::string>& specs) {
+  std::vector<foxglove_ws::ClientBandwidthQuota> quotas;
+  quotas.reserve(specs.size());
+
+  for (const auto& spec : specs) {
+    if (spec.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientBandwidthQuota quota;
+      quota.clientGroupPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      quota.bytesPerSecond = std::stoul(value);
+      quotas.push_back(std::move(quota));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid client bandwidth quota '%s': %s",
+                   spec.c_str(), ex.what());
+    }
+  }
+
+  return quotas;
+}
+
+std::vector<foxglove_ws::ChannelPriority> parseChannelPriorities(
+  rclcpp::Node* node, const std::vector<std::string>& specs) {
+  std::vector<foxglove_ws::ChannelPriority> priorities;
+  priorities.reserve(specs.size());
+
+  for (const auto& spec : specs) {
+    if (spec.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ChannelPriority priority;
+      priority.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      priority.priority = std::stoi(value);
+      priorities.push_back(std::move(priority));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid topic priority '%s': %s", spec.c_str(),
+                   ex.what());
+    }
+  }
+
+  return priorities;
+}
+
+std::vector<foxglove_ws::ChannelHistoryLimit> parseChannelHistoryLimits(
+  rclcpp::Node* node, const std::vector<std::string>& specs, size_t maxBytes) {
+  std::vector<foxglove_ws::ChannelHistoryLimit> limits;
+  limits.reserve(specs.size());
+
+  for (const auto& spec : specs) {
+    if (spec.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ChannelHistoryLimit limit;
+      limit.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      limit.durationSeconds = std::stod(value);
+      limit.maxBytes = maxBytes;
+      if (!(limit.durationSeconds > 0.0)) {
+        throw std::invalid_argument("History duration must be positive");
+      }
+      limits.push_back(std::move(limit));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid topic history duration '%s': %s",
+                   spec.c_str(), ex.what());
+    }
+  }
+
+  return limits;
+}
+
+std::vector<foxglove_ws::ClientPublishLimit> parseClientPublishLimits(
+  rclcpp::Node* node, const std::vector<std::string>& rateSpecs,
+  const std::vector<std::string>& bandwidthSpecs) {
+  std::vector<foxglove_ws::ClientPublishLimit> limits;
+  limits.reserve(rateSpecs.size() + bandwidthSpecs.size());
+
+  for (const auto& spec : rateSpecs) {
+    if (spec.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientPublishLimit limit;
+      limit.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      limit.messagesPerSecond = std::stod(value);
+      limits.push_back(std::move(limit));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid client publish rate limit '%s': %s",
+                   spec.c_str(), ex.what());
+    }
+  }
+
+  for (const auto& spec : bandwidthSpecs) {
+    if (spec.empty()) {
+      continue;  // Placeholder entry of an empty list, see the launch file
+    }
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      foxglove_ws::ClientPublishLimit limit;
+      limit.topicPattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      limit.bytesPerSecond = std::stoul(value);
+      limits.push_back(std::move(limit));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid client publish bandwidth limit '%s': %s",
+                   spec.c_str(), ex.what());
+    }
+  }
+
+  return limits;
+}
+
+std::vector<ServiceResponseCacheTtl> parseServiceResponseCacheTtls(
+  rclcpp::Node* node, const std::vector<std::string>& specs) {
+  std::vector<ServiceResponseCacheTtl> ttls;
+  ttls.reserve(specs.size());
+
+  for (const auto& spec : specs) {
+    try {
+      const auto [pattern, value] = foxglove_ws::splitPatternSpec(spec);
+      ServiceResponseCacheTtl ttl;
+      ttl.servicePattern =
+        std::regex(pattern, std::regex_constants::ECMAScript | std::regex_constants::icase);
+      ttl.ttlSeconds = std::stod(value);
+      if (!(ttl.ttlSeconds >= 0.0)) {
+        throw std::invalid_argument("Cache duration must not be negative");
+      }
+      ttls.push_back(std::move(ttl));
+    } catch (const std::exception& ex) {
+      RCLCPP_ERROR(node->get_logger(), "Ignoring invalid service response cache entry '%s': %s",
+                   spec.c_str(), ex.what());
+    }
+  }
+
+  return ttls;
+}
+
 }  // namespace foxglove_bridge
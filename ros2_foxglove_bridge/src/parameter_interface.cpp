@@ -1,5 +1,8 @@
 #include "foxglove_bridge/parameter_interface.hpp"
 
+#include <atomic>
+#include <iterator>
+
 #include <nlohmann/json.hpp>
 #include <rclcpp/qos.hpp>
 #include <rclcpp/version.h>
@@ -10,12 +13,61 @@
 namespace {
 
 constexpr char PARAM_SEP = '.';
+// Parameter updates are collected for up to this long before they are sent, so that a node setting
+// many parameters at once results in a single update.
+constexpr std::chrono::milliseconds PARAM_UPDATE_BATCH_WINDOW(10);
+// Interval at which requests to nodes are checked for having timed out.
+constexpr std::chrono::milliseconds NODE_REQUEST_EXPIRY_INTERVAL(100);
+
+/// State of a get request, shared by the responses of the nodes involved.
+struct GetParamsRequest {
+  foxglove_bridge::ParamResultFunc resultFunc;
+  std::mutex mutex;
+  size_t pendingNodes;
+  foxglove_bridge::ParameterList result;
+
+  GetParamsRequest(foxglove_bridge::ParamResultFunc func, size_t nodeCount)
+      : resultFunc(std::move(func))
+      , pendingNodes(nodeCount) {}
+
+  /// Add the result of one node. The request is answered once, when the last node is done.
+  void nodeDone(foxglove_bridge::ParameterList params) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      result.insert(result.end(), std::make_move_iterator(params.begin()),
+                    std::make_move_iterator(params.end()));
+      if (--pendingNodes > 0) {
+        return;
+      }
+    }
+    resultFunc(result);
+  }
+};
+
+/// State of a set request, shared by the responses of the nodes involved.
+struct SetParamsRequest {
+  foxglove_bridge::ParamSetDoneFunc doneFunc;
+  std::atomic<size_t> pendingNodes;
+
+  SetParamsRequest(foxglove_bridge::ParamSetDoneFunc func, size_t nodeCount)
+      : doneFunc(std::move(func))
+      , pendingNodes(nodeCount) {}
+
+  void nodeDone() {
+    if (--pendingNodes == 0 && doneFunc) {
+      doneFunc();
+    }
+  }
+};
 
 #if RCLCPP_VERSION_MAJOR > 16
 const rclcpp::ParametersQoS parameterQoS;
 #else
 const rmw_qos_profile_t& parameterQoS = rmw_qos_profile_parameters;
 #endif
+const rclcpp::QoS parameterEventsQoS(
+  rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events),
+  rmw_qos_profile_parameter_events);
 
 static std::pair<std::string, std::string> getNodeAndParamName(
   const std::string& nodeNameAndParamName) {
@@ -128,6 +180,24 @@ static foxglove_ws::Parameter fromRosParam(const rclcpp::Parameter& p) {
   }
 }
 
+/// Append the given parameters of a node, or all of them if `paramNames` is empty.
+static void appendNodeParameters(const foxglove_bridge::NodeParameters& nodeParams,
+                                 const std::vector<std::string>& paramNames,
+                                 foxglove_bridge::ParameterList& result) {
+  if (paramNames.empty()) {
+    for (const auto& [paramName, param] : nodeParams.params) {
+      result.push_back(param);
+    }
+    return;
+  }
+  for (const auto& paramName : paramNames) {
+    const auto paramIt = nodeParams.params.find(paramName);
+    if (paramIt != nodeParams.params.end()) {
+      result.push_back(paramIt->second);
+    }
+  }
+}
+
 }  // namespace
 
 namespace foxglove_bridge {
@@ -136,19 +206,44 @@ using foxglove_ws::isWhitelisted;
 
 ParameterInterface::ParameterInterface(rclcpp::Node* node,
                                        std::vector<std::regex> paramWhitelistPatterns,
-                                       UnresponsiveNodePolicy unresponsiveNodePolicy)
+                                       UnresponsiveNodePolicy unresponsiveNodePolicy,
+                                       std::chrono::duration<double> cacheMaxAge)
     : _node(node)
     , _paramWhitelistPatterns(paramWhitelistPatterns)
     , _callbackGroup(node->create_callback_group(rclcpp::CallbackGroupType::Reentrant))
     , _ignoredNodeNames({node->get_fully_qualified_name()})
-    , _unresponsiveNodePolicy(unresponsiveNodePolicy) {}
+    , _unresponsiveNodePolicy(unresponsiveNodePolicy)
+    , _cacheMaxAge(cacheMaxAge) {
+  // A single subscription serves both the cache and the parameter subscriptions of all nodes, so
+  // that every event is only received and deserialized once.
+  rclcpp::SubscriptionOptions subscriptionOptions;
+  subscriptionOptions.callback_group = _callbackGroup;
+  _paramEventsSubscription = _node->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", parameterEventsQoS,
+    [this](rcl_interfaces::msg::ParameterEvent::ConstSharedPtr event) {
+      if (_cacheMaxAge.count() > 0.0) {
+        updateParamCache(*event);
+      }
+      queueParamUpdates(*event);
+    },
+    subscriptionOptions);
+
+  _nodeRequestTimer = _node->create_wall_timer(
+    NODE_REQUEST_EXPIRY_INTERVAL,
+    [this]() {
+      expireNodeRequests();
+    },
+    _callbackGroup);
+}
 
-ParameterList ParameterInterface::getParams(const std::vector<std::string>& paramNames,
-                                            const std::chrono::duration<double>& timeout) {
-  std::lock_guard<std::mutex> lock(_mutex);
+void ParameterInterface::getParams(const std::vector<std::string>& paramNames,
+                                   const std::chrono::duration<double>& timeout,
+                                   ParamResultFunc resultFunc) {
+  std::unique_lock<std::mutex> lock(_mutex);
 
   std::unordered_map<std::string, std::vector<std::string>> paramNamesByNodeName;
   const auto thisNode = _node->get_fully_qualified_name();
+  const bool useCache = _cacheMaxAge.count() > 0.0;
 
   if (!paramNames.empty()) {
     // Break apart fully qualified {node_name}.{param_name} strings and build a
@@ -196,60 +291,112 @@ ParameterList ParameterInterface::getParams(const std::vector<std::string>& para
                    paramNamesByNodeName.size());
     }
   }
-
-  std::unordered_map<std::string, std::future<ParameterList>> getParametersFuture;
-  for (const auto& [nodeName, nodeParamNames] : paramNamesByNodeName) {
-    if (nodeName == thisNode) {
-      continue;
+  paramNamesByNodeName.erase(thisNode);
+
+  ParameterList cachedResult;
+  uint64_t fetchStartEventCount = 0;
+  if (useCache) {
+    // Answer from the cache where possible, only nodes that are unknown (or whose parameters are
+    // too old) are called below.
+    std::lock_guard<std::mutex> cacheLock(_cacheMutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (paramNames.empty()) {
+      // Drop nodes that are gone
+      for (auto cacheIt = _paramCache.begin(); cacheIt != _paramCache.end();) {
+        if (paramNamesByNodeName.find(cacheIt->first) == paramNamesByNodeName.end()) {
+          cacheIt = _paramCache.erase(cacheIt);
+        } else {
+          ++cacheIt;
+        }
+      }
     }
-
-    auto paramClientIt = _paramClientsByNode.find(nodeName);
-    if (paramClientIt == _paramClientsByNode.end()) {
-      const auto insertedPair = _paramClientsByNode.emplace(
-        nodeName,
-        rclcpp::AsyncParametersClient::make_shared(_node, nodeName, parameterQoS, _callbackGroup));
-      paramClientIt = insertedPair.first;
+    for (auto nodeIt = paramNamesByNodeName.begin(); nodeIt != paramNamesByNodeName.end();) {
+      const auto cacheIt = _paramCache.find(nodeIt->first);
+      if (cacheIt != _paramCache.end() && now - cacheIt->second.fetchTime < _cacheMaxAge) {
+        appendNodeParameters(cacheIt->second, nodeIt->second, cachedResult);
+        nodeIt = paramNamesByNodeName.erase(nodeIt);
+      } else {
+        ++nodeIt;
+      }
     }
+    fetchStartEventCount = _paramEventCount;
 
-    getParametersFuture.emplace(
-      nodeName, std::async(std::launch::async, &ParameterInterface::getNodeParameters, this,
-                           paramClientIt->second, nodeName, nodeParamNames, timeout));
-  }
-
-  ParameterList result;
-  for (auto& [nodeName, future] : getParametersFuture) {
-    try {
-      const auto params = future.get();
-      result.insert(result.begin(), params.begin(), params.end());
-    } catch (const std::exception& e) {
-      RCLCPP_ERROR(_node->get_logger(), "Failed to retrieve parameters from node '%s': %s",
-                   nodeName.c_str(), e.what());
-
-      if (_unresponsiveNodePolicy == UnresponsiveNodePolicy::Ignore) {
-        // Certain nodes may fail to handle incoming service requests — for example, if they're
-        // stuck in a busy loop or otherwise unresponsive. In such cases, attempting to retrieve
-        // parameter names or values can result in timeouts. To avoid repeated failures, these nodes
-        // are added to an ignore list, and future parameter-related service calls to them will be
-        // skipped.
-        _ignoredNodeNames.insert(nodeName);
-        RCLCPP_WARN(_node->get_logger(),
-                    "Adding node %s to the ignore list to prevent repeated timeouts or failures in "
-                    "future parameter requests.",
-                    nodeName.c_str());
-      }
+    if (!paramNamesByNodeName.empty()) {
+      RCLCPP_DEBUG(_node->get_logger(), "Fetching parameters of %zu uncached nodes...",
+                   paramNamesByNodeName.size());
     }
   }
 
-  return result;
+  std::vector<std::pair<std::string, rclcpp::AsyncParametersClient::SharedPtr>> paramClients;
+  for (const auto& [nodeName, nodeParamNames] : paramNamesByNodeName) {
+    paramClients.emplace_back(nodeName, getParamClient(nodeName));
+  }
+  // Node responses may arrive (or fail) right away and need the lock.
+  lock.unlock();
+
+  // The cached parameters count as one more node, so that they are delivered through the same
+  // path as the responses.
+  auto request =
+    std::make_shared<GetParamsRequest>(std::move(resultFunc), paramNamesByNodeName.size() + 1);
+  for (const auto& [nodeName, paramClient] : paramClients) {
+    auto requestedParamNames = std::move(paramNamesByNodeName.at(nodeName));
+    // All parameters of a node are fetched when caching, so that later requests can be answered
+    // from the cache.
+    const auto fetchedParamNames = useCache ? std::vector<std::string>{} : requestedParamNames;
+
+    getNodeParameters(
+      paramClient, nodeName, fetchedParamNames, timeout,
+      [this, request, nodeName = nodeName, requestedParamNames = std::move(requestedParamNames),
+       useCache, fetchStartEventCount](ParameterList params) {
+        if (!useCache) {
+          request->nodeDone(std::move(params));
+          return;
+        }
+
+        NodeParameters nodeParams;
+        nodeParams.fetchTime = std::chrono::steady_clock::now();
+        for (auto& param : params) {
+          const auto paramName = getNodeAndParamName(param.getName()).second;
+          nodeParams.params.emplace(paramName, std::move(param));
+        }
+        ParameterList result;
+        appendNodeParameters(nodeParams, requestedParamNames, result);
+
+        {
+          // Not cached if the parameters were changed while fetching them, as the fetched values
+          // may be outdated already.
+          std::lock_guard<std::mutex> cacheLock(_cacheMutex);
+          const auto lastEventIt = _lastParamEventByNode.find(nodeName);
+          if (lastEventIt == _lastParamEventByNode.end() ||
+              lastEventIt->second <= fetchStartEventCount) {
+            _paramCache.insert_or_assign(nodeName, std::move(nodeParams));
+          }
+        }
+        request->nodeDone(std::move(result));
+      },
+      [this, request, nodeName = nodeName](const std::string& error) {
+        RCLCPP_ERROR(_node->get_logger(), "Failed to retrieve parameters from node '%s': %s",
+                     nodeName.c_str(), error.c_str());
+        handleUnresponsiveNode(nodeName);
+        request->nodeDone({});
+      });
+  }
+
+  request->nodeDone(std::move(cachedResult));
 }
 
 void ParameterInterface::setParams(const ParameterList& parameters,
-                                   const std::chrono::duration<double>& timeout) {
-  std::lock_guard<std::mutex> lock(_mutex);
+                                   const std::chrono::duration<double>& timeout,
+                                   ParamSetDoneFunc doneFunc) {
+  std::unique_lock<std::mutex> lock(_mutex);
 
   rclcpp::ParameterMap paramsByNode;
   for (const auto& param : parameters) {
     if (!isWhitelisted(param.getName(), _paramWhitelistPatterns)) {
+      lock.unlock();
+      if (doneFunc) {
+        doneFunc();
+      }
       return;
     }
 
@@ -258,149 +405,290 @@ void ParameterInterface::setParams(const ParameterList& parameters,
     paramsByNode[nodeName].emplace_back(paramName, rosParam.get_parameter_value());
   }
 
-  std::vector<std::future<void>> setParametersFuture;
+  std::vector<std::pair<std::string, rclcpp::AsyncParametersClient::SharedPtr>> paramClients;
   for (const auto& [nodeName, params] : paramsByNode) {
-    auto paramClientIt = _paramClientsByNode.find(nodeName);
-    if (paramClientIt == _paramClientsByNode.end()) {
-      const auto insertedPair = _paramClientsByNode.emplace(
-        nodeName,
-        rclcpp::AsyncParametersClient::make_shared(_node, nodeName, parameterQoS, _callbackGroup));
-      paramClientIt = insertedPair.first;
+    paramClients.emplace_back(nodeName, getParamClient(nodeName));
+  }
+  lock.unlock();
+
+  if (paramsByNode.empty()) {
+    if (doneFunc) {
+      doneFunc();
     }
+    return;
+  }
 
-    setParametersFuture.emplace_back(std::async(std::launch::async,
-                                                &ParameterInterface::setNodeParameters, this,
-                                                paramClientIt->second, nodeName, params, timeout));
+  // Invalidated before the requests are sent, so that a get request right after this one is not
+  // answered with the previous values from the cache.
+  for (const auto& [nodeName, params] : paramsByNode) {
+    invalidateParamCache(nodeName);
   }
 
-  for (auto& future : setParametersFuture) {
-    try {
-      future.get();
-    } catch (const std::exception& e) {
-      RCLCPP_ERROR(_node->get_logger(), "Exception when setting parameters: %s", e.what());
-    }
+  auto request = std::make_shared<SetParamsRequest>(std::move(doneFunc), paramsByNode.size());
+  for (const auto& [nodeName, paramClient] : paramClients) {
+    setNodeParameters(paramClient, nodeName, paramsByNode.at(nodeName), timeout,
+                      [request]() {
+                        request->nodeDone();
+                      });
   }
 }
 
 void ParameterInterface::subscribeParams(const std::vector<std::string>& paramNames) {
-  std::lock_guard<std::mutex> lock(_mutex);
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
 
-  std::unordered_set<std::string> nodesToSubscribe;
   for (const auto& paramName : paramNames) {
     if (!isWhitelisted(paramName, _paramWhitelistPatterns)) {
-      return;
+      continue;
     }
 
     const auto& [nodeName, paramN] = getNodeAndParamName(paramName);
-    auto [subscribedParamsit, wasNewlyCreated] = _subscribedParamsByNode.try_emplace(nodeName);
+    _subscribedParamsByNode[nodeName].insert(paramN);
+  }
+}
 
-    auto& subscribedNodeParams = subscribedParamsit->second;
-    subscribedNodeParams.insert(paramN);
+void ParameterInterface::unsubscribeParams(const std::vector<std::string>& paramNames) {
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
 
-    if (wasNewlyCreated) {
-      nodesToSubscribe.insert(nodeName);
-    }
-  }
+  for (const auto& paramName : paramNames) {
+    const auto& [nodeName, paramN] = getNodeAndParamName(paramName);
+
+    const auto subscribedNodeParamsIt = _subscribedParamsByNode.find(nodeName);
+    if (subscribedNodeParamsIt != _subscribedParamsByNode.end()) {
+      subscribedNodeParamsIt->second.erase(paramN);
 
-  for (const auto& nodeName : nodesToSubscribe) {
-    auto paramClientIt = _paramClientsByNode.find(nodeName);
-    if (paramClientIt == _paramClientsByNode.end()) {
-      const auto insertedPair = _paramClientsByNode.emplace(
-        nodeName,
-        rclcpp::AsyncParametersClient::make_shared(_node, nodeName, parameterQoS, _callbackGroup));
-      paramClientIt = insertedPair.first;
+      if (subscribedNodeParamsIt->second.empty()) {
+        _subscribedParamsByNode.erase(subscribedNodeParamsIt);
+      }
     }
+  }
+}
 
-    auto& paramClient = paramClientIt->second;
+void ParameterInterface::queueParamUpdates(const rcl_interfaces::msg::ParameterEvent& event) {
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  const auto subscribedNodeParamsIt = _subscribedParamsByNode.find(event.node);
+  if (subscribedNodeParamsIt == _subscribedParamsByNode.end()) {
+    return;
+  }
 
-    _paramSubscriptionsByNode[nodeName] = paramClient->on_parameter_event(
-      [this, nodeName](rcl_interfaces::msg::ParameterEvent::ConstSharedPtr msg) {
-        RCLCPP_DEBUG(_node->get_logger(), "Retrieved param update for node %s: %zu params changed",
-                     nodeName.c_str(), msg->changed_parameters.size());
+  RCLCPP_DEBUG(_node->get_logger(), "Retrieved param update for node %s: %zu params changed",
+               event.node.c_str(), event.changed_parameters.size());
 
-        ParameterList result;
-        const auto& subscribedNodeParams = _subscribedParamsByNode[nodeName];
-        for (const auto& param : msg->changed_parameters) {
-          if (subscribedNodeParams.find(param.name) != subscribedNodeParams.end()) {
-            result.push_back(fromRosParam(
-              rclcpp::Parameter(prependNodeNameToParamName(param.name, nodeName), param.value)));
-          }
-        }
+  const auto& subscribedNodeParams = subscribedNodeParamsIt->second;
+  for (const auto& param : event.changed_parameters) {
+    if (subscribedNodeParams.find(param.name) != subscribedNodeParams.end()) {
+      const auto fullParamName = prependNodeNameToParamName(param.name, event.node);
+      // Only the latest value of a parameter that changed repeatedly within the window is sent.
+      _pendingParamUpdates.insert_or_assign(
+        fullParamName, fromRosParam(rclcpp::Parameter(fullParamName, param.value)));
+    }
+  }
 
-        if (!result.empty() && _paramUpdateFunc) {
-          _paramUpdateFunc(result);
-        }
-      });
+  // The first update of a window arms a timer that sends all updates at the end of the window.
+  if (!_pendingParamUpdates.empty() && !_paramUpdateTimer) {
+    _paramUpdateTimer = _node->create_wall_timer(
+      PARAM_UPDATE_BATCH_WINDOW,
+      [this]() {
+        sendParamUpdates();
+      },
+      _callbackGroup);
   }
 }
 
-void ParameterInterface::unsubscribeParams(const std::vector<std::string>& paramNames) {
-  std::lock_guard<std::mutex> lock(_mutex);
+void ParameterInterface::sendParamUpdates() {
+  ParameterList updates;
+  ParamUpdateFunc paramUpdateFunc;
+  {
+    // The timer is one-shot: it is cancelled and released from its own callback, and the next
+    // queued update arms a new one.
+    std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+    if (_paramUpdateTimer) {
+      _paramUpdateTimer->cancel();
+      _paramUpdateTimer.reset();
+    }
+    updates.reserve(_pendingParamUpdates.size());
+    for (auto& [paramName, param] : _pendingParamUpdates) {
+      updates.push_back(std::move(param));
+    }
+    _pendingParamUpdates.clear();
+    paramUpdateFunc = _paramUpdateFunc;
+  }
 
-  for (const auto& paramName : paramNames) {
-    const auto& [nodeName, paramN] = getNodeAndParamName(paramName);
+  if (!updates.empty() && paramUpdateFunc) {
+    paramUpdateFunc(updates);
+  }
+}
 
-    const auto subscribedNodeParamsIt = _subscribedParamsByNode.find(nodeName);
-    if (subscribedNodeParamsIt != _subscribedParamsByNode.end()) {
-      subscribedNodeParamsIt->second.erase(subscribedNodeParamsIt->second.find(paramN));
+void ParameterInterface::updateParamCache(const rcl_interfaces::msg::ParameterEvent& event) {
+  std::lock_guard<std::mutex> lock(_cacheMutex);
+  _lastParamEventByNode[event.node] = ++_paramEventCount;
+  const auto cacheIt = _paramCache.find(event.node);
+  if (cacheIt == _paramCache.end()) {
+    return;  // Parameters of unknown nodes are fetched once requested
+  }
 
-      if (subscribedNodeParamsIt->second.empty()) {
-        _subscribedParamsByNode.erase(subscribedNodeParamsIt);
-        _paramSubscriptionsByNode.erase(_paramSubscriptionsByNode.find(nodeName));
+  auto& params = cacheIt->second.params;
+  for (const auto* eventParams : {&event.new_parameters, &event.changed_parameters}) {
+    for (const auto& param : *eventParams) {
+      const auto fullParamName = prependNodeNameToParamName(param.name, event.node);
+      if (!isWhitelisted(fullParamName, _paramWhitelistPatterns)) {
+        continue;
+      }
+      try {
+        params.insert_or_assign(param.name,
+                                fromRosParam(rclcpp::Parameter(fullParamName, param.value)));
+      } catch (const std::exception& ex) {
+        params.erase(param.name);
+        RCLCPP_DEBUG(_node->get_logger(), "Not caching parameter %s: %s", fullParamName.c_str(),
+                     ex.what());
       }
     }
   }
+  for (const auto& param : event.deleted_parameters) {
+    params.erase(param.name);
+  }
+}
+
+void ParameterInterface::invalidateParamCache(const std::string& nodeName) {
+  // Counted as a parameter event, so that parameters being fetched right now are not cached.
+  std::lock_guard<std::mutex> lock(_cacheMutex);
+  _lastParamEventByNode[nodeName] = ++_paramEventCount;
+  _paramCache.erase(nodeName);
 }
 
 void ParameterInterface::setParamUpdateCallback(ParamUpdateFunc paramUpdateFunc) {
-  std::lock_guard<std::mutex> lock(_mutex);
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
   _paramUpdateFunc = paramUpdateFunc;
 }
 
-ParameterList ParameterInterface::getNodeParameters(
+rclcpp::AsyncParametersClient::SharedPtr ParameterInterface::getParamClient(
+  const std::string& nodeName) {
+  auto paramClientIt = _paramClientsByNode.find(nodeName);
+  if (paramClientIt == _paramClientsByNode.end()) {
+    const auto insertedPair = _paramClientsByNode.emplace(
+      nodeName,
+      rclcpp::AsyncParametersClient::make_shared(_node, nodeName, parameterQoS, _callbackGroup));
+    paramClientIt = insertedPair.first;
+  }
+  return paramClientIt->second;
+}
+
+void ParameterInterface::getNodeParameters(
   const rclcpp::AsyncParametersClient::SharedPtr paramClient, const std::string& nodeName,
-  const std::vector<std::string>& paramNames, const std::chrono::duration<double>& timeout) {
+  const std::vector<std::string>& paramNames, const std::chrono::duration<double>& timeout,
+  std::function<void(ParameterList)> onSuccess, std::function<void(const std::string&)> onFailure) {
   if (!paramClient->service_is_ready()) {
-    throw std::runtime_error("Parameter service for node '" + nodeName + "' is not ready");
+    onFailure("Parameter service for node '" + nodeName + "' is not ready");
+    return;
   }
 
-  auto paramsToRequest = paramNames;
-  if (paramsToRequest.empty()) {
-    // `paramNames` is empty, list all parameter names for this node
-    auto future = paramClient->list_parameters({}, 0UL);
-    if (std::future_status::ready != future.wait_for(timeout)) {
-      throw std::runtime_error("Failed to retrieve parameter names for node '" + nodeName + "'");
-    }
-    paramsToRequest = future.get().names;
-  }
+  // The timeout covers listing the parameter names as well as getting their values.
+  const auto requestId = addNodeRequest(timeout, [onFailure, nodeName]() {
+    onFailure("Timed out waiting for parameters from node '" + nodeName + "'");
+  });
+
+  auto getParameters = [this, paramClient, nodeName, requestId, onSuccess,
+                        onFailure](const std::vector<std::string>& paramsToRequest) {
+    paramClient->get_parameters(
+      paramsToRequest, [this, nodeName, requestId, onSuccess,
+                        onFailure](std::shared_future<std::vector<rclcpp::Parameter>> future) {
+        if (!finishNodeRequest(requestId)) {
+          return;  // Timed out already
+        }
 
-  // Start parameter fetches and wait for them to complete
-  auto getParamsFuture = paramClient->get_parameters(paramsToRequest);
-  if (std::future_status::ready != getParamsFuture.wait_for(timeout)) {
-    throw std::runtime_error("Timed out waiting for " + std::to_string(paramsToRequest.size()) +
-                             " parameter(s) from node '" + nodeName + "'");
-  }
-  const auto params = getParamsFuture.get();
+        ParameterList result;
+        try {
+          for (const auto& param : future.get()) {
+            const auto fullParamName = prependNodeNameToParamName(param.get_name(), nodeName);
+            if (isWhitelisted(fullParamName, _paramWhitelistPatterns)) {
+              result.push_back(
+                fromRosParam(rclcpp::Parameter(fullParamName, param.get_parameter_value())));
+            }
+          }
+        } catch (const std::exception& ex) {
+          onFailure(ex.what());
+          return;
+        }
+        onSuccess(std::move(result));
+      });
+  };
 
-  ParameterList result;
-  for (const auto& param : params) {
-    const auto fullParamName = prependNodeNameToParamName(param.get_name(), nodeName);
-    if (isWhitelisted(fullParamName, _paramWhitelistPatterns)) {
-      result.push_back(fromRosParam(rclcpp::Parameter(fullParamName, param.get_parameter_value())));
-    }
+  if (!paramNames.empty()) {
+    getParameters(paramNames);
+    return;
   }
-  return result;
+
+  // `paramNames` is empty, list all parameter names for this node first
+  paramClient->list_parameters(
+    {}, 0UL,
+    [this, requestId, onFailure,
+     getParameters](std::shared_future<rcl_interfaces::msg::ListParametersResult> future) {
+      if (!isNodeRequestPending(requestId)) {
+        return;  // Timed out already
+      }
+
+      std::vector<std::string> paramsToRequest;
+      try {
+        paramsToRequest = future.get().names;
+      } catch (const std::exception& ex) {
+        if (finishNodeRequest(requestId)) {
+          onFailure(ex.what());
+        }
+        return;
+      }
+      getParameters(paramsToRequest);
+    });
 }
 
 void ParameterInterface::setNodeParameters(rclcpp::AsyncParametersClient::SharedPtr paramClient,
                                            const std::string& nodeName,
                                            const std::vector<rclcpp::Parameter>& params,
-                                           const std::chrono::duration<double>& timeout) {
+                                           const std::chrono::duration<double>& timeout,
+                                           ParamSetDoneFunc doneFunc) {
   if (!paramClient->service_is_ready()) {
-    throw std::runtime_error("Parameter service for node '" + nodeName + "' is not ready");
+    RCLCPP_ERROR(_node->get_logger(), "Parameter service for node '%s' is not ready",
+                 nodeName.c_str());
+    doneFunc();
+    return;
   }
 
-  auto future = paramClient->set_parameters(params);
+  // Invalidated again once the node responded, as the parameters may have been fetched in the
+  // meantime, and the parameter events of the update may arrive after the response.
+  auto invalidateCache = [this, nodeName]() {
+    invalidateParamCache(nodeName);
+  };
+
+  const auto requestId = addNodeRequest(timeout, [this, nodeName, numParams = params.size(),
+                                                  invalidateCache, doneFunc]() {
+    RCLCPP_ERROR(_node->get_logger(),
+                 "Param client failed to set %zu parameter(s) for node '%s' within the given "
+                 "timeout",
+                 numParams, nodeName.c_str());
+    invalidateCache();
+    doneFunc();
+  });
+
+  paramClient->set_parameters(
+    params, [this, nodeName, requestId, invalidateCache,
+             doneFunc](std::shared_future<std::vector<rcl_interfaces::msg::SetParametersResult>>
+                         future) {
+      if (!finishNodeRequest(requestId)) {
+        return;  // Timed out already
+      }
+
+      try {
+        for (const auto& result : future.get()) {
+          if (!result.successful) {
+            RCLCPP_WARN(_node->get_logger(),
+                        "Failed to set one or more parameters for node '%s': %s",
+                        nodeName.c_str(), result.reason.c_str());
+          }
+        }
+      } catch (const std::exception& ex) {
+        RCLCPP_ERROR(_node->get_logger(), "Exception when setting parameters: %s", ex.what());
+      }
+      invalidateCache();
+      doneFunc();
+    });
 
   std::vector<std::string> paramsToDelete;
   for (const auto& p : params) {
@@ -408,29 +696,70 @@ void ParameterInterface::setNodeParameters(rclcpp::AsyncParametersClient::Shared
       paramsToDelete.push_back(p.get_name());
     }
   }
-
   if (!paramsToDelete.empty()) {
-    auto deleteFuture = paramClient->delete_parameters(paramsToDelete);
-    if (std::future_status::ready != deleteFuture.wait_for(timeout)) {
-      RCLCPP_WARN(
-        _node->get_logger(),
-        "Param client failed to delete %zu parameter(s) for node '%s' within the given timeout",
-        paramsToDelete.size(), nodeName.c_str());
-    }
+    // Best effort, the outcome is reflected by the parameter values sent back to the client.
+    paramClient->delete_parameters(paramsToDelete);
   }
+}
 
-  if (std::future_status::ready != future.wait_for(timeout)) {
-    throw std::runtime_error("Param client failed to set " + std::to_string(params.size()) +
-                             " parameter(s) for node '" + nodeName + "' within the given timeout");
+void ParameterInterface::handleUnresponsiveNode(const std::string& nodeName) {
+  if (_unresponsiveNodePolicy != UnresponsiveNodePolicy::Ignore) {
+    return;
   }
 
-  const auto setParamResults = future.get();
-  for (auto& result : setParamResults) {
-    if (!result.successful) {
-      RCLCPP_WARN(_node->get_logger(), "Failed to set one or more parameters for node '%s': %s",
-                  nodeName.c_str(), result.reason.c_str());
+  // Certain nodes may fail to handle incoming service requests — for example, if they're
+  // stuck in a busy loop or otherwise unresponsive. In such cases, attempting to retrieve
+  // parameter names or values can result in timeouts. To avoid repeated failures, these nodes
+  // are added to an ignore list, and future parameter-related service calls to them will be
+  // skipped.
+  std::lock_guard<std::mutex> lock(_mutex);
+  _ignoredNodeNames.insert(nodeName);
+  RCLCPP_WARN(_node->get_logger(),
+              "Adding node %s to the ignore list to prevent repeated timeouts or failures in "
+              "future parameter requests.",
+              nodeName.c_str());
+}
+
+uint64_t ParameterInterface::addNodeRequest(const std::chrono::duration<double>& timeout,
+                                            std::function<void()> expire) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto requestId = _nextNodeRequestId++;
+  _pendingNodeRequests.emplace(
+    requestId,
+    PendingNodeRequest{std::chrono::steady_clock::now() +
+                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout),
+                       std::move(expire)});
+  return requestId;
+}
+
+bool ParameterInterface::finishNodeRequest(uint64_t requestId) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pendingNodeRequests.erase(requestId) > 0;
+}
+
+bool ParameterInterface::isNodeRequestPending(uint64_t requestId) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pendingNodeRequests.find(requestId) != _pendingNodeRequests.end();
+}
+
+void ParameterInterface::expireNodeRequests() {
+  std::vector<std::function<void()>> expired;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = _pendingNodeRequests.begin(); it != _pendingNodeRequests.end();) {
+      if (it->second.deadline <= now) {
+        expired.push_back(std::move(it->second.expire));
+        it = _pendingNodeRequests.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
+
+  for (const auto& expire : expired) {
+    expire();
+  }
 }
 
 }  // namespace foxglove_bridge
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
 #include <unordered_set>
 
 #include <resource_retriever/retriever.hpp>
@@ -12,6 +15,21 @@ inline bool isHiddenTopicOrService(const std::string& name) {
   }
   return name.front() == '_' || name.find("/_") != std::string::npos;
 }
+
+/// Take the calls that share the response of the given call out of the pending calls.
+std::vector<PendingServiceCall> takeCoalescedCalls(ServiceCalls& serviceCalls, uint64_t leaderKey) {
+  std::vector<PendingServiceCall> coalescedCalls;
+  auto& pending = serviceCalls.pending;
+  for (auto callIt = pending.begin(); callIt != pending.end();) {
+    if (callIt->second.leaderKey == leaderKey) {
+      coalescedCalls.push_back(std::move(callIt->second));
+      callIt = pending.erase(callIt);
+    } else {
+      ++callIt;
+    }
+  }
+  return coalescedCalls;
+}
 }  // namespace
 
 using namespace std::chrono_literals;
@@ -57,11 +75,72 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
   _disableLoanMessage = this->get_parameter(PARAM_DISABLE_LOAN_MESSAGE).as_bool();
   const auto ignoreUnresponsiveParamNodes =
     this->get_parameter(PARAM_IGN_UNRESPONSIVE_PARAM_NODES).as_bool();
+  const auto parameterCacheMaxAge = std::chrono::duration<double>(
+    this->get_parameter(PARAM_PARAMETER_CACHE_MAX_AGE).as_double());
+  const auto timeBroadcastRate = this->get_parameter(PARAM_TIME_BROADCAST_RATE).as_double();
+  const auto clientBandwidthLimit =
+    static_cast<size_t>(this->get_parameter(PARAM_CLIENT_BANDWIDTH_LIMIT).as_int());
+  const auto clientBandwidthBurst =
+    static_cast<size_t>(this->get_parameter(PARAM_CLIENT_BANDWIDTH_BURST).as_int());
+  const auto clientBandwidthGroups =
+    this->get_parameter(PARAM_CLIENT_BANDWIDTH_GROUPS).as_string_array();
+  const auto globalSendBufferLimit =
+    static_cast<size_t>(this->get_parameter(PARAM_GLOBAL_SEND_BUFFER_LIMIT).as_int());
+  const auto egressCpuBudget = this->get_parameter(PARAM_EGRESS_CPU_BUDGET).as_double();
+  const auto parameterUpdateInterval =
+    static_cast<size_t>(this->get_parameter(PARAM_PARAMETER_UPDATE_INTERVAL).as_int());
+  const auto topicPriorities = this->get_parameter(PARAM_TOPIC_PRIORITIES).as_string_array();
+  const auto clientPublishRateLimits =
+    this->get_parameter(PARAM_CLIENT_PUBLISH_RATE_LIMITS).as_string_array();
+  const auto clientPublishBandwidthLimits =
+    this->get_parameter(PARAM_CLIENT_PUBLISH_BANDWIDTH_LIMITS).as_string_array();
+  _subscriptionLingerDuration = std::chrono::duration<double>(
+    this->get_parameter(PARAM_SUBSCRIPTION_LINGER_DURATION).as_double());
+  const auto lastMessageCacheTopics =
+    this->get_parameter(PARAM_LAST_MESSAGE_CACHE_TOPICS).as_string_array();
+  const auto lastMessageCachePatterns = parseRegexStrings(this, lastMessageCacheTopics);
+  const auto lastMessageCacheBudget =
+    static_cast<size_t>(this->get_parameter(PARAM_LAST_MESSAGE_CACHE_BUDGET).as_int());
+  const auto topicHistoryDurations =
+    this->get_parameter(PARAM_TOPIC_HISTORY_DURATIONS).as_string_array();
+  const auto topicHistoryMaxBytes =
+    static_cast<size_t>(this->get_parameter(PARAM_TOPIC_HISTORY_MAX_BYTES).as_int());
+  const auto channelHistoryLimits =
+    parseChannelHistoryLimits(this, topicHistoryDurations, topicHistoryMaxBytes);
+  _cachedTopicPatterns = lastMessageCachePatterns;
+  for (const auto& historyLimit : channelHistoryLimits) {
+    _cachedTopicPatterns.push_back(historyLimit.topicPattern);
+  }
+  const auto flightRecorderTopics =
+    this->get_parameter(PARAM_FLIGHT_RECORDER_TOPICS).as_string_array();
+  _flightRecorderPatterns = parseRegexStrings(this, flightRecorderTopics);
+  _flightRecorderDirectory = this->get_parameter(PARAM_FLIGHT_RECORDER_DIRECTORY).as_string();
+  const auto flightRecorderDuration = std::chrono::duration<double>(
+    this->get_parameter(PARAM_FLIGHT_RECORDER_DURATION).as_double());
+  const auto flightRecorderMaxBytes =
+    static_cast<size_t>(this->get_parameter(PARAM_FLIGHT_RECORDER_MAX_BYTES).as_int());
+  _serviceCallTimeout =
+    std::chrono::duration<double>(this->get_parameter(PARAM_SERVICE_CALL_TIMEOUT).as_double());
+  _maxConcurrentServiceCalls =
+    static_cast<size_t>(this->get_parameter(PARAM_MAX_CONCURRENT_SERVICE_CALLS).as_int());
+  const auto serviceResponseCacheTtls =
+    this->get_parameter(PARAM_SERVICE_RESPONSE_CACHE_TTLS).as_string_array();
+  _serviceResponseCacheTtls = parseServiceResponseCacheTtls(this, serviceResponseCacheTtls);
 
   const auto logHandler = std::bind(&FoxgloveBridge::logHandler, this, _1, _2);
   // Fetching of assets may be blocking, hence we fetch them in a separate thread.
   _fetchAssetQueue = std::make_unique<foxglove_ws::CallbackQueue>(logHandler, 1 /* num_threads */);
 
+  if (!_flightRecorderPatterns.empty()) {
+    // The flight recorder reuses the subscriptions of cached topics, which exist for the whole
+    // lifetime of a channel.
+    _flightRecorder = std::make_unique<FlightRecorder>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(flightRecorderDuration),
+      flightRecorderMaxBytes, logHandler);
+    _cachedTopicPatterns.insert(_cachedTopicPatterns.end(), _flightRecorderPatterns.begin(),
+                                _flightRecorderPatterns.end());
+  }
+
   foxglove_ws::ServerOptions serverOptions;
   serverOptions.capabilities = _capabilities;
   if (_useSimTime) {
@@ -76,6 +155,18 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
   serverOptions.certfile = certfile;
   serverOptions.keyfile = keyfile;
   serverOptions.clientTopicWhitelistPatterns = clientTopicWhiteListPatterns;
+  serverOptions.clientBandwidthLimitBytesPerSec = clientBandwidthLimit;
+  serverOptions.clientBandwidthBurstBytes = clientBandwidthBurst;
+  serverOptions.clientBandwidthQuotas = parseClientBandwidthQuotas(this, clientBandwidthGroups);
+  serverOptions.globalSendBufferLimitBytes = globalSendBufferLimit;
+  serverOptions.egressCpuBudget = egressCpuBudget;
+  serverOptions.parameterUpdateIntervalMs = parameterUpdateInterval;
+  serverOptions.channelPriorities = parseChannelPriorities(this, topicPriorities);
+  serverOptions.clientPublishLimits =
+    parseClientPublishLimits(this, clientPublishRateLimits, clientPublishBandwidthLimits);
+  serverOptions.lastMessageCacheTopicPatterns = lastMessageCachePatterns;
+  serverOptions.channelHistoryLimits = channelHistoryLimits;
+  serverOptions.lastMessageCacheBudgetBytes = lastMessageCacheBudget;
 
   _server = foxglove_ws::ServerFactory::createServer<ConnectionHandle>("foxglove_bridge",
                                                                        logHandler, serverOptions);
@@ -89,6 +180,7 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
   hdlrs.serviceRequestHandler = std::bind(&FoxgloveBridge::serviceRequest, this, _1, _2);
   hdlrs.subscribeConnectionGraphHandler =
     std::bind(&FoxgloveBridge::subscribeConnectionGraph, this, _1);
+  hdlrs.clientDisconnectHandler = std::bind(&FoxgloveBridge::clientDisconnected, this, _1);
 
   if (hasCapability(foxglove_ws::CAPABILITY_PARAMETERS) ||
       hasCapability(foxglove_ws::CAPABILITY_PARAMETERS_SUBSCRIBE)) {
@@ -97,10 +189,10 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
     hdlrs.parameterSubscriptionHandler =
       std::bind(&FoxgloveBridge::subscribeParameters, this, _1, _2, _3);
 
-    _paramInterface = std::make_shared<ParameterInterface>(this, paramWhitelistPatterns,
-                                                           ignoreUnresponsiveParamNodes
-                                                             ? UnresponsiveNodePolicy::Ignore
-                                                             : UnresponsiveNodePolicy::Retry);
+    _paramInterface = std::make_shared<ParameterInterface>(
+      this, paramWhitelistPatterns,
+      ignoreUnresponsiveParamNodes ? UnresponsiveNodePolicy::Ignore : UnresponsiveNodePolicy::Retry,
+      parameterCacheMaxAge);
     _paramInterface->setParamUpdateCallback(std::bind(&FoxgloveBridge::parameterUpdates, this, _1));
   }
 
@@ -132,7 +224,49 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
     this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
   _servicesCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
 
-  if (_useSimTime) {
+  if (_subscriptionLingerDuration.count() > 0.0) {
+    _lingerExpiryTimer = this->create_wall_timer(
+      std::min(std::chrono::duration_cast<std::chrono::nanoseconds>(_subscriptionLingerDuration),
+               std::chrono::nanoseconds(std::chrono::seconds(1))),
+      std::bind(&FoxgloveBridge::expireLingeringSubscriptions, this));
+  }
+
+  _messagePoolStatisticsTimer =
+    this->create_wall_timer(MESSAGE_POOL_STATISTICS_INTERVAL,
+                            std::bind(&FoxgloveBridge::logMessagePoolStatistics, this));
+
+  if (hasCapability(foxglove_ws::CAPABILITY_SERVICES)) {
+    // Sends calls to services that became available and fails calls whose deadline has passed.
+    _serviceCallTimer = this->create_wall_timer(100ms, [this]() {
+      sendWaitingServiceCalls();
+      expireServiceCalls();
+    });
+  }
+
+  if (_flightRecorder) {
+    _dumpFlightRecordingService = this->create_service<std_srvs::srv::Trigger>(
+      "~/dump_flight_recording",
+      [this](std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        dumpFlightRecording(response);
+      });
+  }
+
+  if (_useSimTime && timeBroadcastRate > 0.0) {
+    // Only remember the latest time and broadcast it at a fixed rate, so that the broadcasting
+    // cost does not depend on the /clock rate.
+    _clockSubscription = this->create_subscription<rosgraph_msgs::msg::Clock>(
+      "/clock", rclcpp::QoS{rclcpp::KeepLast(1)}.best_effort(),
+      [&](std::shared_ptr<const rosgraph_msgs::msg::Clock> msg) {
+        const auto timestamp = rclcpp::Time{msg->clock}.nanoseconds();
+        assert(timestamp >= 0 && "Timestamp is negative");
+        _latestClockTime = timestamp;
+      });
+    _timeBroadcastTimer = this->create_wall_timer(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(1.0 / timeBroadcastRate)),
+      std::bind(&FoxgloveBridge::broadcastLatestClockTime, this));
+  } else if (_useSimTime) {
     _clockSubscription = this->create_subscription<rosgraph_msgs::msg::Clock>(
       "/clock", rclcpp::QoS{rclcpp::KeepLast(1)}.best_effort(),
       [&](std::shared_ptr<const rosgraph_msgs::msg::Clock> msg) {
@@ -167,6 +301,7 @@ void FoxgloveBridge::rosgraphPollThread() {
         const auto topicNamesAndTypes = get_topic_names_and_types();
         updateAdvertisedTopics(topicNamesAndTypes);
         updateAdvertisedServices();
+        sendWaitingServiceCalls();
         if (_subscribeGraphUpdates) {
           updateConnectionGraph(topicNamesAndTypes);
         }
@@ -224,6 +359,12 @@ void FoxgloveBridge::updateAdvertisedTopics(
       const auto channelId = channelIt->first;
       channelIdsToRemove.push_back(channelId);
       _subscriptions.erase(channelId);
+      _lingeringSubscriptions.erase(channelId);
+      _cacheSubscriptions.erase(channelId);
+      if (_flightRecorder) {
+        _flightRecorder->removeChannel(channelId);
+      }
+      _serializedMessagePools.erase(channelId);
       RCLCPP_INFO(this->get_logger(), "Removed channel %d for topic \"%s\" (%s)", channelId,
                   topicAndDatatype.first.c_str(), topicAndDatatype.second.c_str());
       channelIt = _advertisedTopics.erase(channelIt);
@@ -284,6 +425,9 @@ void FoxgloveBridge::updateAdvertisedTopics(
     _advertisedTopics.emplace(channelId, channel);
     RCLCPP_DEBUG(this->get_logger(), "Advertising channel %d for topic \"%s\" (%s)", channelId,
                  channel.topic.c_str(), channel.schemaName.c_str());
+    if (isWhitelisted(channel.topic, _cachedTopicPatterns)) {
+      subscribeForLastMessageCache(channelId, channel);
+    }
   }
 }
 
@@ -310,8 +454,17 @@ void FoxgloveBridge::updateAdvertisedServices() {
       servicesToRemove.push_back(service.first);
     }
   }
-  for (auto serviceId : servicesToRemove) {
-    _advertisedServices.erase(serviceId);
+  {
+    std::lock_guard<std::mutex> callsLock(_serviceCallsMutex);
+    for (auto serviceId : servicesToRemove) {
+      _advertisedServices.erase(serviceId);
+      _serviceResponseCache.removeService(serviceId);
+      // Pending calls keep the client alive until they are answered or time out.
+      const auto callsIt = _serviceCalls.find(serviceId);
+      if (callsIt != _serviceCalls.end() && callsIt->second.pending.empty()) {
+        _serviceCalls.erase(callsIt);
+      }
+    }
   }
   _server->removeServices(servicesToRemove);
 
@@ -432,39 +585,7 @@ void FoxgloveBridge::subscribeConnectionGraph(bool subscribe) {
   };
 }
 
-void FoxgloveBridge::subscribe(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle) {
-  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
-  auto it = _advertisedTopics.find(channelId);
-  if (it == _advertisedTopics.end()) {
-    throw foxglove_ws::ChannelError(
-      channelId, "Received subscribe request for unknown channel " + std::to_string(channelId));
-  }
-
-  const auto& channel = it->second;
-  const auto& topic = channel.topic;
-  const auto& datatype = channel.schemaName;
-
-  // Get client subscriptions for this channel or insert an empty map.
-  auto [subscriptionsIt, firstSubscription] =
-    _subscriptions.emplace(channelId, SubscriptionsByClient());
-  auto& subscriptionsByClient = subscriptionsIt->second;
-
-  if (!firstSubscription &&
-      subscriptionsByClient.find(clientHandle) != subscriptionsByClient.end()) {
-    throw foxglove_ws::ChannelError(
-      channelId, "Client is already subscribed to channel " + std::to_string(channelId));
-  }
-
-  rclcpp::SubscriptionEventCallbacks eventCallbacks;
-  eventCallbacks.incompatible_qos_callback = [&](const rclcpp::QOSRequestedIncompatibleQoSInfo&) {
-    RCLCPP_ERROR(this->get_logger(), "Incompatible subscriber QoS settings for topic \"%s\" (%s)",
-                 topic.c_str(), datatype.c_str());
-  };
-
-  rclcpp::SubscriptionOptions subscriptionOptions;
-  subscriptionOptions.event_callbacks = eventCallbacks;
-  subscriptionOptions.callback_group = _subscriptionCallbackGroup;
-
+rclcpp::QoS FoxgloveBridge::determineQoS(const std::string& topic) {
   // Select an appropriate subscription QOS profile. This is similar to how ros2 topic echo
   // does it:
   // https://github.com/ros2/ros2cli/blob/619b3d1c9/ros2topic/ros2topic/verb/echo.py#L137-L194
@@ -534,6 +655,58 @@ void FoxgloveBridge::subscribe(foxglove_ws::ChannelId channelId, ConnectionHandl
     qos.durability_volatile();
   }
 
+  return qos;
+}
+
+void FoxgloveBridge::subscribe(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle) {
+  std::unique_lock<std::mutex> lock(_subscriptionsMutex);
+  auto it = _advertisedTopics.find(channelId);
+  if (it == _advertisedTopics.end()) {
+    throw foxglove_ws::ChannelError(
+      channelId, "Received subscribe request for unknown channel " + std::to_string(channelId));
+  }
+
+  if (_cacheSubscriptions.find(channelId) != _cacheSubscriptions.end()) {
+    // Messages are broadcast to all subscribed clients by the subscription of the last message
+    // cache, and the server already sent the cached message to this client.
+    return;
+  }
+
+  const auto& channel = it->second;
+  const auto& topic = channel.topic;
+  const auto& datatype = channel.schemaName;
+
+  // Get client subscriptions for this channel or insert an empty map.
+  auto [subscriptionsIt, firstSubscription] =
+    _subscriptions.emplace(channelId, SubscriptionsByClient());
+  auto& subscriptionsByClient = subscriptionsIt->second;
+
+  if (!firstSubscription &&
+      subscriptionsByClient.find(clientHandle) != subscriptionsByClient.end()) {
+    throw foxglove_ws::ChannelError(
+      channelId, "Client is already subscribed to channel " + std::to_string(channelId));
+  }
+
+  if (const auto target =
+        reuseLingeringSubscription(channelId, clientHandle, subscriptionsByClient)) {
+    // Sending the history may take a while, don't block other (un)subscriptions meanwhile.
+    lock.unlock();
+    replaySubscriptionHistory(channelId, clientHandle, *target);
+    return;
+  }
+
+  rclcpp::SubscriptionEventCallbacks eventCallbacks;
+  eventCallbacks.incompatible_qos_callback = [&](const rclcpp::QOSRequestedIncompatibleQoSInfo&) {
+    RCLCPP_ERROR(this->get_logger(), "Incompatible subscriber QoS settings for topic \"%s\" (%s)",
+                 topic.c_str(), datatype.c_str());
+  };
+
+  rclcpp::SubscriptionOptions subscriptionOptions;
+  subscriptionOptions.event_callbacks = eventCallbacks;
+  subscriptionOptions.callback_group = _subscriptionCallbackGroup;
+
+  const rclcpp::QoS qos = determineQoS(topic);
+
   if (firstSubscription) {
     RCLCPP_INFO(
       this->get_logger(), "Subscribing to topic \"%s\" (%s) on channel %d with reliablity \"%s\"",
@@ -546,19 +719,94 @@ void FoxgloveBridge::subscribe(foxglove_ws::ChannelId channelId, ConnectionHandl
   }
 
   try {
-    auto subscriber = this->create_generic_subscription(
-      topic, datatype, qos,
-      [this, channelId, clientHandle](std::shared_ptr<const rclcpp::SerializedMessage> msg) {
-        this->rosMessageHandler(channelId, clientHandle, msg);
+    // All subscriptions of a channel share one pool, as they receive samples of the same size.
+    auto& messagePool = _serializedMessagePools[channelId];
+    if (!messagePool) {
+      messagePool = std::make_shared<SerializedMessagePool>();
+    }
+    auto target = std::make_shared<SubscriptionTarget>();
+    target->clientHandle = std::make_shared<const ConnectionHandle>(clientHandle);
+    if (_subscriptionLingerDuration.count() > 0.0 &&
+        qos.durability() == rclcpp::DurabilityPolicy::TransientLocal) {
+      target->historyDepth = qos.depth();
+    }
+    auto subscriber = createPooledGenericSubscription(
+      *this, topic, datatype, qos,
+      [this, channelId, target](std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+        std::shared_ptr<const ConnectionHandle> targetClient;
+        if (target->historyDepth > 0) {
+          // Record and read the client under the same lock, so that messages are neither lost
+          // nor duplicated when the subscription is handed over to a new client.
+          std::lock_guard<std::mutex> historyLock(target->historyMutex);
+          if (target->history.size() >= target->historyDepth) {
+            target->history.pop_front();
+          }
+          target->history.push_back(msg);
+          if (target->replayPending) {
+            return;  // Sent to the client by the pending replay
+          }
+          targetClient = std::atomic_load(&target->clientHandle);
+        } else {
+          targetClient = std::atomic_load(&target->clientHandle);
+        }
+        if (targetClient) {
+          this->rosMessageHandler(channelId, *targetClient, msg);
+        }
       },
-      subscriptionOptions);
-    subscriptionsByClient.emplace(clientHandle, std::move(subscriber));
+      subscriptionOptions, messagePool);
+    subscriptionsByClient.emplace(clientHandle,
+                                  ClientSubscription{std::move(subscriber), std::move(target)});
   } catch (const std::exception& ex) {
     throw foxglove_ws::ChannelError(
       channelId, "Failed to subscribe to topic " + topic + " (" + datatype + "): " + ex.what());
   }
 }
 
+void FoxgloveBridge::subscribeForLastMessageCache(foxglove_ws::ChannelId channelId,
+                                                  const foxglove_ws::ChannelWithoutId& channel) {
+  const auto& topic = channel.topic;
+  const auto& datatype = channel.schemaName;
+
+  rclcpp::SubscriptionEventCallbacks eventCallbacks;
+  eventCallbacks.incompatible_qos_callback =
+    [this, topic, datatype](const rclcpp::QOSRequestedIncompatibleQoSInfo&) {
+      RCLCPP_ERROR(this->get_logger(),
+                   "Incompatible subscriber QoS settings for topic \"%s\" (%s)", topic.c_str(),
+                   datatype.c_str());
+    };
+
+  rclcpp::SubscriptionOptions subscriptionOptions;
+  subscriptionOptions.event_callbacks = eventCallbacks;
+  subscriptionOptions.callback_group = _subscriptionCallbackGroup;
+
+  const rclcpp::QoS qos = determineQoS(topic);
+
+  try {
+    auto& messagePool = _serializedMessagePools[channelId];
+    if (!messagePool) {
+      messagePool = std::make_shared<SerializedMessagePool>();
+    }
+    auto subscriber = createPooledGenericSubscription(
+      *this, topic, datatype, qos,
+      [this, channelId](std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+        this->cachedChannelMessageHandler(channelId, msg);
+      },
+      subscriptionOptions, messagePool);
+    _cacheSubscriptions.emplace(channelId, std::move(subscriber));
+    if (_flightRecorder && isWhitelisted(topic, _flightRecorderPatterns)) {
+      _flightRecorder->addChannel(channelId, channel);
+    }
+    RCLCPP_INFO(this->get_logger(),
+                "Subscribing to topic \"%s\" (%s) on channel %d for the last message cache",
+                topic.c_str(), datatype.c_str(), channelId);
+  } catch (const std::exception& ex) {
+    RCLCPP_ERROR(this->get_logger(),
+                 "Failed to subscribe to topic \"%s\" (%s) for the last message cache: %s",
+                 topic.c_str(), datatype.c_str(), ex.what());
+    releaseMessagePoolIfUnused(channelId);
+  }
+}
+
 void FoxgloveBridge::unsubscribe(foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle) {
   std::lock_guard<std::mutex> lock(_subscriptionsMutex);
 
@@ -567,6 +815,9 @@ void FoxgloveBridge::unsubscribe(foxglove_ws::ChannelId channelId, ConnectionHan
     throw foxglove_ws::ChannelError(
       channelId, "Received unsubscribe request for unknown channel " + std::to_string(channelId));
   }
+  if (_cacheSubscriptions.find(channelId) != _cacheSubscriptions.end()) {
+    return;  // The subscription of the last message cache is kept for the channel's lifetime.
+  }
   const auto& channel = channelIt->second;
 
   auto subscriptionsIt = _subscriptions.find(channelId);
@@ -584,11 +835,22 @@ void FoxgloveBridge::unsubscribe(foxglove_ws::ChannelId channelId, ConnectionHan
                    "from a client that was not subscribed to this channel");
   }
 
+  // Only the channel's last subscription lingers, further clients subscribing to the channel get
+  // a subscription of their own.
+  if (_subscriptionLingerDuration.count() > 0.0 && subscriptionsByClient.size() == 1) {
+    auto& lingering = clientSubscription->second;
+    std::atomic_store(&lingering.target->clientHandle, std::shared_ptr<const ConnectionHandle>());
+    const auto expiry =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(_subscriptionLingerDuration);
+    _lingeringSubscriptions[channelId] = {std::move(lingering), expiry};
+  }
   subscriptionsByClient.erase(clientSubscription);
   if (subscriptionsByClient.empty()) {
     RCLCPP_INFO(this->get_logger(), "Unsubscribing from topic \"%s\" (%s) on channel %d",
                 channel.topic.c_str(), channel.schemaName.c_str(), channelId);
     _subscriptions.erase(subscriptionsIt);
+    releaseMessagePoolIfUnused(channelId);
   } else {
     RCLCPP_INFO(this->get_logger(),
                 "Removed one subscription from channel %d (%zu subscription(s) left)", channelId,
@@ -596,6 +858,127 @@ void FoxgloveBridge::unsubscribe(foxglove_ws::ChannelId channelId, ConnectionHan
   }
 }
 
+std::shared_ptr<SubscriptionTarget> FoxgloveBridge::reuseLingeringSubscription(
+  foxglove_ws::ChannelId channelId, ConnectionHandle clientHandle,
+  SubscriptionsByClient& subscriptionsByClient) {
+  auto lingeringIt = _lingeringSubscriptions.find(channelId);
+  if (lingeringIt == _lingeringSubscriptions.end()) {
+    // Only the first subscription of a channel could have reused a lingering subscription.
+    if (_subscriptionLingerDuration.count() > 0.0 && subscriptionsByClient.empty()) {
+      ++_lingerMisses;
+    }
+    return nullptr;
+  }
+  ++_lingerHits;
+
+  auto clientSubscription = std::move(lingeringIt->second.clientSubscription);
+  _lingeringSubscriptions.erase(lingeringIt);
+
+  // The history of transient local topics, which a new subscription would have received from the
+  // publishers, is replayed by the caller. Messages received in the meantime are only sent after
+  // the replay.
+  auto target = clientSubscription.target;
+  {
+    std::lock_guard<std::mutex> historyLock(target->historyMutex);
+    target->replayPending = target->historyDepth > 0;
+    std::atomic_store(&target->clientHandle,
+                      std::make_shared<const ConnectionHandle>(clientHandle));
+  }
+
+  RCLCPP_INFO(this->get_logger(),
+              "Reusing lingering subscription to topic \"%s\" on channel %d (%zu lingering, "
+              "hit rate %.1f%%)",
+              clientSubscription.subscription->get_topic_name(), channelId,
+              _lingeringSubscriptions.size(), lingerHitRate());
+  subscriptionsByClient.emplace(clientHandle, std::move(clientSubscription));
+  return target;
+}
+
+void FoxgloveBridge::replaySubscriptionHistory(foxglove_ws::ChannelId channelId,
+                                               ConnectionHandle clientHandle,
+                                               SubscriptionTarget& target) {
+  std::lock_guard<std::mutex> historyLock(target.historyMutex);
+  if (!target.replayPending) {
+    return;
+  }
+  // Skip the replay if the client unsubscribed in the meantime. A client that subscribed again
+  // has set replayPending again and is served by its own replay.
+  const auto targetClient = std::atomic_load(&target.clientHandle);
+  std::owner_less<ConnectionHandle> ownerLess;
+  if (!targetClient || ownerLess(*targetClient, clientHandle) ||
+      ownerLess(clientHandle, *targetClient)) {
+    return;
+  }
+  for (const auto& msg : target.history) {
+    rosMessageHandler(channelId, clientHandle, msg);
+  }
+  target.replayPending = false;
+}
+
+void FoxgloveBridge::expireLingeringSubscriptions() {
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  const auto now = std::chrono::steady_clock::now();
+  for (auto it = _lingeringSubscriptions.begin(); it != _lingeringSubscriptions.end();) {
+    const auto channelId = it->first;
+    if (it->second.expiry > now) {
+      ++it;
+      continue;
+    }
+    it = _lingeringSubscriptions.erase(it);
+    RCLCPP_DEBUG(this->get_logger(),
+                 "Lingering subscription of channel %d expired (%zu lingering, %zu hits, %zu "
+                 "misses, hit rate %.1f%%)",
+                 channelId, _lingeringSubscriptions.size(), _lingerHits, _lingerMisses,
+                 lingerHitRate());
+    if (_subscriptions.find(channelId) == _subscriptions.end()) {
+      releaseMessagePoolIfUnused(channelId);
+    }
+  }
+}
+
+double FoxgloveBridge::lingerHitRate() const {
+  const size_t subscriptions = _lingerHits + _lingerMisses;
+  return subscriptions > 0
+           ? 100.0 * static_cast<double>(_lingerHits) / static_cast<double>(subscriptions)
+           : 0.0;
+}
+
+void FoxgloveBridge::releaseMessagePoolIfUnused(foxglove_ws::ChannelId channelId) {
+  if (_lingeringSubscriptions.find(channelId) != _lingeringSubscriptions.end() ||
+      _cacheSubscriptions.find(channelId) != _cacheSubscriptions.end()) {
+    return;
+  }
+
+  const auto poolIt = _serializedMessagePools.find(channelId);
+  if (poolIt != _serializedMessagePools.end()) {
+    const auto stats = poolIt->second->statistics();
+    RCLCPP_INFO(this->get_logger(),
+                "Serialized message pool of channel %d: %lu allocations, %lu reuses, largest "
+                "message %zu bytes (peak RSS: %ld kB)",
+                channelId, static_cast<unsigned long>(stats.allocations),
+                static_cast<unsigned long>(stats.reuses), stats.largestMessage, getPeakRssKb());
+    _serializedMessagePools.erase(poolIt);
+  }
+}
+
+void FoxgloveBridge::logMessagePoolStatistics() {
+  if (!rcutils_logging_logger_is_enabled_for(this->get_logger().get_name(),
+                                             RCUTILS_LOG_SEVERITY_DEBUG)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  for (const auto& [channelId, pool] : _serializedMessagePools) {
+    const auto stats = pool->statistics();
+    RCLCPP_DEBUG(this->get_logger(),
+                 "Serialized message pool of channel %d: %lu allocations, %lu reuses, %zu bytes "
+                 "pooled, largest message %zu bytes (peak RSS: %ld kB)",
+                 channelId, static_cast<unsigned long>(stats.allocations),
+                 static_cast<unsigned long>(stats.reuses), stats.pooledBytes,
+                 stats.largestMessage, getPeakRssKb());
+  }
+}
+
 void FoxgloveBridge::clientAdvertise(const foxglove_ws::ClientAdvertisement& advertisement,
                                      ConnectionHandle hdl) {
   std::lock_guard<std::mutex> lock(_clientAdvertisementsMutex);
@@ -622,9 +1005,9 @@ void FoxgloveBridge::clientAdvertise(const foxglove_ws::ClientAdvertisement& adv
   }
 
   if (advertisement.encoding == "json") {
-    // register the JSON parser for this schemaName
-    auto parserIt = _jsonParsers.find(advertisement.schemaName);
-    if (parserIt == _jsonParsers.end()) {
+    // register the JSON serializer for this schemaName
+    const auto jsonSerializers = std::atomic_load(&_jsonSerializers);
+    if (jsonSerializers->find(advertisement.schemaName) == jsonSerializers->end()) {
       const auto& schemaName = advertisement.schemaName;
       std::string schema = "";
 
@@ -644,9 +1027,18 @@ void FoxgloveBridge::clientAdvertise(const foxglove_ws::ClientAdvertisement& adv
         schema = msgDefinition;
       }
 
-      auto parser = std::make_shared<RosMsgParser::Parser>(
-        advertisement.topic, RosMsgParser::ROSType(schemaName), schema);
-      _jsonParsers.insert({schemaName, parser});
+      std::shared_ptr<const foxglove_ws::JsonCdrSerializer> serializer;
+      try {
+        serializer = std::make_shared<const foxglove_ws::JsonCdrSerializer>(schemaName, schema);
+      } catch (const std::exception& ex) {
+        throw foxglove_ws::ClientChannelError(
+          advertisement.channelId,
+          "Failed to create JSON serializer for schema " + schemaName + ": " + ex.what());
+      }
+      auto updatedSerializers = std::make_shared<JsonSerializers>(*jsonSerializers);
+      updatedSerializers->emplace(schemaName, std::move(serializer));
+      std::atomic_store(&_jsonSerializers,
+                        std::shared_ptr<const JsonSerializers>(std::move(updatedSerializers)));
     }
   }
 
@@ -754,13 +1146,11 @@ void FoxgloveBridge::clientMessage(const foxglove_ws::ClientMessage& message,
     publisher = it2->second;
   }
 
-  auto publishMessage = [publisher, this](const void* data, size_t size) {
-    // Copy the message payload into a SerializedMessage object
-    rclcpp::SerializedMessage serializedMessage{size};
-    auto& rclSerializedMsg = serializedMessage.get_rcl_serialized_message();
-    std::memcpy(rclSerializedMsg.buffer, data, size);
-    rclSerializedMsg.buffer_length = size;
-    // Publish the message
+  // The message is reused across messages published from this thread, so that no allocation is
+  // needed once it has grown to the largest message size. This is safe since publishing does not
+  // keep a reference to it.
+  thread_local rclcpp::SerializedMessage serializedMessage;
+  auto publishMessage = [publisher, this]() {
     if (_disableLoanMessage || !publisher->can_loan_messages()) {
       publisher->publish(serializedMessage);
     } else {
@@ -769,30 +1159,32 @@ void FoxgloveBridge::clientMessage(const foxglove_ws::ClientMessage& message,
   };
 
   if (message.advertisement.encoding == "cdr") {
-    publishMessage(message.getData(), message.getLength());
-  } else if (message.advertisement.encoding == "json") {
-    // get the specific parser for this schemaName
-    std::shared_ptr<RosMsgParser::Parser> parser;
-    {
-      std::lock_guard<std::mutex> lock(_clientAdvertisementsMutex);
-      auto parserIt = _jsonParsers.find(message.advertisement.schemaName);
-      if (parserIt != _jsonParsers.end()) {
-        parser = parserIt->second;
-      }
+    // Copy the message payload into the serialized message, the only copy of CDR payloads.
+    if (serializedMessage.capacity() < message.getLength()) {
+      serializedMessage.reserve(message.getLength());
     }
-    if (!parser) {
+    auto& rclSerializedMsg = serializedMessage.get_rcl_serialized_message();
+    std::memcpy(rclSerializedMsg.buffer, message.getData(), message.getLength());
+    rclSerializedMsg.buffer_length = message.getLength();
+    publishMessage();
+  } else if (message.advertisement.encoding == "json") {
+    // get the specific serializer for this schemaName
+    const auto jsonSerializers = std::atomic_load(&_jsonSerializers);
+    const auto serializerIt = jsonSerializers->find(message.advertisement.schemaName);
+    if (serializerIt == jsonSerializers->end()) {
       throw foxglove_ws::ClientChannelError(message.advertisement.channelId,
                                             "Dropping client message from " +
                                               _server->remoteEndpointString(hdl) +
                                               " with encoding \"json\": no parser found");
     } else {
-      thread_local RosMsgParser::ROS2_Serializer serializer;
-      serializer.reset();
-      const std::string jsonMessage(reinterpret_cast<const char*>(message.getData()),
-                                    message.getLength());
+      const std::string_view jsonMessage(reinterpret_cast<const char*>(message.getData()),
+                                         message.getLength());
       try {
-        parser->serializeFromJson(jsonMessage, &serializer);
-        publishMessage(serializer.getBufferData(), serializer.getBufferSize());
+        // Serialized straight into the message that is published, so that the CDR data is not
+        // copied again.
+        SerializedMessageOutputBuffer buffer(serializedMessage);
+        serializerIt->second->serialize(jsonMessage, buffer);
+        publishMessage();
       } catch (const std::exception& ex) {
         throw foxglove_ws::ClientChannelError(message.advertisement.channelId,
                                               "Dropping client message from " +
@@ -811,23 +1203,31 @@ void FoxgloveBridge::clientMessage(const foxglove_ws::ClientMessage& message,
 void FoxgloveBridge::setParameters(const std::vector<foxglove_ws::Parameter>& parameters,
                                    const std::optional<std::string>& requestId,
                                    ConnectionHandle hdl) {
-  _paramInterface->setParams(parameters, std::chrono::seconds(5));
+  if (!requestId) {
+    _paramInterface->setParams(parameters, std::chrono::seconds(5), nullptr);
+    return;
+  }
 
-  // If a request Id was given, send potentially updated parameters back to client
-  if (requestId) {
-    std::vector<std::string> parameterNames(parameters.size());
-    for (size_t i = 0; i < parameters.size(); ++i) {
-      parameterNames[i] = parameters[i].getName();
-    }
-    getParameters(parameterNames, requestId, hdl);
+  // A request Id was given, send potentially updated parameters back to client once set
+  std::vector<std::string> parameterNames(parameters.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    parameterNames[i] = parameters[i].getName();
   }
+  _paramInterface->setParams(
+    parameters, std::chrono::seconds(5),
+    [this, parameterNames = std::move(parameterNames), requestId, hdl]() {
+      getParameters(parameterNames, requestId, hdl);
+    });
 }
 
 void FoxgloveBridge::getParameters(const std::vector<std::string>& parameters,
                                    const std::optional<std::string>& requestId,
                                    ConnectionHandle hdl) {
-  const auto params = _paramInterface->getParams(parameters, std::chrono::seconds(5));
-  _server->publishParameterValues(hdl, params, requestId);
+  // Answered once all nodes have responded or timed out, without blocking the executor thread.
+  _paramInterface->getParams(parameters, std::chrono::seconds(5),
+                             [this, requestId, hdl](const ParameterList& params) {
+                               _server->publishParameterValues(hdl, params, requestId);
+                             });
 }
 
 void FoxgloveBridge::subscribeParameters(const std::vector<std::string>& parameters,
@@ -864,6 +1264,15 @@ void FoxgloveBridge::logHandler(LogLevel level, char const* msg) {
   }
 }
 
+void FoxgloveBridge::broadcastLatestClockTime() {
+  const int64_t timestamp = _latestClockTime;
+  if (timestamp < 0 || timestamp == _lastBroadcastedClockTime) {
+    return;  // No (new) time received yet.
+  }
+  _lastBroadcastedClockTime = timestamp;
+  _server->broadcastTime(static_cast<uint64_t>(timestamp));
+}
+
 void FoxgloveBridge::rosMessageHandler(const foxglove_ws::ChannelId& channelId,
                                        ConnectionHandle clientHandle,
                                        std::shared_ptr<const rclcpp::SerializedMessage> msg) {
@@ -876,55 +1285,417 @@ void FoxgloveBridge::rosMessageHandler(const foxglove_ws::ChannelId& channelId,
                        rclSerializedMsg.buffer, rclSerializedMsg.buffer_length);
 }
 
+void FoxgloveBridge::cachedChannelMessageHandler(
+  foxglove_ws::ChannelId channelId, std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+  // NOTE: Do not call any RCLCPP_* logging functions from this function, see rosMessageHandler.
+  const auto timestamp = this->now().nanoseconds();
+  assert(timestamp >= 0 && "Timestamp is negative");
+  const auto rclSerializedMsg = msg->get_rcl_serialized_message();
+  _server->broadcastMessage(channelId, static_cast<uint64_t>(timestamp), rclSerializedMsg.buffer,
+                            rclSerializedMsg.buffer_length);
+  if (_flightRecorder) {
+    _flightRecorder->record(channelId, static_cast<uint64_t>(timestamp), std::move(msg));
+  }
+}
+
+void FoxgloveBridge::dumpFlightRecording(
+  std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+  // Milliseconds and a counter keep dumps requested in quick succession apart; the writer also
+  // refuses to overwrite an existing file.
+  const auto now = std::chrono::system_clock::now();
+  const auto nowTime = std::chrono::system_clock::to_time_t(now);
+  const auto milliseconds =
+    std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+  std::tm localTime{};
+  localtime_r(&nowTime, &localTime);
+  char timeString[32];
+  std::strftime(timeString, sizeof(timeString), "%Y%m%d_%H%M%S", &localTime);
+  char fileName[96];
+  std::snprintf(fileName, sizeof(fileName), "flight_recording_%s_%03d_%u.mcap", timeString,
+                static_cast<int>(milliseconds), _flightRecordingCount++);
+  const std::string path = _flightRecorderDirectory + "/" + fileName;
+
+  response->success =
+    _flightRecorder->dump(path, [this](bool success, const std::string& message) {
+      if (success) {
+        RCLCPP_INFO(this->get_logger(), "%s", message.c_str());
+      } else {
+        RCLCPP_ERROR(this->get_logger(), "%s", message.c_str());
+      }
+    });
+  response->message = response->success ? "Writing flight recording to " + path
+                                         : "A flight recording is already being written";
+}
+
 void FoxgloveBridge::serviceRequest(const foxglove_ws::ServiceRequest& request,
                                     ConnectionHandle clientHandle) {
   RCLCPP_DEBUG(this->get_logger(), "Received a request for service %d", request.serviceId);
 
-  std::lock_guard<std::mutex> lock(_servicesMutex);
-  const auto serviceIt = _advertisedServices.find(request.serviceId);
-  if (serviceIt == _advertisedServices.end()) {
-    throw foxglove_ws::ServiceError(
-      request.serviceId,
-      "Service with id " + std::to_string(request.serviceId) + " does not exist");
+  foxglove_ws::ServiceWithoutId service;
+  {
+    std::lock_guard<std::mutex> lock(_servicesMutex);
+    const auto serviceIt = _advertisedServices.find(request.serviceId);
+    if (serviceIt == _advertisedServices.end()) {
+      throw foxglove_ws::ServiceError(
+        request.serviceId,
+        "Service with id " + std::to_string(request.serviceId) + " does not exist");
+    }
+    service = serviceIt->second;
   }
 
-  auto clientIt = _serviceClients.find(request.serviceId);
-  if (clientIt == _serviceClients.end()) {
+  GenericClient::SharedPtr client;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    const auto callsIt = _serviceCalls.find(request.serviceId);
+    if (callsIt != _serviceCalls.end()) {
+      if (callsIt->second.pending.size() >= _maxConcurrentServiceCalls) {
+        throw foxglove_ws::ServiceError(request.serviceId,
+                                        "Too many pending calls to service " + service.name);
+      }
+      client = callsIt->second.client;
+    }
+  }
+
+  // Service requests are handled by a single server thread, so no other client for this service
+  // can be created concurrently.
+  if (!client) {
     try {
       auto clientOptions = rcl_client_get_default_options();
-      auto genClient = GenericClient::make_shared(
-        this->get_node_base_interface().get(), this->get_node_graph_interface(),
-        serviceIt->second.name, serviceIt->second.type, clientOptions);
-      clientIt = _serviceClients.emplace(request.serviceId, std::move(genClient)).first;
-      this->get_node_services_interface()->add_client(clientIt->second, _servicesCallbackGroup);
+      client = GenericClient::make_shared(this->get_node_base_interface().get(),
+                                          this->get_node_graph_interface(), service.name,
+                                          service.type, clientOptions);
+      this->get_node_services_interface()->add_client(client, _servicesCallbackGroup);
     } catch (const std::exception& ex) {
       throw foxglove_ws::ServiceError(
         request.serviceId,
-        "Failed to create service client for service " + serviceIt->second.name + ": " + ex.what());
+        "Failed to create service client for service " + service.name + ": " + ex.what());
+    }
+  }
+
+  std::optional<std::chrono::duration<double>> responseCacheTtl;
+  for (const auto& cacheTtl : _serviceResponseCacheTtls) {
+    if (std::regex_match(service.name, cacheTtl.servicePattern)) {
+      responseCacheTtl = std::chrono::duration<double>(cacheTtl.ttlSeconds);
+      break;
+    }
+  }
+
+  uint64_t callKey = 0;
+  foxglove_ws::ServiceResponseCache::Lookup cacheLookup;
+  foxglove_ws::ServiceResponseCache::Statistics cacheStatistics;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    auto& serviceCalls = _serviceCalls[request.serviceId];
+    serviceCalls.serviceName = service.name;
+    serviceCalls.client = client;
+    serviceCalls.responseCacheTtl = responseCacheTtl;
+    callKey = _nextServiceCallKey++;
+    if (responseCacheTtl) {
+      cacheLookup = _serviceResponseCache.lookup(request.serviceId, request.data, callKey);
+      cacheStatistics = _serviceResponseCache.statistics();
+    }
+    if (!cacheLookup.response) {
+      auto& call = serviceCalls.pending[callKey];
+      call.request = request;
+      call.clientHandle = clientHandle;
+      call.deadline = std::chrono::steady_clock::now() +
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(_serviceCallTimeout);
+      if (cacheLookup.inFlightCall) {
+        // Answered together with the identical call in flight, without sending a request.
+        call.leaderKey = cacheLookup.inFlightCall;
+        call.request.data = {};
+      }
+    }
+  }
+
+  if (cacheLookup.response || cacheLookup.inFlightCall) {
+    RCLCPP_DEBUG(this->get_logger(),
+                 "%s call to service %s (%zu hits, %zu coalesced, %zu misses)",
+                 cacheLookup.response ? "Answering from cache" : "Coalescing", service.name.c_str(),
+                 cacheStatistics.hits, cacheStatistics.coalesced, cacheStatistics.misses);
+  }
+  if (cacheLookup.response) {
+    _server->sendServiceResponse(clientHandle, request.serviceId, request.callId,
+                                 request.encoding, cacheLookup.response->data(),
+                                 cacheLookup.response->size());
+    return;
+  } else if (cacheLookup.inFlightCall) {
+    return;
+  }
+
+  // Otherwise, the call is sent once the service becomes available or fails after the timeout.
+  if (client->service_is_ready()) {
+    sendServiceCall(request.serviceId, client, callKey);
+  }
+}
+
+void FoxgloveBridge::sendServiceCall(foxglove_ws::ServiceId serviceId,
+                                     const GenericClient::SharedPtr& client, uint64_t callKey) {
+  std::shared_ptr<rclcpp::SerializedMessage> reqMessage;
+  std::chrono::duration<double> cacheTtl{0.0};
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    const auto callsIt = _serviceCalls.find(serviceId);
+    if (callsIt == _serviceCalls.end()) {
+      return;
     }
+    const auto callIt = callsIt->second.pending.find(callKey);
+    if (callIt == callsIt->second.pending.end() || callIt->second.sent ||
+        callIt->second.leaderKey) {
+      return;  // Already sent, timed out, cancelled or sharing the response of another call
+    }
+    cacheTtl = callsIt->second.responseCacheTtl.value_or(cacheTtl);
+    auto& call = callIt->second;
+    call.sent = true;
+    reqMessage = std::make_shared<rclcpp::SerializedMessage>(call.request.data.size());
+    auto& rclSerializedMsg = reqMessage->get_rcl_serialized_message();
+    std::memcpy(rclSerializedMsg.buffer, call.request.data.data(), call.request.data.size());
+    rclSerializedMsg.buffer_length = call.request.data.size();
+    call.request.data = {};
+  }
+
+  GenericClient::FutureAndRequestId sentRequest;
+  try {
+    sentRequest = client->async_send_request_with_id(
+      reqMessage, [this, serviceId, callKey, cacheTtl](GenericClient::SharedFuture future) {
+        serviceResponse(serviceId, callKey, cacheTtl, future);
+      });
+  } catch (const std::exception& ex) {
+    failServiceCall(serviceId, callKey,
+                    "Failed to send service request: " + std::string(ex.what()));
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+  const auto callsIt = _serviceCalls.find(serviceId);
+  const bool stillPending =
+    callsIt != _serviceCalls.end() && callsIt->second.pending.count(callKey) > 0;
+  if (stillPending) {
+    callsIt->second.pending.at(callKey).requestId = sentRequest.request_id;
+  } else {
+    // Timed out or cancelled while being sent (or already answered, in which case this is a no-op)
+    client->remove_pending_request(sentRequest.request_id);
+  }
+}
+
+void FoxgloveBridge::serviceResponse(foxglove_ws::ServiceId serviceId, uint64_t callKey,
+                                     std::chrono::duration<double> cacheTtl,
+                                     GenericClient::SharedFuture future) {
+  GenericClient::SharedResponse response;
+  try {
+    response = future.get();
+  } catch (const std::exception& ex) {
+    failServiceCall(serviceId, callKey,
+                    "Failed to handle service response: " + std::string(ex.what()));
+    return;
+  }
+  const auto& serializedResponseMsg = response->get_rcl_serialized_message();
+  // Copied before locking, as responses of idempotent services can be large (e.g. maps).
+  foxglove_ws::ServiceResponseCache::Response cachedResponse;
+  if (cacheTtl.count() > 0.0) {
+    cachedResponse = std::make_shared<const std::vector<uint8_t>>(
+      serializedResponseMsg.buffer,
+      serializedResponseMsg.buffer + serializedResponseMsg.buffer_length);
+  }
+
+  std::optional<PendingServiceCall> call;
+  std::vector<PendingServiceCall> coalescedCalls;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    const auto callsIt = _serviceCalls.find(serviceId);
+    if (callsIt == _serviceCalls.end()) {
+      return;
+    }
+    const auto callIt = callsIt->second.pending.find(callKey);
+    if (callIt == callsIt->second.pending.end()) {
+      return;  // Timed out or cancelled
+    }
+    call = std::move(callIt->second);
+    callsIt->second.pending.erase(callIt);
+    coalescedCalls = takeCoalescedCalls(callsIt->second, callKey);
+    const auto cacheExpiry = std::chrono::steady_clock::now() +
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(cacheTtl);
+    _serviceResponseCache.complete(callKey, std::move(cachedResponse), cacheExpiry);
   }
 
-  auto client = clientIt->second;
-  if (!client->wait_for_service(1s)) {
-    throw foxglove_ws::ServiceError(request.serviceId,
-                                    "Service " + serviceIt->second.name + " is not available");
+  _server->sendServiceResponse(call->clientHandle, serviceId, call->request.callId,
+                               call->request.encoding, serializedResponseMsg.buffer,
+                               serializedResponseMsg.buffer_length);
+  for (const auto& coalescedCall : coalescedCalls) {
+    _server->sendServiceResponse(coalescedCall.clientHandle, serviceId,
+                                 coalescedCall.request.callId, coalescedCall.request.encoding,
+                                 serializedResponseMsg.buffer, serializedResponseMsg.buffer_length);
   }
+}
 
-  auto reqMessage = std::make_shared<rclcpp::SerializedMessage>(request.data.size());
-  auto& rclSerializedMsg = reqMessage->get_rcl_serialized_message();
-  std::memcpy(rclSerializedMsg.buffer, request.data.data(), request.data.size());
-  rclSerializedMsg.buffer_length = request.data.size();
+void FoxgloveBridge::failServiceCall(foxglove_ws::ServiceId serviceId, uint64_t callKey,
+                                     const std::string& message) {
+  std::vector<PendingServiceCall> failedCalls;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    const auto callsIt = _serviceCalls.find(serviceId);
+    if (callsIt != _serviceCalls.end() && callsIt->second.pending.count(callKey) > 0) {
+      failedCalls = takeCoalescedCalls(callsIt->second, callKey);
+      failedCalls.push_back(std::move(callsIt->second.pending.at(callKey)));
+      callsIt->second.pending.erase(callKey);
+    }
+    _serviceResponseCache.abandon(callKey);
+  }
+  for (const auto& call : failedCalls) {
+    _server->sendServiceFailure(call.clientHandle, serviceId, call.request.callId, message);
+  }
+}
 
-  auto responseReceivedCallback = [this, request,
-                                   clientHandle](GenericClient::SharedFuture future) {
-    const auto serializedResponseMsg = future.get()->get_rcl_serialized_message();
-    foxglove_ws::ServiceRequest response{request.serviceId, request.callId, request.encoding,
-                                         std::vector<uint8_t>(serializedResponseMsg.buffer_length)};
-    std::memcpy(response.data.data(), serializedResponseMsg.buffer,
-                serializedResponseMsg.buffer_length);
-    _server->sendServiceResponse(clientHandle, response);
+void FoxgloveBridge::sendWaitingServiceCalls() {
+  std::vector<std::pair<foxglove_ws::ServiceId, GenericClient::SharedPtr>> waitingServices;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    for (const auto& [serviceId, serviceCalls] : _serviceCalls) {
+      const bool waiting =
+        std::any_of(serviceCalls.pending.begin(), serviceCalls.pending.end(),
+                    [](const auto& keyAndCall) {
+                      return !keyAndCall.second.sent && !keyAndCall.second.leaderKey;
+                    });
+      if (waiting) {
+        waitingServices.emplace_back(serviceId, serviceCalls.client);
+      }
+    }
+  }
+
+  for (const auto& [serviceId, client] : waitingServices) {
+    if (!client->service_is_ready()) {
+      continue;
+    }
+    std::vector<uint64_t> callKeys;
+    {
+      std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+      const auto callsIt = _serviceCalls.find(serviceId);
+      if (callsIt == _serviceCalls.end()) {
+        continue;
+      }
+      for (const auto& [callKey, call] : callsIt->second.pending) {
+        if (!call.sent && !call.leaderKey) {
+          callKeys.push_back(callKey);
+        }
+      }
+    }
+    for (const auto callKey : callKeys) {
+      sendServiceCall(serviceId, client, callKey);
+    }
+  }
+}
+
+void FoxgloveBridge::expireServiceCalls() {
+  struct ExpiredCall {
+    GenericClient::SharedPtr client;
+    PendingServiceCall call;
+    std::string message;
   };
-  client->async_send_request(reqMessage, responseReceivedCallback);
+  std::vector<ExpiredCall> expiredCalls;
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    for (auto& [serviceId, serviceCalls] : _serviceCalls) {
+      auto& pending = serviceCalls.pending;
+      std::vector<uint64_t> expiredKeys;
+      for (const auto& [callKey, call] : pending) {
+        if (call.deadline <= now) {
+          expiredKeys.push_back(callKey);
+        }
+      }
+
+      for (const auto callKey : expiredKeys) {
+        const auto callIt = pending.find(callKey);
+        if (callIt == pending.end()) {
+          continue;  // Expired together with the call whose response it shares
+        }
+        const auto leaderIt =
+          callIt->second.leaderKey ? pending.find(*callIt->second.leaderKey) : pending.end();
+        const bool sent = leaderIt != pending.end() ? leaderIt->second.sent : callIt->second.sent;
+        const std::string message = sent
+                                      ? "Call to service " + serviceCalls.serviceName + " timed out"
+                                      : "Service " + serviceCalls.serviceName + " is not available";
+
+        std::vector<PendingServiceCall> calls;
+        if (!callIt->second.leaderKey) {
+          _serviceResponseCache.abandon(callKey);
+          calls = takeCoalescedCalls(serviceCalls, callKey);
+        }
+        calls.push_back(std::move(callIt->second));
+        pending.erase(callIt);
+        for (auto& call : calls) {
+          expiredCalls.push_back({serviceCalls.client, std::move(call), message});
+        }
+      }
+    }
+    _serviceResponseCache.removeExpired(now);
+  }
+
+  for (const auto& [client, call, message] : expiredCalls) {
+    if (call.requestId) {
+      client->remove_pending_request(*call.requestId);
+    }
+    RCLCPP_DEBUG(this->get_logger(), "%s", message.c_str());
+    _server->sendServiceFailure(call.clientHandle, call.request.serviceId, call.request.callId,
+                                message);
+  }
+}
+
+void FoxgloveBridge::clientDisconnected(ConnectionHandle clientHandle) {
+  const auto isClientCall = [&clientHandle](const PendingServiceCall& call) {
+    return !call.clientHandle.owner_before(clientHandle) &&
+           !clientHandle.owner_before(call.clientHandle);
+  };
+
+  std::vector<std::pair<GenericClient::SharedPtr, int64_t>> sentRequests;
+  {
+    std::lock_guard<std::mutex> lock(_serviceCallsMutex);
+    for (auto& [serviceId, serviceCalls] : _serviceCalls) {
+      auto& pending = serviceCalls.pending;
+      // Calls sharing the response of another call are dropped first, so that they do not take
+      // over calls of the same client below.
+      for (auto callIt = pending.begin(); callIt != pending.end();) {
+        if (callIt->second.leaderKey && isClientCall(callIt->second)) {
+          callIt = pending.erase(callIt);
+        } else {
+          ++callIt;
+        }
+      }
+
+      for (auto callIt = pending.begin(); callIt != pending.end();) {
+        auto& call = callIt->second;
+        if (!isClientCall(call)) {
+          ++callIt;
+          continue;
+        }
+
+        // Another client waiting for the same response takes over the call.
+        const auto coalescedIt =
+          std::find_if(pending.begin(), pending.end(), [&callIt](const auto& keyAndCall) {
+            return keyAndCall.second.leaderKey == callIt->first;
+          });
+        if (coalescedIt != pending.end()) {
+          call.clientHandle = coalescedIt->second.clientHandle;
+          call.request.callId = coalescedIt->second.request.callId;
+          call.request.encoding = coalescedIt->second.request.encoding;
+          call.deadline = coalescedIt->second.deadline;
+          pending.erase(coalescedIt);
+          ++callIt;
+          continue;
+        }
+
+        if (call.requestId) {
+          sentRequests.emplace_back(serviceCalls.client, *call.requestId);
+        }
+        _serviceResponseCache.abandon(callIt->first);
+        callIt = pending.erase(callIt);
+      }
+    }
+  }
+
+  for (const auto& [client, requestId] : sentRequests) {
+    client->remove_pending_request(requestId);
+  }
 }
 
 void FoxgloveBridge::fetchAsset(const std::string& uri, uint32_t requestId,
@@ -0,0 +1,139 @@
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#include <rclcpp/typesupport_helpers.hpp>
+#include <rclcpp/version.h>
+
+#include <foxglove_bridge/serialized_message_pool.hpp>
+
+namespace foxglove_bridge {
+
+namespace {
+
+// Index of the size class a buffer of the given capacity belongs to, i.e. floor(log2(capacity)).
+// All buffers of size class N hold at least 2^N bytes.
+size_t sizeClassOf(size_t capacity) {
+  size_t sizeClass = 0;
+  while (capacity >>= 1) {
+    ++sizeClass;
+  }
+  return sizeClass;
+}
+
+size_t roundUpToPowerOfTwo(size_t size) {
+  size_t capacity = 1;
+  while (capacity < size) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+SerializedMessagePool::SerializedMessagePool(size_t maxBuffersPerSizeClass)
+    : _maxBuffersPerSizeClass(maxBuffersPerSizeClass) {}
+
+std::shared_ptr<rclcpp::SerializedMessage> SerializedMessagePool::acquire() {
+  std::unique_ptr<rclcpp::SerializedMessage> message;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const size_t expectedSize = std::max(_expectedSize, MIN_CAPACITY);
+
+    for (size_t sizeClass = sizeClassOf(expectedSize); sizeClass < SIZE_CLASS_COUNT && !message;
+         ++sizeClass) {
+      auto& buffers = _freeBuffers[sizeClass];
+      for (auto it = buffers.rbegin(); it != buffers.rend(); ++it) {
+        if ((*it)->capacity() >= expectedSize) {
+          message = std::move(*it);
+          buffers.erase(std::next(it).base());
+          _statistics.pooledBytes -= message->capacity();
+          ++_statistics.reuses;
+          break;
+        }
+      }
+    }
+
+    if (!message) {
+      ++_statistics.allocations;
+      message = std::make_unique<rclcpp::SerializedMessage>(roundUpToPowerOfTwo(expectedSize));
+    }
+  }
+
+  std::weak_ptr<SerializedMessagePool> weakPool = weak_from_this();
+  return std::shared_ptr<rclcpp::SerializedMessage>(
+    message.release(), [weakPool](rclcpp::SerializedMessage* releasedMessage) {
+      if (auto pool = weakPool.lock()) {
+        pool->release(releasedMessage);
+      } else {
+        delete releasedMessage;
+      }
+    });
+}
+
+void SerializedMessagePool::release(rclcpp::SerializedMessage* message) {
+  std::unique_ptr<rclcpp::SerializedMessage> ownedMessage(message);
+  const size_t capacity = ownedMessage->capacity();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  // Samples of the same topic tend to have similar sizes, so the size of the last sample is used
+  // as estimate for the next one. Buffers that were not used (e.g. because taking the sample
+  // failed) don't update the estimate.
+  if (ownedMessage->size() > 0) {
+    _expectedSize = ownedMessage->size();
+    _statistics.largestMessage = std::max(_statistics.largestMessage, _expectedSize);
+  }
+
+  auto& buffers = _freeBuffers[sizeClassOf(capacity)];
+  if (capacity > 0 && buffers.size() < _maxBuffersPerSizeClass) {
+    ownedMessage->get_rcl_serialized_message().buffer_length = 0;
+    _statistics.pooledBytes += capacity;
+    buffers.push_back(std::move(ownedMessage));
+  }
+}
+
+SerializedMessagePool::Statistics SerializedMessagePool::statistics() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _statistics;
+}
+
+std::shared_ptr<rclcpp::SerializedMessage> PooledGenericSubscription::create_serialized_message() {
+  return _pool->acquire();
+}
+
+void PooledGenericSubscription::return_serialized_message(
+  std::shared_ptr<rclcpp::SerializedMessage>& message) {
+  message.reset();
+}
+
+rclcpp::GenericSubscription::SharedPtr createPooledGenericSubscription(
+  rclcpp::Node& node, const std::string& topic, const std::string& type, const rclcpp::QoS& qos,
+  std::function<void(std::shared_ptr<const rclcpp::SerializedMessage>)> callback,
+  const rclcpp::SubscriptionOptions& options, std::shared_ptr<SerializedMessagePool> pool) {
+  // Mirrors rclcpp::create_generic_subscription, which does not allow to customize the
+  // subscription class.
+  auto typeSupportLib = rclcpp::get_typesupport_library(type, "rosidl_typesupport_cpp");
+#if RCLCPP_VERSION_MAJOR > 16
+  rclcpp::AnySubscriptionCallback<rclcpp::SerializedMessage, std::allocator<void>> anyCallback;
+  anyCallback.set(std::move(callback));
+#else
+  std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> anyCallback =
+    std::move(callback);
+#endif
+
+  auto subscription = std::make_shared<PooledGenericSubscription>(
+    node.get_node_base_interface().get(), std::move(typeSupportLib), topic, type, qos,
+    std::move(anyCallback), options, std::move(pool));
+  node.get_node_topics_interface()->add_subscription(subscription, options.callback_group);
+  return subscription;
+}
+
+long getPeakRssKb() {
+  struct rusage usage {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return usage.ru_maxrss;
+}
+
+}  // namespace foxglove_bridge
@@ -0,0 +1,108 @@
+// Benchmark of the JSON to CDR serialization of client published messages, comparing
+// rosx_introspection (which interprets the schema for every message) with
+// foxglove_ws::JsonCdrSerializer. Usage: json_serializer_benchmark [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <rosx_introspection/ros_parser.hpp>
+
+#include <foxglove_bridge/json_cdr_serializer.hpp>
+
+namespace {
+
+constexpr char DELIMITER[] =
+  "================================================================================\n";
+
+struct BenchmarkCase {
+  std::string schemaName;
+  std::string schema;
+  std::string json;
+};
+
+std::vector<BenchmarkCase> createBenchmarkCases() {
+  const std::string vector3 = std::string(DELIMITER) +
+                              "MSG: geometry_msgs/Vector3\n"
+                              "float64 x\nfloat64 y\nfloat64 z\n";
+  const std::string header = std::string(DELIMITER) +
+                             "MSG: std_msgs/Header\n"
+                             "builtin_interfaces/Time stamp\nstring frame_id\n" +
+                             DELIMITER +
+                             "MSG: builtin_interfaces/Time\n"
+                             "int32 sec\nuint32 nanosec\n";
+
+  std::string jointNames, jointValues;
+  for (int i = 0; i < 32; ++i) {
+    jointNames += (i > 0 ? ", " : "") + std::string("\"joint_") + std::to_string(i) + "\"";
+    jointValues += (i > 0 ? ", " : "") + std::to_string(0.125 * i);
+  }
+
+  return {
+    {"geometry_msgs/msg/Twist",
+     "geometry_msgs/Vector3 linear\ngeometry_msgs/Vector3 angular\n" + vector3,
+     R"({"linear": {"x": 0.5, "y": 0.0, "z": 0.0}, "angular": {"x": 0.0, "y": 0.0, "z": -0.3}})"},
+    {"sensor_msgs/msg/JointState",
+     "std_msgs/Header header\nstring[] name\nfloat64[] position\nfloat64[] velocity\n"
+     "float64[] effort\n" +
+       header,
+     R"({"header": {"stamp": {"sec": 1700000000, "nanosec": 123456789}, "frame_id": "base"},)"
+     R"("name": [)" +
+       jointNames + R"(], "position": [)" + jointValues + R"(], "velocity": [)" + jointValues +
+       R"(], "effort": [)" + jointValues + "]}"},
+  };
+}
+
+template <typename Fn>
+double measureNsPerMessage(size_t iterations, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    fn();
+  }
+  const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  return static_cast<double>(elapsedNs) / static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  int result = EXIT_SUCCESS;
+
+  for (const auto& benchmarkCase : createBenchmarkCases()) {
+    RosMsgParser::Parser parser("/benchmark", RosMsgParser::ROSType(benchmarkCase.schemaName),
+                                benchmarkCase.schema);
+    RosMsgParser::ROS2_Serializer rosxSerializer;
+    const foxglove_ws::JsonCdrSerializer serializer(benchmarkCase.schemaName,
+                                                    benchmarkCase.schema);
+    std::vector<uint8_t> cdrBuffer;
+
+    const double rosxNs = measureNsPerMessage(iterations, [&]() {
+      rosxSerializer.reset();
+      const std::string jsonMessage(benchmarkCase.json);
+      parser.serializeFromJson(jsonMessage, &rosxSerializer);
+    });
+    const double compiledNs = measureNsPerMessage(iterations, [&]() {
+      serializer.serialize(benchmarkCase.json, cdrBuffer);
+    });
+
+    const bool identical =
+      cdrBuffer.size() == rosxSerializer.getBufferSize() &&
+      std::memcmp(cdrBuffer.data(), rosxSerializer.getBufferData(), cdrBuffer.size()) == 0;
+    if (!identical) {
+      result = EXIT_FAILURE;
+    }
+
+    std::printf("%-28s rosx_introspection: %8.0f ns/msg  JsonCdrSerializer: %8.0f ns/msg  "
+                "speedup: %5.1fx  output: %s\n",
+                benchmarkCase.schemaName.c_str(), rosxNs, compiledNs, rosxNs / compiledNs,
+                identical ? "identical" : "MISMATCH");
+  }
+
+  return result;
+}
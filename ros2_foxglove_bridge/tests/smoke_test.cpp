@@ -13,6 +13,8 @@
 #include <foxglove_bridge/websocket_client.hpp>
 
 constexpr char URI[] = "ws://localhost:8765";
+constexpr uint16_t SECOND_BRIDGE_PORT = 8766;
+constexpr char SECOND_BRIDGE_URI[] = "ws://localhost:8766";
 
 // Binary representation of std_msgs/msg/String for "hello world"
 constexpr uint8_t HELLO_WORLD_CDR[] = {0,   1,   0,   0,  12,  0,   0,   0,   104, 101,
@@ -94,11 +96,25 @@ protected:
   void TearDown() override {
     executor.remove_node(_paramNode1);
     executor.remove_node(_paramNode2);
+    if (_secondBridge) {
+      executor.remove_node(_secondBridge->get_node_base_interface());
+    }
+  }
+
+  // Start a second bridge for tests that need other settings than the bridge shared by all tests.
+  void startSecondBridge(const std::vector<rclcpp::Parameter>& parameterOverrides) {
+    rclcpp::NodeOptions nodeOptions;
+    nodeOptions.arguments({"--ros-args", "-r", "__node:=second_foxglove_bridge"});
+    nodeOptions.parameter_overrides(parameterOverrides);
+    nodeOptions.append_parameter_override("port", SECOND_BRIDGE_PORT);
+    _secondBridge = std::make_shared<foxglove_bridge::FoxgloveBridge>(nodeOptions);
+    executor.add_node(_secondBridge->get_node_base_interface());
   }
 
   rclcpp::Node::SharedPtr _paramNode1;
   rclcpp::Node::SharedPtr _paramNode2;
   std::shared_ptr<foxglove_ws::Client<websocketpp::config::asio_client>> _wsClient;
+  std::shared_ptr<foxglove_bridge::FoxgloveBridge> _secondBridge;
 };
 
 class ServiceTest : public TestWithExecutor {
@@ -540,6 +556,172 @@ TEST_F(ParameterTest, testParameterSubscription) {
   ASSERT_EQ(std::future_status::timeout, future.wait_for(ONE_SECOND));
 }
 
+TEST_F(ParameterTest, testParameterSubscriptionMultipleNodes) {
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+  const auto p3 = NODE_2_NAME + "." + PARAM_3_NAME;
+  _wsClient->subscribeParameterUpdates({p1, p3});
+
+  // Updates of different nodes, one after the other, must each be sent.
+  auto future = foxglove_ws::waitForParameters(_wsClient);
+  _wsClient->setParameters({foxglove_ws::Parameter(p1, "foo")});
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  auto params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ(p1, params.front().getName());
+
+  future = foxglove_ws::waitForParameters(_wsClient);
+  _wsClient->setParameters({foxglove_ws::Parameter(p3, 2.5)});
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ(p3, params.front().getName());
+  EXPECT_NEAR(2.5, params.front().getValue().getValue<double>(), 1e-9);
+
+  // Parameters set by the node itself are sent as well.
+  future = foxglove_ws::waitForParameters(_wsClient);
+  _paramNode1->set_parameter(rclcpp::Parameter(PARAM_1_NAME, "bar"));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ(p1, params.front().getName());
+  EXPECT_EQ("bar", params.front().getValue().getValue<std::string>());
+}
+
+TEST_F(ParameterTest, testParameterUpdatesCoalesced) {
+  startSecondBridge({rclcpp::Parameter("parameter_update_interval_ms", 1000)});
+  auto client = std::make_shared<foxglove_ws::Client<websocketpp::config::asio_client>>();
+  ASSERT_EQ(std::future_status::ready,
+            client->connect(SECOND_BRIDGE_URI).wait_for(DEFAULT_TIMEOUT));
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+  client->subscribeParameterUpdates({p1});
+
+  // The first update is sent right away.
+  auto future = foxglove_ws::waitForParameters(client);
+  _paramNode1->set_parameter(rclcpp::Parameter(PARAM_1_NAME, "first"));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  auto params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ("first", params.front().getValue().getValue<std::string>());
+
+  // Updates within the interval are coalesced, only the latest value is sent once it has passed.
+  future = foxglove_ws::waitForParameters(client);
+  _paramNode1->set_parameter(rclcpp::Parameter(PARAM_1_NAME, "second"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  _paramNode1->set_parameter(rclcpp::Parameter(PARAM_1_NAME, "third"));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ("third", params.front().getValue().getValue<std::string>());
+}
+
+TEST_F(ParameterTest, testGetParametersFromCache) {
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+
+  auto future = foxglove_ws::waitForParameters(_wsClient, "req-1");
+  _wsClient->getParameters({p1}, "req-1");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  const auto params = future.get();
+  ASSERT_EQ(1UL, params.size());
+
+  // The node is not spun anymore, so the parameters can only be answered from the cache.
+  executor.remove_node(_paramNode1);
+  future = foxglove_ws::waitForParameters(_wsClient, "req-2");
+  _wsClient->getParameters({p1}, "req-2");
+  const auto status = future.wait_for(ONE_SECOND);
+  executor.add_node(_paramNode1);
+  ASSERT_EQ(std::future_status::ready, status);
+  const auto cachedParams = future.get();
+  ASSERT_EQ(1UL, cachedParams.size());
+  EXPECT_EQ(params.front().getValue().getValue<std::string>(),
+            cachedParams.front().getValue().getValue<std::string>());
+}
+
+TEST_F(ParameterTest, testSetParametersInvalidatesCache) {
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+
+  auto future = foxglove_ws::waitForParameters(_wsClient, "req-get");
+  _wsClient->getParameters({p1}, "req-get");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  ASSERT_EQ(1UL, future.get().size());
+
+  future = foxglove_ws::waitForParameters(_wsClient, "req-set");
+  _wsClient->setParameters({foxglove_ws::Parameter(p1, "cache")}, "req-set");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  ASSERT_EQ(1UL, future.get().size());
+
+  // Must not be answered with the value cached before the parameter was set.
+  future = foxglove_ws::waitForParameters(_wsClient, "req-get-2");
+  _wsClient->getParameters({p1}, "req-get-2");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  const auto params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ("cache", params.front().getValue().getValue<std::string>());
+}
+
+TEST_F(ParameterTest, testParameterCacheMaxAge) {
+  startSecondBridge({rclcpp::Parameter("parameter_cache_max_age", 1.0)});
+  auto client = std::make_shared<foxglove_ws::Client<websocketpp::config::asio_client>>();
+  ASSERT_EQ(std::future_status::ready,
+            client->connect(SECOND_BRIDGE_URI).wait_for(DEFAULT_TIMEOUT));
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+
+  auto future = foxglove_ws::waitForParameters(client, "req-1");
+  client->getParameters({p1}, "req-1");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  ASSERT_EQ(1UL, future.get().size());
+
+  // While the parameters are cached, they are returned although the node does not respond.
+  executor.remove_node(_paramNode1);
+  auto cachedFuture = foxglove_ws::waitForParameters(client, "req-2");
+  client->getParameters({p1}, "req-2");
+  const auto cachedStatus = cachedFuture.wait_for(ONE_SECOND);
+
+  // Once they are too old, they are fetched from the node again, which fails.
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  auto expiredFuture = foxglove_ws::waitForParameters(client, "req-3");
+  client->getParameters({p1}, "req-3");
+  const auto expiredStatus = expiredFuture.wait_for(DEFAULT_TIMEOUT);
+  executor.add_node(_paramNode1);
+
+  ASSERT_EQ(std::future_status::ready, cachedStatus);
+  EXPECT_EQ(1UL, cachedFuture.get().size());
+  ASSERT_EQ(std::future_status::ready, expiredStatus);
+  EXPECT_TRUE(expiredFuture.get().empty());
+}
+
+TEST_F(ParameterTest, testUnresponsiveNodeDoesNotBlockParameterRequests) {
+  const auto p1 = NODE_1_NAME + "." + PARAM_1_NAME;
+  const auto p3 = NODE_2_NAME + "." + PARAM_3_NAME;
+  auto slowClient = std::make_shared<foxglove_ws::Client<websocketpp::config::asio_client>>();
+  ASSERT_EQ(std::future_status::ready, slowClient->connect(URI).wait_for(DEFAULT_TIMEOUT));
+
+  // Make sure that the bridge is connected to the parameter services of the second node.
+  auto future = foxglove_ws::waitForParameters(_wsClient, "req-warmup");
+  _wsClient->setParameters({foxglove_ws::Parameter(p3, 2.0)}, "req-warmup");
+  ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT));
+  ASSERT_EQ(1UL, future.get().size());
+
+  // The second node is not spun anymore, so requests to it are only answered once they time out.
+  executor.remove_node(_paramNode2);
+  auto slowFuture = foxglove_ws::waitForParameters(slowClient, "req-slow");
+  slowClient->setParameters({foxglove_ws::Parameter(p3, 3.0)}, "req-slow");
+
+  // Meanwhile, requests to other nodes are still answered right away.
+  future = foxglove_ws::waitForParameters(_wsClient, "req-fast");
+  _wsClient->setParameters({foxglove_ws::Parameter(p1, "fast")}, "req-fast");
+  const auto fastStatus = future.wait_for(DEFAULT_TIMEOUT);
+  const auto slowStatusWhenFastDone = slowFuture.wait_for(std::chrono::seconds(0));
+  const auto slowStatus = slowFuture.wait_for(2 * DEFAULT_TIMEOUT);
+  executor.add_node(_paramNode2);
+
+  ASSERT_EQ(std::future_status::ready, fastStatus);
+  const auto params = future.get();
+  ASSERT_EQ(1UL, params.size());
+  EXPECT_EQ("fast", params.front().getValue().getValue<std::string>());
+  EXPECT_EQ(std::future_status::timeout, slowStatusWhenFastDone);
+  EXPECT_EQ(std::future_status::ready, slowStatus);
+}
+
 TEST_F(ParameterTest, testGetParametersParallel) {
   // Connect a few clients (in parallel) and make sure that they all receive parameters
   auto clients = {
@@ -717,6 +899,46 @@ TEST(SmokeTest, receiveMessagesOfMultipleTransientLocalPublishers) {
   spinnerThread.join();
 }
 
+TEST(SmokeTest, replayTopicHistory) {
+  // use a unique topic for each test repetition, as the history outlives the test
+  static size_t replayTopicHistoryCount = 0;
+  ++replayTopicHistoryCount;
+  const std::string topicName = "/history_" + std::to_string(replayTopicHistoryCount);
+  auto node = rclcpp::Node::make_shared("history_node");
+  auto pub = node->create_publisher<std_msgs::msg::String>(topicName, rclcpp::QoS(10).reliable());
+
+  // The bridge subscribes to topics with history as soon as they are advertised.
+  auto client = std::make_shared<foxglove_ws::Client<websocketpp::config::asio_client>>();
+  auto channelFuture = foxglove_ws::waitForChannel(client, topicName);
+  ASSERT_EQ(std::future_status::ready, client->connect(URI).wait_for(ONE_SECOND));
+  ASSERT_EQ(std::future_status::ready, channelFuture.wait_for(DEFAULT_TIMEOUT));
+  const foxglove_ws::Channel channel = channelFuture.get();
+  std::this_thread::sleep_for(ONE_SECOND);
+
+  constexpr size_t nMessages = 3;
+  for (size_t i = 0; i < nMessages; ++i) {
+    std_msgs::msg::String msg;
+    msg.data = "hello world";
+    pub->publish(msg);
+  }
+  std::this_thread::sleep_for(ONE_SECOND);
+
+  std::promise<void> promise;
+  std::atomic<size_t> nReceivedMessages = 0;
+  client->setBinaryMessageHandler([&promise, &nReceivedMessages](const uint8_t*, size_t) {
+    if (++nReceivedMessages == nMessages) {
+      promise.set_value();
+    }
+  });
+
+  // Messages published before subscribing are replayed.
+  const foxglove_ws::SubscriptionId subscriptionId = 1;
+  client->subscribe({{subscriptionId, channel.id}}, true /* replayHistory */);
+  EXPECT_EQ(std::future_status::ready, promise.get_future().wait_for(DEFAULT_TIMEOUT));
+  EXPECT_EQ(nReceivedMessages, nMessages);
+  client->unsubscribe({subscriptionId});
+}
+
 TEST(FetchAssetTest, fetchExistingAsset) {
   auto wsClient = std::make_shared<foxglove_ws::Client<websocketpp::config::asio_client>>();
   EXPECT_EQ(std::future_status::ready, wsClient->connect(URI).wait_for(DEFAULT_TIMEOUT));
@@ -773,6 +995,8 @@ int main(int argc, char** argv) {
   // Explicitly allow file:// asset URIs for testing purposes.
   nodeOptions.append_parameter_override("asset_uri_allowlist",
                                         std::vector<std::string>({"file://.*"}));
+  nodeOptions.append_parameter_override("topic_history_durations",
+                                        std::vector<std::string>({"/history_\\d+:60"}));
   foxglove_bridge::FoxgloveBridge node(nodeOptions);
   executor.add_node(node.get_node_base_interface());
 
@@ -27,12 +27,16 @@ constexpr char PARAM_INCLUDE_HIDDEN[] = "include_hidden";
 constexpr char PARAM_DISABLE_LOAN_MESSAGE[] = "disable_load_message";
 constexpr char PARAM_ASSET_URI_ALLOWLIST[] = "asset_uri_allowlist";
 constexpr char PARAM_IGN_UNRESPONSIVE_PARAM_NODES[] = "ignore_unresponsive_param_nodes";
+constexpr char PARAM_TIME_BROADCAST_RATE[] = "time_broadcast_rate";
+constexpr char PARAM_SUBSCRIPTION_LINGER_DURATION[] = "subscription_linger_duration";
 
 constexpr int64_t DEFAULT_PORT = 8765;
 constexpr char DEFAULT_ADDRESS[] = "0.0.0.0";
 constexpr int64_t DEFAULT_SEND_BUFFER_LIMIT = 10000000;
 constexpr int64_t DEFAULT_MIN_QOS_DEPTH = 1;
 constexpr int64_t DEFAULT_MAX_QOS_DEPTH = 25;
+constexpr double DEFAULT_TIME_BROADCAST_RATE = 60.0;
+constexpr double DEFAULT_SUBSCRIPTION_LINGER_DURATION = 0.0;
 
 void declareParameters(rclcpp::Node* node);
 
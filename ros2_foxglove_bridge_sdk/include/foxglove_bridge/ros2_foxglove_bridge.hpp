@@ -2,13 +2,14 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <thread>
 
 #include <rclcpp/rclcpp.hpp>
 #include <rosgraph_msgs/msg/clock.hpp>
-#include <rosx_introspection/ros_parser.hpp>
 #include <websocketpp/common/connection_hdl.hpp>
 
 #include <foxglove/foxglove.hpp>
@@ -16,10 +17,12 @@
 #include <foxglove_bridge/callback_queue.hpp>
 #include <foxglove_bridge/foxglove_bridge.hpp>
 #include <foxglove_bridge/generic_client.hpp>
+#include <foxglove_bridge/json_cdr_serializer.hpp>
 #include <foxglove_bridge/message_definition_cache.hpp>
 #include <foxglove_bridge/param_utils.hpp>
 #include <foxglove_bridge/parameter_interface.hpp>
 #include <foxglove_bridge/regex_utils.hpp>
+#include <foxglove_bridge/serialized_message_pool.hpp>
 #include <foxglove_bridge/server_factory.hpp>
 #include <foxglove_bridge/utils.hpp>
 
@@ -27,6 +30,8 @@ namespace foxglove_bridge {
 
 using ConnectionHandle = websocketpp::connection_hdl;
 using LogLevel = foxglove_ws::WebSocketLogLevel;
+using JsonSerializers =
+  std::unordered_map<std::string, std::shared_ptr<const foxglove_ws::JsonCdrSerializer>>;
 using Subscription = rclcpp::GenericSubscription::SharedPtr;
 using SubscriptionsByClient = std::map<ConnectionHandle, Subscription, std::owner_less<>>;
 using Publication = rclcpp::GenericPublisher::SharedPtr;
@@ -37,7 +42,6 @@ using SubscriptionCount = std::pair<Subscription, size_t>;
 using MapOfSets = std::unordered_map<std::string, std::unordered_set<std::string>>;
 
 using ClientId = uint32_t;
-using SinkId = uint64_t;
 using ChannelId = uint64_t;
 using ChannelAndClientId = std::pair<ChannelId, ClientId>;
 struct ClientAdvertisement {
@@ -75,8 +79,36 @@ private:
 
   // BEGIN New SDK Components
   std::unique_ptr<foxglove::WebSocketServer> _sdkServer;
-  std::unordered_map<ChannelId, foxglove::RawChannel> _sdkChannels;
-  std::unordered_map<ChannelAndClientId, Subscription, PairHash> _sdkSubscriptions;
+  // A single ROS subscription is shared by all clients subscribed to a channel. Its callback holds
+  // a reference to the channel, so that messages are dispatched without looking up the channel
+  // (and taking _subscriptionsMutex) for every message. A channel removed from _sdkChannels thus
+  // stays alive until its subscription's last callback returned. For transient local topics, the
+  // last `depth` messages are kept in `history` along with the time they were received, to be
+  // replayed to clients joining the subscription later on.
+  //
+  // Once the last client unsubscribed, the subscription lingers until `lingerExpiry`, so that it
+  // can be reused right away when a client subscribes again (e.g. when switching layouts).
+  struct SubscriptionHistory {
+    struct Message {
+      uint64_t receiveTime;
+      std::shared_ptr<const rclcpp::SerializedMessage> msg;
+    };
+    size_t depth = 0;
+    std::mutex mutex;
+    std::deque<Message> messages;
+  };
+  struct ChannelSubscription {
+    Subscription subscription;
+    std::shared_ptr<SerializedMessagePool> messagePool;
+    std::shared_ptr<SubscriptionHistory> history;
+    std::unordered_set<ClientId> clients;
+    std::optional<std::chrono::steady_clock::time_point> lingerExpiry;
+  };
+  std::unordered_map<ChannelId, std::shared_ptr<foxglove::RawChannel>> _sdkChannels;
+  std::unordered_map<ChannelId, ChannelSubscription> _sdkSubscriptions;
+  std::chrono::duration<double> _subscriptionLingerDuration{0.0};
+  rclcpp::TimerBase::SharedPtr _lingerExpiryTimer;
+  rclcpp::TimerBase::SharedPtr _messagePoolStatisticsTimer;
   std::unordered_map<ChannelAndClientId, ClientAdvertisement, PairHash> _clientAdvertisedTopics;
   // END New SDK Components
 
@@ -101,13 +133,18 @@ private:
   size_t _minQosDepth = DEFAULT_MIN_QOS_DEPTH;
   size_t _maxQosDepth = DEFAULT_MAX_QOS_DEPTH;
   std::shared_ptr<rclcpp::Subscription<rosgraph_msgs::msg::Clock>> _clockSubscription;
+  rclcpp::TimerBase::SharedPtr _timeBroadcastTimer;
+  std::atomic<int64_t> _latestClockTime = -1;
+  int64_t _lastBroadcastedClockTime = -1;
   bool _useSimTime = false;
   std::vector<std::string> _capabilities;
   std::atomic<bool> _subscribeGraphUpdates = false;
   bool _includeHidden = false;
   bool _disableLoanMessage = true;
   std::unique_ptr<foxglove_ws::CallbackQueue> _fetchAssetQueue;
-  std::unordered_map<std::string, std::shared_ptr<RosMsgParser::Parser>> _jsonParsers;
+  // JSON serializers by schema name. Copy-on-write, so that client messages can look up their
+  // serializer without locking. Modified under _clientAdvertisementsMutex.
+  std::shared_ptr<const JsonSerializers> _jsonSerializers = std::make_shared<JsonSerializers>();
   std::atomic<bool> _shuttingDown = false;
 
   void subscribeConnectionGraph(bool subscribe);
@@ -136,8 +173,15 @@ private:
 
   void logHandler(LogLevel level, char const* msg);
 
-  void rosMessageHandler(ChannelId channelId, SinkId sinkId,
-                         std::shared_ptr<const rclcpp::SerializedMessage> msg);
+  void broadcastLatestClockTime();
+
+  void expireLingeringSubscriptions();
+
+  void logMessagePoolStatistics();
+
+  /// Log a message to the channel, returns the timestamp it was logged with.
+  uint64_t rosMessageHandler(foxglove::RawChannel& channel,
+                             std::shared_ptr<const rclcpp::SerializedMessage> msg);
 
   void serviceRequest(const foxglove_ws::ServiceRequest& request, ConnectionHandle clientHandle);
 
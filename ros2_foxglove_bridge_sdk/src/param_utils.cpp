@@ -187,6 +187,32 @@ void declareParameters(rclcpp::Node* node) {
     "Avoid requesting parameters from previously unresponsive nodes";
   ignUnresponsiveParamNodes.read_only = true;
   node->declare_parameter(PARAM_IGN_UNRESPONSIVE_PARAM_NODES, true, ignUnresponsiveParamNodes);
+
+  auto timeBroadcastRateDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  timeBroadcastRateDescription.name = PARAM_TIME_BROADCAST_RATE;
+  timeBroadcastRateDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  timeBroadcastRateDescription.description =
+    "Rate (Hz) at which the latest /clock time is broadcasted to clients when use_sim_time is "
+    "enabled. 0 means that every /clock message is broadcasted.";
+  timeBroadcastRateDescription.floating_point_range.resize(1);
+  timeBroadcastRateDescription.floating_point_range[0].from_value = 0.0;
+  timeBroadcastRateDescription.floating_point_range[0].to_value = 10000.0;
+  timeBroadcastRateDescription.read_only = true;
+  node->declare_parameter(PARAM_TIME_BROADCAST_RATE, DEFAULT_TIME_BROADCAST_RATE,
+                          timeBroadcastRateDescription);
+
+  auto subscriptionLingerDurationDescription = rcl_interfaces::msg::ParameterDescriptor{};
+  subscriptionLingerDurationDescription.name = PARAM_SUBSCRIPTION_LINGER_DURATION;
+  subscriptionLingerDurationDescription.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  subscriptionLingerDurationDescription.description =
+    "Duration (seconds) for which a ROS subscription is kept alive after the last client "
+    "unsubscribed, so that it can be reused when a client subscribes again. 0 disables lingering.";
+  subscriptionLingerDurationDescription.floating_point_range.resize(1);
+  subscriptionLingerDurationDescription.floating_point_range[0].from_value = 0.0;
+  subscriptionLingerDurationDescription.floating_point_range[0].to_value = 3600.0;
+  subscriptionLingerDurationDescription.read_only = true;
+  node->declare_parameter(PARAM_SUBSCRIPTION_LINGER_DURATION, DEFAULT_SUBSCRIPTION_LINGER_DURATION,
+                          subscriptionLingerDurationDescription);
 }
 
 std::vector<std::regex> parseRegexStrings(rclcpp::Node* node,
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <unordered_set>
 
 #include <resource_retriever/retriever.hpp>
@@ -75,6 +76,9 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
   const auto assetUriAllowlist = this->get_parameter(PARAM_ASSET_URI_ALLOWLIST).as_string_array();
   _assetUriAllowlistPatterns = parseRegexStrings(this, assetUriAllowlist);
   _disableLoanMessage = this->get_parameter(PARAM_DISABLE_LOAN_MESSAGE).as_bool();
+  const auto timeBroadcastRate = this->get_parameter(PARAM_TIME_BROADCAST_RATE).as_double();
+  _subscriptionLingerDuration = std::chrono::duration<double>(
+    this->get_parameter(PARAM_SUBSCRIPTION_LINGER_DURATION).as_double());
   // const auto ignoreUnresponsiveParamNodes =
   //   this->get_parameter(PARAM_IGN_UNRESPONSIVE_PARAM_NODES).as_bool();
 
@@ -181,7 +185,32 @@ FoxgloveBridge::FoxgloveBridge(const rclcpp::NodeOptions& options)
     this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
   _servicesCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
 
-  if (_useSimTime) {
+  if (_subscriptionLingerDuration.count() > 0.0) {
+    _lingerExpiryTimer = this->create_wall_timer(
+      std::min(std::chrono::duration_cast<std::chrono::nanoseconds>(_subscriptionLingerDuration),
+               std::chrono::nanoseconds(std::chrono::seconds(1))),
+      std::bind(&FoxgloveBridge::expireLingeringSubscriptions, this));
+  }
+
+  _messagePoolStatisticsTimer =
+    this->create_wall_timer(MESSAGE_POOL_STATISTICS_INTERVAL,
+                            std::bind(&FoxgloveBridge::logMessagePoolStatistics, this));
+
+  if (_useSimTime && timeBroadcastRate > 0.0) {
+    // Only remember the latest time and broadcast it at a fixed rate, so that the broadcasting
+    // cost does not depend on the /clock rate.
+    _clockSubscription = this->create_subscription<rosgraph_msgs::msg::Clock>(
+      "/clock", rclcpp::QoS{rclcpp::KeepLast(1)}.best_effort(),
+      [&](std::shared_ptr<const rosgraph_msgs::msg::Clock> msg) {
+        const auto timestamp = rclcpp::Time{msg->clock}.nanoseconds();
+        assert(timestamp >= 0 && "Timestamp is negative");
+        _latestClockTime = timestamp;
+      });
+    _timeBroadcastTimer = this->create_wall_timer(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(1.0 / timeBroadcastRate)),
+      std::bind(&FoxgloveBridge::broadcastLatestClockTime, this));
+  } else if (_useSimTime) {
     _clockSubscription = this->create_subscription<rosgraph_msgs::msg::Clock>(
       "/clock", rclcpp::QoS{rclcpp::KeepLast(1)}.best_effort(),
       [&](std::shared_ptr<const rosgraph_msgs::msg::Clock> msg) {
@@ -268,13 +297,14 @@ void FoxgloveBridge::updateAdvertisedTopics(
   // Remove channels for which the topic does not exist anymore
   for (auto channelIt = _sdkChannels.begin(); channelIt != _sdkChannels.end();) {
     auto& channel = channelIt->second;
-    std::string schemaName = channel.schema().value().name;
-    std::string topic(channel.topic());
+    std::string schemaName = channel->schema().value().name;
+    std::string topic(channel->topic());
     const TopicAndDatatype topicAndSchemaName = {topic, schemaName};
     if (latestTopics.find(topicAndSchemaName) == latestTopics.end()) {
-      RCLCPP_INFO(this->get_logger(), "Removing channel %lu for topic \"%s\" (%s)", channel.id(),
+      RCLCPP_INFO(this->get_logger(), "Removing channel %lu for topic \"%s\" (%s)", channel->id(),
                   topic.c_str(), schemaName.c_str());
-      channel.close();
+      channel->close();
+      _sdkSubscriptions.erase(channelIt->first);
       channelIt = _sdkChannels.erase(channelIt);
     } else {
       channelIt++;
@@ -289,7 +319,7 @@ void FoxgloveBridge::updateAdvertisedTopics(
     if (std::find_if(
           _sdkChannels.begin(), _sdkChannels.end(), [&topic, &schemaName](const auto& kvp) {
             const auto& [channelId, channel] = kvp;
-            return channel.topic() == topic && channel.schema().value().name == schemaName;
+            return channel->topic() == topic && channel->schema().value().name == schemaName;
           }) != _sdkChannels.end()) {
       continue;
     }
@@ -341,7 +371,8 @@ void FoxgloveBridge::updateAdvertisedTopics(
     const ChannelId channelId = channelResult.value().id();
     RCLCPP_INFO(this->get_logger(), "Advertising new channel %lu for topic \"%s\"", channelId,
                 topic.c_str());
-    _sdkChannels.insert({channelId, std::move(channelResult.value())});
+    _sdkChannels.insert(
+      {channelId, std::make_shared<foxglove::RawChannel>(std::move(channelResult.value()))});
   }
 }
 
@@ -504,18 +535,9 @@ void FoxgloveBridge::subscribeConnectionGraph(bool subscribe) {
 }
 
 void FoxgloveBridge::subscribe(ChannelId channelId, const foxglove::ClientMetadata& client) {
-  if (!client.sink_id.has_value()) {
-    RCLCPP_ERROR(this->get_logger(),
-                 "[SDK] received subscribe request from client %u for channel %lu but client "
-                 "has no sink ID",
-                 client.id, channelId);
-    return;
-  }
-
-  RCLCPP_INFO(this->get_logger(),
-              "[SDK] received subscribe request for channel %lu from client %u (sink %lu)",
-              channelId, client.id, client.sink_id.value());
-  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  RCLCPP_INFO(this->get_logger(), "[SDK] received subscribe request for channel %lu from client %u",
+              channelId, client.id);
+  std::unique_lock<std::mutex> lock(_subscriptionsMutex);
 
   // REVIEW: Is this necessary if the SDK server is checking that the channel exists before calling
   // this callback?
@@ -526,9 +548,43 @@ void FoxgloveBridge::subscribe(ChannelId channelId, const foxglove::ClientMetada
     return;
   }
 
-  auto& channel = it->second;
-  const std::string topic(channel.topic());
-  const std::string datatype = channel.schema().value().name;
+  // Messages are logged to all sinks subscribed to the channel, so further clients only need to be
+  // added to the existing ROS subscription.
+  auto subscriptionIt = _sdkSubscriptions.find(channelId);
+  if (subscriptionIt != _sdkSubscriptions.end()) {
+    auto& channelSubscription = subscriptionIt->second;
+    if (channelSubscription.lingerExpiry.has_value()) {
+      channelSubscription.lingerExpiry.reset();
+      RCLCPP_INFO(this->get_logger(), "[SDK] reusing lingering ROS subscription of channel %lu",
+                  channelId);
+    }
+    // Replay the history of transient local topics, which a subscription of its own would have
+    // received from the publishers. The history lock is taken before the client is added, so that
+    // no message received in the meantime is both logged to the client and replayed. The channel
+    // and history are kept alive by their references, so other (un)subscriptions need not wait
+    // for the replay.
+    const auto channel = it->second;
+    const auto history = channelSubscription.history;
+    std::unique_lock<std::mutex> historyLock(history->mutex);
+    channelSubscription.clients.insert(client.id);
+    RCLCPP_INFO(this->get_logger(),
+                "[SDK] added client %u to the ROS subscription of channel %lu (%zu client(s))",
+                client.id, channelId, channelSubscription.clients.size());
+    lock.unlock();
+    if (client.sink_id.has_value() && history->depth > 0) {
+      // Messages keep the time they were received, so that clients can place them in time.
+      for (const auto& message : history->messages) {
+        const auto& rclSerializedMsg = message.msg->get_rcl_serialized_message();
+        channel->log(reinterpret_cast<const std::byte*>(rclSerializedMsg.buffer),
+                     rclSerializedMsg.buffer_length, message.receiveTime, client.sink_id);
+      }
+    }
+    return;
+  }
+
+  const auto channel = it->second;
+  const std::string topic(channel->topic());
+  const std::string datatype = channel->schema().value().name;
 
   const rclcpp::QoS qos = determineQoS(topic);
 
@@ -542,26 +598,42 @@ void FoxgloveBridge::subscribe(ChannelId channelId, const foxglove::ClientMetada
   subscriptionOptions.event_callbacks = eventCallbacks;
   subscriptionOptions.callback_group = _subscriptionCallbackGroup;
 
-  auto subscription = this->create_generic_subscription(
-    topic, datatype, qos,
-    [this, channelId, client](std::shared_ptr<const rclcpp::SerializedMessage> msg) {
-      this->rosMessageHandler(channelId, client.sink_id.value(), msg);
-    },
-    subscriptionOptions);
-
-  if (!client.sink_id.has_value()) {
-    RCLCPP_ERROR(this->get_logger(),
-                 "[SDK] received subscribe request for channel %lu but client "
-                 "has no sink ID",
-                 channelId);
+  ChannelSubscription channelSubscription;
+  channelSubscription.messagePool = std::make_shared<SerializedMessagePool>();
+  channelSubscription.history = std::make_shared<SubscriptionHistory>();
+  if (qos.durability() == rclcpp::DurabilityPolicy::TransientLocal) {
+    channelSubscription.history->depth = qos.depth();
+  }
+  try {
+    channelSubscription.subscription = createPooledGenericSubscription(
+      *this, topic, datatype, qos,
+      [this, channel, history = channelSubscription.history](
+        std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+        if (history->depth == 0) {
+          this->rosMessageHandler(*channel, msg);
+          return;
+        }
+        // Log under the history lock, so that a replay to a new client is not interleaved with
+        // (or duplicated by) messages received in the meantime.
+        std::lock_guard<std::mutex> historyLock(history->mutex);
+        if (history->messages.size() >= history->depth) {
+          history->messages.pop_front();
+        }
+        const uint64_t receiveTime = this->rosMessageHandler(*channel, msg);
+        history->messages.push_back({receiveTime, msg});
+      },
+      subscriptionOptions, channelSubscription.messagePool);
+  } catch (const std::exception& ex) {
+    RCLCPP_ERROR(this->get_logger(), "[SDK] failed to subscribe to topic %s (%s): %s",
+                 topic.c_str(), datatype.c_str(), ex.what());
     return;
   }
+  channelSubscription.clients.insert(client.id);
+  _sdkSubscriptions.emplace(channelId, std::move(channelSubscription));
 
-  _sdkSubscriptions.insert({{channelId, client.id}, subscription});
-  RCLCPP_INFO(
-    this->get_logger(),
-    "[SDK] created ROS subscription on %s (%s) successfully for channel %lu (client %u, sink %lu)",
-    topic.c_str(), datatype.c_str(), channelId, client.id, client.sink_id.value());
+  RCLCPP_INFO(this->get_logger(),
+              "[SDK] created ROS subscription on %s (%s) successfully for channel %lu (client %u)",
+              topic.c_str(), datatype.c_str(), channelId, client.id);
 }
 
 void FoxgloveBridge::unsubscribe(ChannelId channelId, const foxglove::ClientMetadata& client) {
@@ -576,8 +648,9 @@ void FoxgloveBridge::unsubscribe(ChannelId channelId, const foxglove::ClientMeta
     return;
   }
 
-  auto subscriptionIt = _sdkSubscriptions.find({channelId, client.id});
-  if (subscriptionIt == _sdkSubscriptions.end()) {
+  auto subscriptionIt = _sdkSubscriptions.find(channelId);
+  if (subscriptionIt == _sdkSubscriptions.end() ||
+      subscriptionIt->second.clients.erase(client.id) == 0) {
     RCLCPP_ERROR(this->get_logger(),
                  "[SDK] Client %u tried unsubscribing from channel %lu but a corresponding ROS "
                  "subscription doesn't exist",
@@ -585,13 +658,76 @@ void FoxgloveBridge::unsubscribe(ChannelId channelId, const foxglove::ClientMeta
     return;
   }
 
-  const std::string& topic = subscriptionIt->second->get_topic_name();
+  auto& channelSubscription = subscriptionIt->second;
+  if (!channelSubscription.clients.empty()) {
+    RCLCPP_INFO(this->get_logger(),
+                "[SDK] Removed client %u from channel %lu (%zu client(s) left)", client.id,
+                channelId, channelSubscription.clients.size());
+    return;
+  }
+
+  const std::string topic = channelSubscription.subscription->get_topic_name();
+  if (_subscriptionLingerDuration.count() > 0.0) {
+    channelSubscription.lingerExpiry =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(_subscriptionLingerDuration);
+    RCLCPP_INFO(this->get_logger(),
+                "[SDK] Last client %u unsubscribed from channel %lu, keeping subscription to "
+                "topic %s for %.1f s",
+                client.id, channelId, topic.c_str(), _subscriptionLingerDuration.count());
+    return;
+  }
+
+  const auto stats = channelSubscription.messagePool->statistics();
   RCLCPP_INFO(this->get_logger(),
-              "[SDK] Cleaned up subscription to topic %s for client %u on channel %lu",
-              topic.c_str(), client.id, channelId);
+              "[SDK] Cleaned up subscription to topic %s for client %u on channel %lu (serialized "
+              "message pool: %lu allocations, %lu reuses, largest message %zu bytes, peak RSS: "
+              "%ld kB)",
+              topic.c_str(), client.id, channelId, static_cast<unsigned long>(stats.allocations),
+              static_cast<unsigned long>(stats.reuses), stats.largestMessage, getPeakRssKb());
   _sdkSubscriptions.erase(subscriptionIt);
 }
 
+void FoxgloveBridge::expireLingeringSubscriptions() {
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  const auto now = std::chrono::steady_clock::now();
+  for (auto it = _sdkSubscriptions.begin(); it != _sdkSubscriptions.end();) {
+    const auto& lingerExpiry = it->second.lingerExpiry;
+    if (!lingerExpiry.has_value() || *lingerExpiry > now) {
+      ++it;
+      continue;
+    }
+    const auto stats = it->second.messagePool->statistics();
+    RCLCPP_INFO(this->get_logger(),
+                "[SDK] Cleaned up lingering subscription to topic %s on channel %lu (serialized "
+                "message pool: %lu allocations, %lu reuses, largest message %zu bytes, peak RSS: "
+                "%ld kB)",
+                it->second.subscription->get_topic_name(), it->first,
+                static_cast<unsigned long>(stats.allocations),
+                static_cast<unsigned long>(stats.reuses), stats.largestMessage, getPeakRssKb());
+    it = _sdkSubscriptions.erase(it);
+  }
+}
+
+void FoxgloveBridge::logMessagePoolStatistics() {
+  if (!rcutils_logging_logger_is_enabled_for(this->get_logger().get_name(),
+                                             RCUTILS_LOG_SEVERITY_DEBUG)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
+  for (const auto& [channelId, channelSubscription] : _sdkSubscriptions) {
+    const auto stats = channelSubscription.messagePool->statistics();
+    RCLCPP_DEBUG(this->get_logger(),
+                 "[SDK] Serialized message pool of topic %s on channel %lu: %lu allocations, %lu "
+                 "reuses, %zu bytes pooled, largest message %zu bytes (peak RSS: %ld kB)",
+                 channelSubscription.subscription->get_topic_name(), channelId,
+                 static_cast<unsigned long>(stats.allocations),
+                 static_cast<unsigned long>(stats.reuses), stats.pooledBytes,
+                 stats.largestMessage, getPeakRssKb());
+  }
+}
+
 void FoxgloveBridge::clientAdvertise(ClientId clientId, const foxglove::ClientChannel& channel) {
   std::lock_guard<std::mutex> lock(_clientAdvertisementsMutex);
 
@@ -613,10 +749,10 @@ void FoxgloveBridge::clientAdvertise(ClientId clientId, const foxglove::ClientCh
   }
 
   if (encoding == "json") {
-    // register the JSON parser for this schemaName
+    // register the JSON serializer for this schemaName
     std::string schemaName(channel.schema_name);
-    auto parserIt = _jsonParsers.find(schemaName);
-    if (parserIt == _jsonParsers.end()) {
+    const auto jsonSerializers = std::atomic_load(&_jsonSerializers);
+    if (jsonSerializers->find(schemaName) == jsonSerializers->end()) {
       std::string schema = "";
       if (channel.schema_len > 0) {
         // Schema is given by the advertisement
@@ -632,9 +768,18 @@ void FoxgloveBridge::clientAdvertise(ClientId clientId, const foxglove::ClientCh
         schema = msgDefinition;
       }
 
-      auto parser = std::make_shared<RosMsgParser::Parser>(
-        topicName, RosMsgParser::ROSType(schemaName), schema);
-      _jsonParsers.insert({schemaName, parser});
+      std::shared_ptr<const foxglove_ws::JsonCdrSerializer> serializer;
+      try {
+        serializer = std::make_shared<const foxglove_ws::JsonCdrSerializer>(schemaName, schema);
+      } catch (const std::exception& ex) {
+        throw foxglove_ws::ClientChannelError(
+          channel.id,
+          "Failed to create JSON serializer for schema " + schemaName + ": " + ex.what());
+      }
+      auto updatedSerializers = std::make_shared<JsonSerializers>(*jsonSerializers);
+      updatedSerializers->emplace(schemaName, std::move(serializer));
+      std::atomic_store(&_jsonSerializers,
+                        std::shared_ptr<const JsonSerializers>(std::move(updatedSerializers)));
     }
   }
 
@@ -726,13 +871,11 @@ void FoxgloveBridge::clientMessage(ClientId clientId, ChannelId clientChannelId,
     schemaName = it->second.topicType;
   }
 
-  auto publishMessage = [publisher, this](const void* data, size_t size) {
-    // Copy the message payload into a SerializedMessage object
-    rclcpp::SerializedMessage serializedMessage{size};
-    auto& rclSerializedMsg = serializedMessage.get_rcl_serialized_message();
-    std::memcpy(rclSerializedMsg.buffer, data, size);
-    rclSerializedMsg.buffer_length = size;
-    // Publish the message
+  // The message is reused across messages published from this thread, so that no allocation is
+  // needed once it has grown to the largest message size. This is safe since publishing does not
+  // keep a reference to it.
+  thread_local rclcpp::SerializedMessage serializedMessage;
+  auto publishMessage = [publisher, this]() {
     if (_disableLoanMessage || !publisher->can_loan_messages()) {
       publisher->publish(serializedMessage);
     } else {
@@ -741,28 +884,30 @@ void FoxgloveBridge::clientMessage(ClientId clientId, ChannelId clientChannelId,
   };
 
   if (encoding == "cdr") {
-    publishMessage(data, dataLen);
-  } else if (encoding == "json") {
-    // get the specific parser for this schemaName
-    std::shared_ptr<RosMsgParser::Parser> parser;
-    {
-      std::lock_guard<std::mutex> lock(_clientAdvertisementsMutex);
-      auto parserIt = _jsonParsers.find(schemaName);
-      if (parserIt != _jsonParsers.end()) {
-        parser = parserIt->second;
-      }
+    // Copy the message payload into the serialized message, the only copy of CDR payloads.
+    if (serializedMessage.capacity() < dataLen) {
+      serializedMessage.reserve(dataLen);
     }
-    if (!parser) {
+    auto& rclSerializedMsg = serializedMessage.get_rcl_serialized_message();
+    std::memcpy(rclSerializedMsg.buffer, data, dataLen);
+    rclSerializedMsg.buffer_length = dataLen;
+    publishMessage();
+  } else if (encoding == "json") {
+    // get the specific serializer for this schemaName
+    const auto jsonSerializers = std::atomic_load(&_jsonSerializers);
+    const auto serializerIt = jsonSerializers->find(schemaName);
+    if (serializerIt == jsonSerializers->end()) {
       throw foxglove_ws::ClientChannelError(
         clientChannelId, "Dropping client message from client ID " + std::to_string(clientId) +
                            " with encoding \"json\": no parser found");
     } else {
-      thread_local RosMsgParser::ROS2_Serializer serializer;
-      serializer.reset();
-      const std::string jsonMessage(reinterpret_cast<const char*>(data), dataLen);
+      const std::string_view jsonMessage(reinterpret_cast<const char*>(data), dataLen);
       try {
-        parser->serializeFromJson(jsonMessage, &serializer);
-        publishMessage(serializer.getBufferData(), serializer.getBufferSize());
+        // Serialized straight into the message that is published, so that the CDR data is not
+        // copied again.
+        SerializedMessageOutputBuffer buffer(serializedMessage);
+        serializerIt->second->serialize(jsonMessage, buffer);
+        publishMessage();
       } catch (const std::exception& ex) {
         throw foxglove_ws::ClientChannelError(
           clientChannelId, "Dropping client message from client ID " + std::to_string(clientId) +
@@ -832,22 +977,25 @@ void FoxgloveBridge::logHandler(LogLevel level, char const* msg) {
   }
 }
 
-void FoxgloveBridge::rosMessageHandler(ChannelId channelId, SinkId sinkId,
-                                       std::shared_ptr<const rclcpp::SerializedMessage> msg) {
+void FoxgloveBridge::broadcastLatestClockTime() {
+  const int64_t timestamp = _latestClockTime;
+  if (timestamp < 0 || timestamp == _lastBroadcastedClockTime) {
+    return;  // No (new) time received yet.
+  }
+  _lastBroadcastedClockTime = timestamp;
+  _sdkServer->broadcastTime(static_cast<uint64_t>(timestamp));
+}
+
+uint64_t FoxgloveBridge::rosMessageHandler(foxglove::RawChannel& channel,
+                                           std::shared_ptr<const rclcpp::SerializedMessage> msg) {
   // NOTE: Do not call any RCLCPP_* logging functions from this function. Otherwise, subscribing
   // to `/rosout` will cause a feedback loop
   const auto timestamp = this->now().nanoseconds();
   assert(timestamp >= 0 && "Timestamp is negative");
   const auto rclSerializedMsg = msg->get_rcl_serialized_message();
-
-  std::lock_guard<std::mutex> lock(_subscriptionsMutex);
-  if (_sdkChannels.find(channelId) == _sdkChannels.end()) {
-    return;
-  }
-
-  auto& channel = _sdkChannels.at(channelId);
   channel.log(reinterpret_cast<const std::byte*>(rclSerializedMsg.buffer),
-              rclSerializedMsg.buffer_length, timestamp, sinkId);
+              rclSerializedMsg.buffer_length, static_cast<uint64_t>(timestamp));
+  return static_cast<uint64_t>(timestamp);
 }
 
 void FoxgloveBridge::serviceRequest(const foxglove_ws::ServiceRequest& request,